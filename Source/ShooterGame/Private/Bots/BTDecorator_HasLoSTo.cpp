@@ -7,8 +7,11 @@
 #include "BehaviorTree/Blackboard/BlackboardKeyType_Vector.h"
 #include "Bots/ShooterBot.h"
 #include "Bots/ShooterAIController.h"
+#include "Bots/ShooterBotLOSScheduler.h"
 #include "Online/ShooterPlayerState.h"
 
+static const FName NAME_AILosTrace(TEXT("AILosTrace"));
+
 UBTDecorator_HasLoSTo::UBTDecorator_HasLoSTo(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
@@ -109,19 +112,24 @@ bool UBTDecorator_HasLoSTo::LOSTrace(AActor* InActor, AActor* InEnemyActor, cons
 	{
 		if (MyBot != NULL)
 		{
-			// Perform trace to retrieve hit info
-			FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(AILosTrace), true, InActor);
-			
-			TraceParams.bReturnPhysicalMaterial = true;
-			TraceParams.AddIgnoredActor(MyBot);
+			// Results come from the batched async traces, so they can lag the bots by a frame or two
+			UShooterBotLOSScheduler* LOSScheduler = UShooterBotLOSScheduler::Get(MyBot);
 			const FVector StartLocation = MyBot->GetActorLocation();
-			FHitResult Hit(ForceInit);
-			GetWorld()->LineTraceSingleByChannel(Hit, StartLocation, EndLocation, COLLISION_WEAPON, TraceParams);
-			if (Hit.bBlockingHit == true)
+
+			FShooterBotLOSRequest Request;
+			Request.Requester = MyController;
+			Request.Target = InEnemyActor;
+			Request.Start = StartLocation;
+			Request.End = EndLocation;
+			Request.IgnoredActor = MyBot;
+			Request.Tag = NAME_AILosTrace;
+
+			FShooterBotLOSResult Hit;
+			if (LOSScheduler && LOSScheduler->GetLOSResult(Request, Hit) && Hit.bBlockingHit == true)
 			{
 				// We hit something. If we have an actor supplied, just check if the hit actor is an enemy. If it is consider that 'has LOS'
-				AActor* HitActor = Hit.GetActor();
-				if (Hit.GetActor() != NULL)
+				AActor* HitActor = Hit.HitActor.Get();
+				if (HitActor != NULL)
 				{
 					// If the hit is our target actor consider it LOS
 					if (HitActor == InActor)
@@ -3,7 +3,9 @@
 #include "ShooterGame.h"
 #include "Bots/ShooterAIController.h"
 #include "Bots/ShooterBot.h"
+#include "Bots/ShooterBotLOSScheduler.h"
 #include "Online/ShooterPlayerState.h"
+#include "Player/ShooterPawnSpatialIndex.h"
 #include "BehaviorTree/BehaviorTree.h"
 #include "BehaviorTree/BehaviorTreeComponent.h"
 #include "BehaviorTree/BlackboardComponent.h"
@@ -11,6 +13,8 @@
 #include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
 #include "Weapons/ShooterWeapon.h"
 
+static const FName NAME_AIWeaponLosTrace(TEXT("AIWeaponLosTrace"));
+
 AShooterAIController::AShooterAIController(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
  	BlackboardComp = ObjectInitializer.CreateDefaultSubobject<UBlackboardComponent>(this, TEXT("BlackBoardComp"));
@@ -67,31 +71,18 @@ void AShooterAIController::Respawn()
 void AShooterAIController::FindClosestEnemy()
 {
 	APawn* MyBot = GetPawn();
-	if (MyBot == NULL)
+	UShooterPawnSpatialIndex* PawnIndex = UShooterPawnSpatialIndex::Get(this);
+	if (MyBot == NULL || PawnIndex == NULL)
 	{
 		return;
 	}
 
-	const FVector MyLoc = MyBot->GetActorLocation();
-	float BestDistSq = MAX_FLT;
-	AShooterCharacter* BestPawn = NULL;
+	FShooterPawnQueryResults Enemies;
+	PawnIndex->FindNearestEnemies(this, MyBot->GetActorLocation(), 0.0f, 1, Enemies);
 
-	for (AShooterCharacter* TestPawn : TActorRange<AShooterCharacter>(GetWorld()))
+	if (Enemies.Num() > 0)
 	{
-		if (TestPawn->IsAlive() && TestPawn->IsEnemyFor(this))
-		{
-			const float DistSq = (TestPawn->GetActorLocation() - MyLoc).SizeSquared();
-			if (DistSq < BestDistSq)
-			{
-				BestDistSq = DistSq;
-				BestPawn = TestPawn;
-			}
-		}
-	}
-
-	if (BestPawn)
-	{
-		SetEnemy(BestPawn);
+		SetEnemy(Enemies[0].Pawn);
 	}
 }
 
@@ -99,32 +90,22 @@ bool AShooterAIController::FindClosestEnemyWithLOS(AShooterCharacter* ExcludeEne
 {
 	bool bGotEnemy = false;
 	APawn* MyBot = GetPawn();
-	if (MyBot != NULL)
+	UShooterPawnSpatialIndex* PawnIndex = UShooterPawnSpatialIndex::Get(this);
+	if (MyBot != NULL && PawnIndex != NULL)
 	{
-		const FVector MyLoc = MyBot->GetActorLocation();
-		float BestDistSq = MAX_FLT;
-		AShooterCharacter* BestPawn = NULL;
+		FShooterPawnQueryResults Enemies;
+		PawnIndex->FindNearestEnemies(this, MyBot->GetActorLocation(), 0.0f, 0, Enemies);
 
-		for (AShooterCharacter* TestPawn : TActorRange<AShooterCharacter>(GetWorld()))
+		// enemies are sorted by distance, so the first one we can see is the closest visible one
+		for (const FShooterPawnQueryResult& Enemy : Enemies)
 		{
-			if (TestPawn != ExcludeEnemy && TestPawn->IsAlive() && TestPawn->IsEnemyFor(this))
+			if (Enemy.Pawn != ExcludeEnemy && HasWeaponLOSToEnemy(Enemy.Pawn, true) == true)
 			{
-				if (HasWeaponLOSToEnemy(TestPawn, true) == true)
-				{
-					const float DistSq = (TestPawn->GetActorLocation() - MyLoc).SizeSquared();
-					if (DistSq < BestDistSq)
-					{
-						BestDistSq = DistSq;
-						BestPawn = TestPawn;
-					}
-				}
+				SetEnemy(Enemy.Pawn);
+				bGotEnemy = true;
+				break;
 			}
 		}
-		if (BestPawn)
-		{
-			SetEnemy(BestPawn);
-			bGotEnemy = true;
-		}
 	}
 	return bGotEnemy;
 }
@@ -135,21 +116,25 @@ bool AShooterAIController::HasWeaponLOSToEnemy(AActor* InEnemyActor, const bool
 	AShooterBot* MyBot = Cast<AShooterBot>(GetPawn());
 
 	bool bHasLOS = false;
-	// Perform trace to retrieve hit info
-	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(AIWeaponLosTrace), true, GetPawn());
-
-	TraceParams.bReturnPhysicalMaterial = true;	
+	// Results come from the batched async traces, so they can lag the bots by a frame or two
+	UShooterBotLOSScheduler* LOSScheduler = UShooterBotLOSScheduler::Get(this);
 	FVector StartLocation = MyBot->GetActorLocation();	
 	StartLocation.Z += GetPawn()->BaseEyeHeight; //look from eyes
-	
-	FHitResult Hit(ForceInit);
-	const FVector EndLocation = InEnemyActor->GetActorLocation();
-	GetWorld()->LineTraceSingleByChannel(Hit, StartLocation, EndLocation, COLLISION_WEAPON, TraceParams);
-	if (Hit.bBlockingHit == true)
+
+	FShooterBotLOSRequest Request;
+	Request.Requester = this;
+	Request.Target = InEnemyActor;
+	Request.Start = StartLocation;
+	Request.End = InEnemyActor->GetActorLocation();
+	Request.IgnoredActor = GetPawn();
+	Request.Tag = NAME_AIWeaponLosTrace;
+
+	FShooterBotLOSResult Hit;
+	if (LOSScheduler && LOSScheduler->GetLOSResult(Request, Hit) && Hit.bBlockingHit == true)
 	{
 		// Theres a blocking hit - check if its our enemy actor
-		AActor* HitActor = Hit.GetActor();
-		if (Hit.GetActor() != NULL)
+		AActor* HitActor = Hit.HitActor.Get();
+		if (HitActor != NULL)
 		{
 			if (HitActor == InEnemyActor)
 			{
@@ -0,0 +1,218 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Bots/ShooterBotLOSScheduler.h"
+
+DECLARE_CYCLE_STAT(TEXT("Bot LOS Submit"), STAT_ShooterBotLOSSubmit, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bot LOS Traces Submitted"), STAT_ShooterBotLOSTraces, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bot LOS Cache Hits"), STAT_ShooterBotLOSHits, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bot LOS Cache Misses"), STAT_ShooterBotLOSMisses, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bot LOS Cached Entries"), STAT_ShooterBotLOSEntries, STATGROUP_ShooterGame);
+
+static int32 BotLOSAsync = 1;
+FAutoConsoleVariableRef CVarBotLOSAsync(
+	TEXT("ShooterGame.BotLOS.Async"),
+	BotLOSAsync,
+	TEXT("If nonzero, bot line of sight checks are batched into async traces and answered from the cache. If zero, every check traces immediately."),
+	ECVF_Default);
+
+static float BotLOSMaxAge = 0.1f;
+FAutoConsoleVariableRef CVarBotLOSMaxAge(
+	TEXT("ShooterGame.BotLOS.MaxAge"),
+	BotLOSMaxAge,
+	TEXT("Age in seconds after which a cached bot line of sight result is traced again."),
+	ECVF_Default);
+
+static float BotLOSMaxStaleAge = 0.5f;
+FAutoConsoleVariableRef CVarBotLOSMaxStaleAge(
+	TEXT("ShooterGame.BotLOS.MaxStaleAge"),
+	BotLOSMaxStaleAge,
+	TEXT("Max age in seconds of a result still returned while its refresh is in flight. Older results are treated as no line of sight."),
+	ECVF_Default);
+
+static float BotLOSEvictTime = 2.0f;
+FAutoConsoleVariableRef CVarBotLOSEvictTime(
+	TEXT("ShooterGame.BotLOS.EvictTime"),
+	BotLOSEvictTime,
+	TEXT("Cached results that haven't been asked for in this many seconds are dropped."),
+	ECVF_Default);
+
+/** granularity of location targets, requests to nearby locations share a result */
+static const float LOSLocationCellSize = 50.0f;
+
+UShooterBotLOSScheduler::UShooterBotLOSScheduler(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	NextTraceId = 0;
+	LastEvictTime = 0.0f;
+	TraceDelegate.BindUObject(this, &UShooterBotLOSScheduler::OnTraceCompleted);
+}
+
+UShooterBotLOSScheduler* UShooterBotLOSScheduler::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UShooterBotLOSScheduler>() : nullptr;
+}
+
+bool UShooterBotLOSScheduler::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UShooterBotLOSScheduler::Deinitialize()
+{
+	Entries.Empty();
+	PendingKeys.Empty();
+	InFlightKeys.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UShooterBotLOSScheduler::GetLOSResult(const FShooterBotLOSRequest& Request, FShooterBotLOSResult& OutResult)
+{
+	if (Request.Requester == nullptr)
+	{
+		return false;
+	}
+
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+
+	FLOSKey Key;
+	Key.Requester = Request.Requester;
+	Key.Target = Request.Target;
+	Key.EndCell = Request.Target ? FIntVector::ZeroValue : FIntVector(Request.End / LOSLocationCellSize);
+	Key.Tag = Request.Tag;
+
+	FLOSEntry* Entry = Entries.Find(Key);
+	if (Entry == nullptr)
+	{
+		Entry = &Entries.Add(Key);
+		Entry->ResultTime = -1.0f;
+		Entry->bPending = false;
+	}
+
+	Entry->LastRequestTime = TimeSeconds;
+	Entry->Start = Request.Start;
+	Entry->End = Request.End;
+	Entry->IgnoredActor = Request.IgnoredActor;
+
+	if (!BotLOSAsync)
+	{
+		TraceNow(*Entry, TimeSeconds);
+		OutResult = Entry->Result;
+		return true;
+	}
+
+	const float Age = Entry->ResultTime >= 0.0f ? TimeSeconds - Entry->ResultTime : MAX_flt;
+	if (Age > BotLOSMaxAge && !Entry->bPending)
+	{
+		Entry->bPending = true;
+		PendingKeys.Add(Key);
+	}
+
+	if (Age > BotLOSMaxStaleAge)
+	{
+		INC_DWORD_STAT(STAT_ShooterBotLOSMisses);
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_ShooterBotLOSHits);
+	OutResult = Entry->Result;
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Batching
+
+void UShooterBotLOSScheduler::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterBotLOSSubmit);
+
+	UWorld* World = GetWorld();
+	const float TimeSeconds = World->GetTimeSeconds();
+
+	// everything requested this frame goes out as one batch, results are delivered at the start of next frame
+	for (const FLOSKey& Key : PendingKeys)
+	{
+		FLOSEntry* Entry = Entries.Find(Key);
+		if (Entry == nullptr)
+		{
+			continue;
+		}
+
+		FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(AILosTrace), true, Entry->IgnoredActor.Get());
+
+		const uint32 TraceId = NextTraceId++;
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Entry->Start, Entry->End, COLLISION_WEAPON, TraceParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, TraceId);
+		InFlightKeys.Add(TraceId, Key);
+	}
+
+	INC_DWORD_STAT_BY(STAT_ShooterBotLOSTraces, PendingKeys.Num());
+	PendingKeys.Reset();
+
+	if (TimeSeconds - LastEvictTime > 1.0f)
+	{
+		LastEvictTime = TimeSeconds;
+		for (auto It = Entries.CreateIterator(); It; ++It)
+		{
+			if (TimeSeconds - It.Value().LastRequestTime > BotLOSEvictTime)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_ShooterBotLOSEntries, Entries.Num());
+}
+
+bool UShooterBotLOSScheduler::IsTickable() const
+{
+	return PendingKeys.Num() > 0 || Entries.Num() > 0;
+}
+
+TStatId UShooterBotLOSScheduler::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterBotLOSScheduler, STATGROUP_Tickables);
+}
+
+UWorld* UShooterBotLOSScheduler::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+void UShooterBotLOSScheduler::OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	FLOSKey Key;
+	if (!InFlightKeys.RemoveAndCopyValue(Datum.UserData, Key))
+	{
+		return;
+	}
+
+	// the entry may have been evicted while the trace was in flight
+	FLOSEntry* Entry = Entries.Find(Key);
+	if (Entry == nullptr)
+	{
+		return;
+	}
+
+	const FHitResult* Hit = Datum.OutHits.Num() > 0 ? &Datum.OutHits[0] : nullptr;
+
+	Entry->Result.bBlockingHit = Hit && Hit->bBlockingHit;
+	Entry->Result.HitActor = Hit ? Hit->GetActor() : nullptr;
+	Entry->Result.ImpactPoint = Hit ? Hit->ImpactPoint : FVector::ZeroVector;
+	Entry->ResultTime = GetWorld()->GetTimeSeconds();
+	Entry->bPending = false;
+}
+
+void UShooterBotLOSScheduler::TraceNow(FLOSEntry& Entry, float TimeSeconds) const
+{
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(AILosTrace), true, Entry.IgnoredActor.Get());
+
+	FHitResult Hit(ForceInit);
+	GetWorld()->LineTraceSingleByChannel(Hit, Entry.Start, Entry.End, COLLISION_WEAPON, TraceParams);
+
+	Entry.Result.bBlockingHit = Hit.bBlockingHit;
+	Entry.Result.HitActor = Hit.GetActor();
+	Entry.Result.ImpactPoint = Hit.ImpactPoint;
+	Entry.ResultTime = TimeSeconds;
+}
@@ -0,0 +1,406 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Effects/ShooterDecalManager.h"
+#include "ShooterGameUserSettings.h"
+#include "Components/DecalComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Decal Manager Spawn"), STAT_ShooterDecalManagerSpawn, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Live Decals"), STAT_ShooterLiveDecals, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Recycled Decals"), STAT_ShooterRecycledDecals, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Merged Decals"), STAT_ShooterMergedDecals, STATGROUP_ShooterGame);
+
+static int32 DecalsMaxDecals = -1;
+FAutoConsoleVariableRef CVarDecalsMaxDecals(
+	TEXT("ShooterGame.Decals.MaxDecals"),
+	DecalsMaxDecals,
+	TEXT("Overrides the decal budget from the game user settings, -1 to use the settings."),
+	ECVF_Default);
+
+static float DecalsFadeScreenSize = 0.01f;
+FAutoConsoleVariableRef CVarDecalsFadeScreenSize(
+	TEXT("ShooterGame.Decals.FadeScreenSize"),
+	DecalsFadeScreenSize,
+	TEXT("Screen size below which decals fade out. Applies to decal components created after the change."),
+	ECVF_Default);
+
+static int32 DecalsMerge = 1;
+FAutoConsoleVariableRef CVarDecalsMerge(
+	TEXT("ShooterGame.Decals.Merge"),
+	DecalsMerge,
+	TEXT("Repeated hits with the same material on the same spot grow the existing decal instead of adding one."),
+	ECVF_Default);
+
+static float DecalsMergeCellSize = 40.0f;
+FAutoConsoleVariableRef CVarDecalsMergeCellSize(
+	TEXT("ShooterGame.Decals.MergeCellSize"),
+	DecalsMergeCellSize,
+	TEXT("Hits in the same cell of this size are merged, in uu."),
+	ECVF_Default);
+
+static int32 DecalsMaxMergeSteps = 4;
+FAutoConsoleVariableRef CVarDecalsMaxMergeSteps(
+	TEXT("ShooterGame.Decals.MaxMergeSteps"),
+	DecalsMaxMergeSteps,
+	TEXT("Times a merged decal grows, later hits only refresh it."),
+	ECVF_Default);
+
+static float DecalsMergeGrowth = 0.15f;
+FAutoConsoleVariableRef CVarDecalsMergeGrowth(
+	TEXT("ShooterGame.Decals.MergeGrowth"),
+	DecalsMergeGrowth,
+	TEXT("Fraction of its original size a decal grows by per merged hit."),
+	ECVF_Default);
+
+UShooterDecalManager::UShooterDecalManager(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	OldestSlot = INDEX_NONE;
+	NewestSlot = INDEX_NONE;
+	NumLive = 0;
+	ExpiryCheckCountdown = 0.0f;
+}
+
+UShooterDecalManager* UShooterDecalManager::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UShooterDecalManager>() : nullptr;
+}
+
+bool UShooterDecalManager::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && !IsRunningDedicatedServer();
+}
+
+void UShooterDecalManager::Deinitialize()
+{
+	for (UDecalComponent* DecalComp : DecalComponents)
+	{
+		if (DecalComp)
+		{
+			DecalComp->DestroyComponent();
+		}
+	}
+
+	DEC_DWORD_STAT_BY(STAT_ShooterLiveDecals, NumLive);
+
+	DecalComponents.Empty();
+	Slots.Empty();
+	FreeSlots.Empty();
+	MergeSlots.Empty();
+	OldestSlot = INDEX_NONE;
+	NewestSlot = INDEX_NONE;
+	NumLive = 0;
+
+	Super::Deinitialize();
+}
+
+void UShooterDecalManager::Tick(float DeltaTime)
+{
+	ExpiryCheckCountdown -= DeltaTime;
+	if (ExpiryCheckCountdown > 0.0f)
+	{
+		return;
+	}
+	ExpiryCheckCountdown = 0.25f;
+
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+
+	int32 SlotIndex = OldestSlot;
+	while (SlotIndex != INDEX_NONE)
+	{
+		const FDecalSlot& Slot = Slots[SlotIndex];
+		const int32 NextIndex = Slot.Next;
+
+		// decals on a component that went away would be left floating
+		if (TimeSeconds >= Slot.ExpireTime || Slot.AttachParent.IsStale())
+		{
+			ReleaseSlot(SlotIndex);
+		}
+
+		SlotIndex = NextIndex;
+	}
+}
+
+bool UShooterDecalManager::IsTickable() const
+{
+	return NumLive > 0;
+}
+
+TStatId UShooterDecalManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterDecalManager, STATGROUP_Tickables);
+}
+
+UWorld* UShooterDecalManager::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+int32 UShooterDecalManager::GetBudget() const
+{
+	if (DecalsMaxDecals >= 0)
+	{
+		return DecalsMaxDecals;
+	}
+
+	const UShooterGameUserSettings* UserSettings = GEngine ? Cast<UShooterGameUserSettings>(GEngine->GetGameUserSettings()) : nullptr;
+	if (UserSettings == nullptr)
+	{
+		return 128;
+	}
+
+	// low quality keeps half
+	return UserSettings->GetGraphicsQuality() == 0 ? UserSettings->GetMaxDecals() / 2 : UserSettings->GetMaxDecals();
+}
+
+bool UShooterDecalManager::IsInRange(const FVector& Location) const
+{
+	const UShooterGameUserSettings* UserSettings = GEngine ? Cast<UShooterGameUserSettings>(GEngine->GetGameUserSettings()) : nullptr;
+	const float CullDistance = UserSettings ? UserSettings->GetDecalCullDistance() : 0.0f;
+	if (CullDistance <= 0.0f)
+	{
+		return true;
+	}
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		if (PC && PC->IsLocalController() && PC->PlayerCameraManager &&
+			FVector::DistSquared(PC->PlayerCameraManager->GetCameraLocation(), Location) < FMath::Square(CullDistance))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void UShooterDecalManager::SpawnDecal(const FDecalData& Decal, const FVector& DecalExtent, const FHitResult& Impact)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterDecalManagerSpawn);
+
+	if (Decal.DecalMaterial == nullptr || !IsInRange(Impact.ImpactPoint))
+	{
+		return;
+	}
+
+	USceneComponent* HitComponent = Impact.Component.Get();
+
+	uint32 MergeKey = 0;
+	if (DecalsMerge && DecalsMergeCellSize > 0.0f)
+	{
+		// facing is part of the key, so hits on both sides of a corner don't merge
+		const FVector CellLocation = Impact.ImpactPoint / DecalsMergeCellSize;
+		const FIntVector Cell(FMath::FloorToInt(CellLocation.X), FMath::FloorToInt(CellLocation.Y), FMath::FloorToInt(CellLocation.Z));
+		const FIntVector Facing(FMath::RoundToInt(Impact.ImpactNormal.X), FMath::RoundToInt(Impact.ImpactNormal.Y), FMath::RoundToInt(Impact.ImpactNormal.Z));
+
+		MergeKey = HashCombine(HashCombine(GetTypeHash(Cell), GetTypeHash(Facing)), HashCombine(GetTypeHash(Decal.DecalMaterial), GetTypeHash(HitComponent)));
+		MergeKey |= 1;
+
+		if (MergeDecal(MergeKey))
+		{
+			INC_DWORD_STAT(STAT_ShooterMergedDecals);
+			return;
+		}
+	}
+
+	const int32 SlotIndex = AllocateSlot();
+	if (SlotIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	FDecalSlot& Slot = Slots[SlotIndex];
+	UDecalComponent* DecalComp = Slot.Decal;
+
+	FRotator RandomDecalRotation = Impact.ImpactNormal.Rotation();
+	RandomDecalRotation.Roll = FMath::FRandRange(-180.0f, 180.0f);
+
+	DecalComp->SetDecalMaterial(Decal.DecalMaterial);
+	DecalComp->DecalSize = DecalExtent;
+
+	// only decals on moving surfaces need to follow them
+	if (HitComponent && HitComponent->Mobility == EComponentMobility::Movable)
+	{
+		DecalComp->AttachToComponent(HitComponent, FAttachmentTransformRules::KeepWorldTransform, Impact.BoneName);
+		Slot.AttachParent = HitComponent;
+	}
+	DecalComp->SetWorldLocationAndRotation(Impact.ImpactPoint, RandomDecalRotation);
+
+	Slot.BaseExtent = DecalExtent;
+	Slot.NumMerged = 0;
+	Slot.LifeSpan = Decal.LifeSpan;
+
+	if (MergeKey != 0)
+	{
+		Slot.MergeKey = MergeKey;
+		MergeSlots.Add(MergeKey, SlotIndex);
+	}
+
+	ActivateSlot(SlotIndex);
+}
+
+bool UShooterDecalManager::MergeDecal(uint32 MergeKey)
+{
+	const int32* SlotIndex = MergeSlots.Find(MergeKey);
+	if (SlotIndex == nullptr)
+	{
+		return false;
+	}
+
+	FDecalSlot& Slot = Slots[*SlotIndex];
+	if (Slot.NumMerged < DecalsMaxMergeSteps)
+	{
+		Slot.NumMerged++;
+		Slot.Decal->DecalSize = Slot.BaseExtent * (1.0f + DecalsMergeGrowth * Slot.NumMerged);
+	}
+
+	ActivateSlot(*SlotIndex);
+	return true;
+}
+
+int32 UShooterDecalManager::AllocateSlot()
+{
+	const int32 Budget = GetBudget();
+	if (Budget <= 0)
+	{
+		return INDEX_NONE;
+	}
+
+	// recycle the oldest, more than one if the budget was lowered
+	while (NumLive >= Budget && OldestSlot != INDEX_NONE)
+	{
+		ReleaseSlot(OldestSlot);
+		INC_DWORD_STAT(STAT_ShooterRecycledDecals);
+	}
+
+	if (FreeSlots.Num() > 0)
+	{
+		return FreeSlots.Pop(false);
+	}
+
+	UDecalComponent* DecalComp = NewObject<UDecalComponent>(this);
+	DecalComp->bAllowAnyoneToDestroyMe = true;
+	DecalComp->SetFadeScreenSize(DecalsFadeScreenSize);
+	DecalComp->SetVisibility(false);
+	DecalComp->RegisterComponentWithWorld(GetWorld());
+	DecalComponents.Add(DecalComp);
+
+	const int32 SlotIndex = Slots.AddZeroed();
+	FDecalSlot& Slot = Slots[SlotIndex];
+	Slot.Decal = DecalComp;
+	Slot.Prev = INDEX_NONE;
+	Slot.Next = INDEX_NONE;
+	return SlotIndex;
+}
+
+void UShooterDecalManager::ActivateSlot(int32 SlotIndex)
+{
+	FDecalSlot& Slot = Slots[SlotIndex];
+
+	if (Slot.bLive)
+	{
+		Unlink(SlotIndex);
+	}
+	else
+	{
+		Slot.bLive = true;
+		NumLive++;
+		INC_DWORD_STAT(STAT_ShooterLiveDecals);
+	}
+	LinkNewest(SlotIndex);
+
+	// no life span keeps the decal until it's recycled
+	if (Slot.LifeSpan > 0.0f)
+	{
+		const float FadeDuration = FMath::Min(1.0f, Slot.LifeSpan * 0.25f);
+		Slot.ExpireTime = GetWorld()->GetTimeSeconds() + Slot.LifeSpan;
+		Slot.Decal->SetFadeOut(Slot.LifeSpan - FadeDuration, FadeDuration, false);
+	}
+	else
+	{
+		Slot.ExpireTime = MAX_flt;
+	}
+
+	Slot.Decal->SetVisibility(true);
+	Slot.Decal->MarkRenderStateDirty();
+}
+
+void UShooterDecalManager::ReleaseSlot(int32 SlotIndex)
+{
+	FDecalSlot& Slot = Slots[SlotIndex];
+	if (!Slot.bLive)
+	{
+		return;
+	}
+
+	Unlink(SlotIndex);
+	Slot.bLive = false;
+	NumLive--;
+	DEC_DWORD_STAT(STAT_ShooterLiveDecals);
+
+	if (Slot.MergeKey != 0)
+	{
+		const int32* MergedSlot = MergeSlots.Find(Slot.MergeKey);
+		if (MergedSlot && *MergedSlot == SlotIndex)
+		{
+			MergeSlots.Remove(Slot.MergeKey);
+		}
+		Slot.MergeKey = 0;
+	}
+
+	if (Slot.Decal)
+	{
+		Slot.Decal->SetVisibility(false);
+		if (Slot.Decal->GetAttachParent())
+		{
+			Slot.Decal->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+		}
+	}
+	Slot.AttachParent.Reset();
+
+	FreeSlots.Add(SlotIndex);
+}
+
+void UShooterDecalManager::LinkNewest(int32 SlotIndex)
+{
+	FDecalSlot& Slot = Slots[SlotIndex];
+	Slot.Prev = NewestSlot;
+	Slot.Next = INDEX_NONE;
+
+	if (NewestSlot != INDEX_NONE)
+	{
+		Slots[NewestSlot].Next = SlotIndex;
+	}
+	else
+	{
+		OldestSlot = SlotIndex;
+	}
+	NewestSlot = SlotIndex;
+}
+
+void UShooterDecalManager::Unlink(int32 SlotIndex)
+{
+	FDecalSlot& Slot = Slots[SlotIndex];
+
+	if (Slot.Prev != INDEX_NONE)
+	{
+		Slots[Slot.Prev].Next = Slot.Next;
+	}
+	else
+	{
+		OldestSlot = Slot.Next;
+	}
+
+	if (Slot.Next != INDEX_NONE)
+	{
+		Slots[Slot.Next].Prev = Slot.Prev;
+	}
+	else
+	{
+		NewestSlot = Slot.Prev;
+	}
+
+	Slot.Prev = INDEX_NONE;
+	Slot.Next = INDEX_NONE;
+}
@@ -0,0 +1,479 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Effects/ShooterEffectManager.h"
+#include "Effects/ShooterImpactEffect.h"
+#include "Effects/ShooterExplosionEffect.h"
+#include "Effects/ShooterDecalManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Effect Manager Play"), STAT_ShooterEffectManagerPlay, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Effect Emitters"), STAT_ShooterPooledEmitters, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Effect Sounds"), STAT_ShooterPooledSounds, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Culled Impacts"), STAT_ShooterCulledImpacts, STATGROUP_ShooterGame);
+
+static int32 EffectsMaxImpactsPerFrame = 16;
+FAutoConsoleVariableRef CVarEffectsMaxImpactsPerFrame(
+	TEXT("ShooterGame.Effects.MaxImpactsPerFrame"),
+	EffectsMaxImpactsPerFrame,
+	TEXT("Impact effects played per frame, any more are dropped."),
+	ECVF_Default);
+
+static int32 EffectsMaxEmittersPerArea = 4;
+FAutoConsoleVariableRef CVarEffectsMaxEmittersPerArea(
+	TEXT("ShooterGame.Effects.MaxEmittersPerArea"),
+	EffectsMaxEmittersPerArea,
+	TEXT("Impact emitters playing at once in one area cell, any more are dropped."),
+	ECVF_Default);
+
+static float EffectsAreaCellSize = 400.0f;
+FAutoConsoleVariableRef CVarEffectsAreaCellSize(
+	TEXT("ShooterGame.Effects.AreaCellSize"),
+	EffectsAreaCellSize,
+	TEXT("Size of the cells the per area budget is counted in, in uu."),
+	ECVF_Default);
+
+static float EffectsDuplicateCellSize = 50.0f;
+FAutoConsoleVariableRef CVarEffectsDuplicateCellSize(
+	TEXT("ShooterGame.Effects.DuplicateCellSize"),
+	EffectsDuplicateCellSize,
+	TEXT("Impacts of the same effect closer than this within one frame are played once, in uu."),
+	ECVF_Default);
+
+static float EffectsImpactCullDistance = 6000.0f;
+FAutoConsoleVariableRef CVarEffectsImpactCullDistance(
+	TEXT("ShooterGame.Effects.ImpactCullDistance"),
+	EffectsImpactCullDistance,
+	TEXT("Impacts further than this from every local view are not played, in uu."),
+	ECVF_Default);
+
+static float EffectsExplosionCullDistance = 20000.0f;
+FAutoConsoleVariableRef CVarEffectsExplosionCullDistance(
+	TEXT("ShooterGame.Effects.ExplosionCullDistance"),
+	EffectsExplosionCullDistance,
+	TEXT("Explosions further than this from every local view are not played, in uu."),
+	ECVF_Default);
+
+static float EffectsViewAnglePadding = 15.0f;
+FAutoConsoleVariableRef CVarEffectsViewAnglePadding(
+	TEXT("ShooterGame.Effects.ViewAnglePadding"),
+	EffectsViewAnglePadding,
+	TEXT("Degrees added to half the view FOV before effect visuals are culled as off screen."),
+	ECVF_Default);
+
+static int32 EffectsMaxFreePerTemplate = 8;
+FAutoConsoleVariableRef CVarEffectsMaxFreePerTemplate(
+	TEXT("ShooterGame.Effects.MaxFreePerTemplate"),
+	EffectsMaxFreePerTemplate,
+	TEXT("Idle components kept per particle system or sound, any more are destroyed."),
+	ECVF_Default);
+
+UShooterEffectManager::UShooterEffectManager(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	NumImpactsThisFrame = 0;
+	LastUpdateFrame = 0;
+}
+
+UShooterEffectManager* UShooterEffectManager::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UShooterEffectManager>() : nullptr;
+}
+
+bool UShooterEffectManager::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && !IsRunningDedicatedServer();
+}
+
+void UShooterEffectManager::Deinitialize()
+{
+	for (UParticleSystemComponent* Emitter : AllEmitters)
+	{
+		if (Emitter)
+		{
+			Emitter->DestroyComponent();
+		}
+	}
+
+	for (UAudioComponent* Sound : AllSounds)
+	{
+		if (Sound)
+		{
+			Sound->DestroyComponent();
+		}
+	}
+
+	for (UPointLightComponent* Light : AllLights)
+	{
+		if (Light)
+		{
+			Light->DestroyComponent();
+		}
+	}
+
+	DEC_DWORD_STAT_BY(STAT_ShooterPooledEmitters, AllEmitters.Num());
+	DEC_DWORD_STAT_BY(STAT_ShooterPooledSounds, AllSounds.Num());
+
+	AllEmitters.Empty();
+	AllSounds.Empty();
+	AllLights.Empty();
+	FreeEmitters.Empty();
+	FreeSounds.Empty();
+	FreeLights.Empty();
+	PlayingEmitterCells.Empty();
+	AreaCellCounts.Empty();
+	ActiveLights.Empty();
+
+	Super::Deinitialize();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Frame
+
+void UShooterEffectManager::Tick(float DeltaTime)
+{
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+
+	for (int32 i = ActiveLights.Num() - 1; i >= 0; i--)
+	{
+		FActiveLight& Active = ActiveLights[i];
+		const float TimeRemaining = FMath::Max(0.0f, Active.FadeOut - (TimeSeconds - Active.StartTime));
+
+		if (TimeRemaining > 0 && Active.Light)
+		{
+			const float FadeAlpha = 1.0f - FMath::Square(TimeRemaining / Active.FadeOut);
+			Active.Light->SetIntensity(Active.Intensity * FadeAlpha);
+		}
+		else
+		{
+			if (Active.Light)
+			{
+				Active.Light->SetVisibility(false);
+				FreeLights.Add(Active.Light);
+			}
+			ActiveLights.RemoveAtSwap(i, 1, false);
+		}
+	}
+}
+
+bool UShooterEffectManager::IsTickable() const
+{
+	return ActiveLights.Num() > 0;
+}
+
+TStatId UShooterEffectManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterEffectManager, STATGROUP_Tickables);
+}
+
+UWorld* UShooterEffectManager::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+void UShooterEffectManager::UpdateFrame()
+{
+	if (LastUpdateFrame == GFrameCounter)
+	{
+		return;
+	}
+
+	LastUpdateFrame = GFrameCounter;
+	NumImpactsThisFrame = 0;
+	ImpactsThisFrame.Reset();
+	Views.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		if (PC && PC->IsLocalController() && PC->PlayerCameraManager)
+		{
+			FEffectView& View = Views.AddDefaulted_GetRef();
+			View.Location = PC->PlayerCameraManager->GetCameraLocation();
+			View.Direction = PC->PlayerCameraManager->GetCameraRotation().Vector();
+			View.CosHalfFOV = FMath::Cos(FMath::DegreesToRadians(FMath::Min(179.0f, PC->PlayerCameraManager->GetFOVAngle() * 0.5f + EffectsViewAnglePadding)));
+		}
+	}
+}
+
+bool UShooterEffectManager::IsInRange(const FVector& Location, float CullDistance) const
+{
+	for (const FEffectView& View : Views)
+	{
+		if (FVector::DistSquared(View.Location, Location) < FMath::Square(CullDistance))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool UShooterEffectManager::IsInView(const FVector& Location) const
+{
+	for (const FEffectView& View : Views)
+	{
+		const FVector ToLocation = Location - View.Location;
+		const float Dist = ToLocation.Size();
+
+		// close effects can spill into view even when their origin is just off screen
+		if (Dist < 200.0f || (ToLocation | View.Direction) >= Dist * View.CosHalfFOV)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+FIntVector UShooterEffectManager::GetAreaCell(const FVector& Location) const
+{
+	const float CellSize = FMath::Max(10.0f, EffectsAreaCellSize);
+	return FIntVector(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize), FMath::FloorToInt(Location.Z / CellSize));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Effects
+
+void UShooterEffectManager::PlayImpactEffect(TSubclassOf<AShooterImpactEffect> ImpactTemplate, const FHitResult& Impact)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterEffectManagerPlay);
+
+	const AShooterImpactEffect* Template = ImpactTemplate ? ImpactTemplate->GetDefaultObject<AShooterImpactEffect>() : nullptr;
+	if (Template == nullptr)
+	{
+		return;
+	}
+
+	UpdateFrame();
+
+	const FVector Location = Impact.ImpactPoint;
+	if (NumImpactsThisFrame >= EffectsMaxImpactsPerFrame || !IsInRange(Location, EffectsImpactCullDistance))
+	{
+		INC_DWORD_STAT(STAT_ShooterCulledImpacts);
+		return;
+	}
+
+	// shotguns and fast weapons put many hits in one spot per frame, one effect covers them all
+	const float DuplicateCellSize = FMath::Max(1.0f, EffectsDuplicateCellSize);
+	const FIntVector DuplicateCell(FMath::FloorToInt(Location.X / DuplicateCellSize), FMath::FloorToInt(Location.Y / DuplicateCellSize), FMath::FloorToInt(Location.Z / DuplicateCellSize));
+	bool bAlreadyPlayed = false;
+	ImpactsThisFrame.Add(HashCombine(GetTypeHash(DuplicateCell), GetTypeHash(Template)), &bAlreadyPlayed);
+	if (bAlreadyPlayed)
+	{
+		INC_DWORD_STAT(STAT_ShooterCulledImpacts);
+		return;
+	}
+
+	NumImpactsThisFrame++;
+
+	const EPhysicalSurface HitSurfaceType = UPhysicalMaterial::DetermineSurfaceType(Impact.PhysMaterial.Get());
+
+	// sounds are heard off screen, the emitter budget doesn't apply to them
+	USoundCue* ImpactSound = Template->GetImpactSound(HitSurfaceType);
+	if (ImpactSound)
+	{
+		PlaySound(ImpactSound, Location);
+	}
+
+	UParticleSystem* ImpactFX = Template->GetImpactFX(HitSurfaceType);
+	if (ImpactFX && IsInView(Location))
+	{
+		PlayEmitter(ImpactFX, Location, Impact.ImpactNormal.Rotation(), true);
+	}
+
+	UShooterDecalManager* DecalManager = UShooterDecalManager::Get(this);
+	if (Template->DefaultDecal.DecalMaterial && DecalManager)
+	{
+		DecalManager->SpawnDecal(Template->DefaultDecal, FVector(1.0f, Template->DefaultDecal.DecalSize, Template->DefaultDecal.DecalSize), Impact);
+	}
+}
+
+void UShooterEffectManager::PlayExplosionEffect(TSubclassOf<AShooterExplosionEffect> ExplosionTemplate, const FHitResult& Impact, const FTransform& EffectTM)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterEffectManagerPlay);
+
+	const AShooterExplosionEffect* Template = ExplosionTemplate ? ExplosionTemplate->GetDefaultObject<AShooterExplosionEffect>() : nullptr;
+	if (Template == nullptr)
+	{
+		return;
+	}
+
+	UpdateFrame();
+
+	const FVector Location = EffectTM.GetLocation();
+	if (!IsInRange(Location, EffectsExplosionCullDistance))
+	{
+		return;
+	}
+
+	if (Template->ExplosionSound)
+	{
+		PlaySound(Template->ExplosionSound, Location);
+	}
+
+	// explosions are rare enough to skip the area budget, but not worth drawing off screen
+	if (IsInView(Location))
+	{
+		if (Template->ExplosionFX)
+		{
+			PlayEmitter(Template->ExplosionFX, Location, EffectTM.Rotator(), false);
+		}
+
+		PlayLight(Template, Location);
+	}
+
+	UShooterDecalManager* DecalManager = UShooterDecalManager::Get(this);
+	if (Template->Decal.DecalMaterial && DecalManager)
+	{
+		DecalManager->SpawnDecal(Template->Decal, FVector(Template->Decal.DecalSize, Template->Decal.DecalSize, 1.0f), Impact);
+	}
+}
+
+bool UShooterEffectManager::PlayEmitter(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation, bool bCheckAreaBudget)
+{
+	const FIntVector Cell = GetAreaCell(Location);
+	int32& CellCount = AreaCellCounts.FindOrAdd(Cell);
+	if (bCheckAreaBudget && CellCount >= EffectsMaxEmittersPerArea)
+	{
+		INC_DWORD_STAT(STAT_ShooterCulledImpacts);
+		return false;
+	}
+
+	UParticleSystemComponent* Emitter = nullptr;
+
+	TArray<UParticleSystemComponent*>* FreeList = FreeEmitters.Find(Template);
+	if (FreeList && FreeList->Num() > 0)
+	{
+		Emitter = FreeList->Pop(false);
+	}
+
+	if (Emitter == nullptr)
+	{
+		// same setup as UGameplayStatics::SpawnEmitterAtLocation, minus the auto destroy
+		Emitter = NewObject<UParticleSystemComponent>(this);
+		Emitter->bAutoDestroy = false;
+		Emitter->bAllowAnyoneToDestroyMe = true;
+		Emitter->SecondsBeforeInactive = 0.0f;
+		Emitter->bAutoActivate = false;
+		Emitter->SetTemplate(Template);
+		Emitter->bOverrideLODMethod = false;
+		Emitter->SetUsingAbsoluteLocation(true);
+		Emitter->SetUsingAbsoluteRotation(true);
+		Emitter->SetUsingAbsoluteScale(true);
+		Emitter->OnSystemFinished.AddDynamic(this, &UShooterEffectManager::OnEmitterFinished);
+		Emitter->RegisterComponentWithWorld(GetWorld());
+
+		AllEmitters.Add(Emitter);
+		INC_DWORD_STAT(STAT_ShooterPooledEmitters);
+	}
+
+	Emitter->SetWorldLocationAndRotation(Location, Rotation);
+	Emitter->ActivateSystem(true);
+
+	CellCount++;
+	PlayingEmitterCells.Add(Emitter, Cell);
+	return true;
+}
+
+void UShooterEffectManager::OnEmitterFinished(UParticleSystemComponent* Emitter)
+{
+	FIntVector Cell;
+	if (!PlayingEmitterCells.RemoveAndCopyValue(Emitter, Cell))
+	{
+		return;
+	}
+
+	int32* CellCount = AreaCellCounts.Find(Cell);
+	if (CellCount && --(*CellCount) <= 0)
+	{
+		AreaCellCounts.Remove(Cell);
+	}
+
+	TArray<UParticleSystemComponent*>& FreeList = FreeEmitters.FindOrAdd(Emitter->Template);
+	if (FreeList.Num() < EffectsMaxFreePerTemplate)
+	{
+		FreeList.Add(Emitter);
+	}
+	else
+	{
+		AllEmitters.RemoveSingleSwap(Emitter, false);
+		Emitter->DestroyComponent();
+		DEC_DWORD_STAT(STAT_ShooterPooledEmitters);
+	}
+}
+
+void UShooterEffectManager::PlaySound(USoundBase* Sound, const FVector& Location)
+{
+	UAudioComponent* AudioComp = nullptr;
+
+	TArray<UAudioComponent*>* FreeList = FreeSounds.Find(Sound);
+	if (FreeList && FreeList->Num() > 0)
+	{
+		AudioComp = FreeList->Pop(false);
+	}
+
+	if (AudioComp == nullptr)
+	{
+		AudioComp = NewObject<UAudioComponent>(this);
+		AudioComp->bAutoDestroy = false;
+		AudioComp->bAutoActivate = false;
+		AudioComp->bAllowSpatialization = true;
+		AudioComp->bIsUISound = false;
+		AudioComp->SetSound(Sound);
+		AudioComp->SetUsingAbsoluteLocation(true);
+		AudioComp->OnAudioFinishedNative.AddUObject(this, &UShooterEffectManager::OnSoundFinished);
+		AudioComp->RegisterComponentWithWorld(GetWorld());
+
+		AllSounds.Add(AudioComp);
+		INC_DWORD_STAT(STAT_ShooterPooledSounds);
+	}
+
+	AudioComp->SetWorldLocation(Location);
+	AudioComp->Play();
+}
+
+void UShooterEffectManager::OnSoundFinished(UAudioComponent* AudioComp)
+{
+	TArray<UAudioComponent*>& FreeList = FreeSounds.FindOrAdd(AudioComp->Sound);
+	if (FreeList.Num() < EffectsMaxFreePerTemplate)
+	{
+		FreeList.Add(AudioComp);
+	}
+	else
+	{
+		AllSounds.RemoveSingleSwap(AudioComp, false);
+		AudioComp->DestroyComponent();
+		DEC_DWORD_STAT(STAT_ShooterPooledSounds);
+	}
+}
+
+void UShooterEffectManager::PlayLight(const AShooterExplosionEffect* Template, const FVector& Location)
+{
+	const UPointLightComponent* DefLight = Template->GetExplosionLight();
+	if (DefLight == nullptr || Template->ExplosionLightFadeOut <= 0.0f)
+	{
+		return;
+	}
+
+	UPointLightComponent* Light = FreeLights.Num() > 0 ? FreeLights.Pop(false) : nullptr;
+	if (Light == nullptr)
+	{
+		Light = NewObject<UPointLightComponent>(this);
+		Light->SetUsingAbsoluteLocation(true);
+		Light->RegisterComponentWithWorld(GetWorld());
+		AllLights.Add(Light);
+	}
+
+	Light->SetAttenuationRadius(DefLight->AttenuationRadius);
+	Light->SetLightColor(FLinearColor(DefLight->LightColor));
+	Light->SetCastShadows(DefLight->CastShadows);
+	Light->bUseInverseSquaredFalloff = DefLight->bUseInverseSquaredFalloff;
+	Light->SetIntensity(0.0f);
+	Light->SetWorldLocation(Location);
+	Light->SetVisibility(true);
+
+	FActiveLight& Active = ActiveLights.AddDefaulted_GetRef();
+	Active.Light = Light;
+	Active.StartTime = GetWorld()->GetTimeSeconds();
+	Active.FadeOut = Template->ExplosionLightFadeOut;
+	Active.Intensity = DefLight->Intensity;
+}
@@ -2,6 +2,7 @@
 
 #include "ShooterGame.h"
 #include "ShooterExplosionEffect.h"
+#include "Effects/ShooterDecalManager.h"
 
 AShooterExplosionEffect::AShooterExplosionEffect(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
@@ -35,7 +36,12 @@ void AShooterExplosionEffect::BeginPlay()
 		UGameplayStatics::PlaySoundAtLocation(this, ExplosionSound, GetActorLocation());
 	}
 
-	if (Decal.DecalMaterial)
+	UShooterDecalManager* DecalManager = UShooterDecalManager::Get(this);
+	if (Decal.DecalMaterial && DecalManager)
+	{
+		DecalManager->SpawnDecal(Decal, FVector(Decal.DecalSize, Decal.DecalSize, 1.0f), SurfaceHit);
+	}
+	else if (Decal.DecalMaterial)
 	{
 		FRotator RandomDecalRotation = SurfaceHit.ImpactNormal.Rotation();
 		RandomDecalRotation.Roll = FMath::FRandRange(-180.0f, 180.0f);
@@ -2,6 +2,7 @@
 
 #include "ShooterGame.h"
 #include "ShooterImpactEffect.h"
+#include "Effects/ShooterDecalManager.h"
 
 AShooterImpactEffect::AShooterImpactEffect(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
@@ -29,7 +30,12 @@ void AShooterImpactEffect::PostInitializeComponents()
 		UGameplayStatics::PlaySoundAtLocation(this, ImpactSound, GetActorLocation());
 	}
 
-	if (DefaultDecal.DecalMaterial)
+	UShooterDecalManager* DecalManager = UShooterDecalManager::Get(this);
+	if (DefaultDecal.DecalMaterial && DecalManager)
+	{
+		DecalManager->SpawnDecal(DefaultDecal, FVector(1.0f, DefaultDecal.DecalSize, DefaultDecal.DecalSize), SurfaceHit);
+	}
+	else if (DefaultDecal.DecalMaterial)
 	{
 		FRotator RandomDecalRotation = SurfaceHit.ImpactNormal.Rotation();
 		RandomDecalRotation.Roll = FMath::FRandRange(-180.0f, 180.0f);
@@ -0,0 +1,287 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Effects/ShooterTracerManager.h"
+#include "Components/InstancedStaticMeshComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Tracer Manager Update"), STAT_ShooterTracerManagerUpdate, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Live Tracers"), STAT_ShooterLiveTracers, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Dropped Tracers"), STAT_ShooterDroppedTracers, STATGROUP_ShooterGame);
+
+static int32 TracersMaxTracers = 128;
+FAutoConsoleVariableRef CVarTracersMaxTracers(
+	TEXT("ShooterGame.Tracers.MaxTracers"),
+	TracersMaxTracers,
+	TEXT("Tracers drawn at once. Remote shots over the budget are dropped, local shots replace the oldest tracer."),
+	ECVF_Default);
+
+static float TracersSpeed = 15000.0f;
+FAutoConsoleVariableRef CVarTracersSpeed(
+	TEXT("ShooterGame.Tracers.Speed"),
+	TracersSpeed,
+	TEXT("Speed tracers travel at, in uu/s."),
+	ECVF_Default);
+
+static float TracersSegmentLength = 600.0f;
+FAutoConsoleVariableRef CVarTracersSegmentLength(
+	TEXT("ShooterGame.Tracers.SegmentLength"),
+	TracersSegmentLength,
+	TEXT("Length of the visible tracer segment, in uu."),
+	ECVF_Default);
+
+static float TracersWidth = 2.0f;
+FAutoConsoleVariableRef CVarTracersWidth(
+	TEXT("ShooterGame.Tracers.Width"),
+	TracersWidth,
+	TEXT("Width of tracers close to the view, in uu."),
+	ECVF_Default);
+
+static float TracersLODDistance = 4000.0f;
+FAutoConsoleVariableRef CVarTracersLODDistance(
+	TEXT("ShooterGame.Tracers.LODDistance"),
+	TracersLODDistance,
+	TEXT("Remote tracers passing further than this from every local view are thinned out and drawn wider so they stay visible, in uu."),
+	ECVF_Default);
+
+static int32 TracersFarKeepEveryNth = 3;
+FAutoConsoleVariableRef CVarTracersFarKeepEveryNth(
+	TEXT("ShooterGame.Tracers.FarKeepEveryNth"),
+	TracersFarKeepEveryNth,
+	TEXT("Only every Nth remote tracer beyond the LOD distance is drawn."),
+	ECVF_Default);
+
+static float TracersCullDistance = 15000.0f;
+FAutoConsoleVariableRef CVarTracersCullDistance(
+	TEXT("ShooterGame.Tracers.CullDistance"),
+	TracersCullDistance,
+	TEXT("Remote tracers passing further than this from every local view are not drawn, in uu."),
+	ECVF_Default);
+
+UShooterTracerManager::UShooterTracerManager(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	NumFarTracers = 0;
+}
+
+UShooterTracerManager* UShooterTracerManager::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UShooterTracerManager>() : nullptr;
+}
+
+bool UShooterTracerManager::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && !IsRunningDedicatedServer();
+}
+
+void UShooterTracerManager::Deinitialize()
+{
+	for (UInstancedStaticMeshComponent* Component : BatchComponents)
+	{
+		if (Component)
+		{
+			Component->DestroyComponent();
+		}
+	}
+
+	DEC_DWORD_STAT_BY(STAT_ShooterLiveTracers, Tracers.Num());
+
+	BatchComponents.Empty();
+	Batches.Empty();
+	Tracers.Empty();
+
+	Super::Deinitialize();
+}
+
+float UShooterTracerManager::GetViewDistSquared(const FVector& Start, const FVector& End) const
+{
+	float BestDistSq = MAX_FLT;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		if (PC && PC->IsLocalController() && PC->PlayerCameraManager)
+		{
+			BestDistSq = FMath::Min(BestDistSq, FMath::PointDistToSegmentSquared(PC->PlayerCameraManager->GetCameraLocation(), Start, End));
+		}
+	}
+
+	return BestDistSq;
+}
+
+int32 UShooterTracerManager::FindOrAddBatch(UStaticMesh* Mesh, UMaterialInterface* Material)
+{
+	const int32 ExistingIndex = Batches.IndexOfByPredicate([Mesh, Material](const FTracerBatch& Batch)
+	{
+		return Batch.Mesh == Mesh && Batch.Material == Material;
+	});
+
+	if (ExistingIndex != INDEX_NONE)
+	{
+		return ExistingIndex;
+	}
+
+	UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(this);
+	Component->SetMobility(EComponentMobility::Movable);
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetCastShadow(false);
+	Component->SetStaticMesh(Mesh);
+	if (Material)
+	{
+		Component->SetMaterial(0, Material);
+	}
+	Component->RegisterComponentWithWorld(GetWorld());
+	BatchComponents.Add(Component);
+
+	FTracerBatch& Batch = Batches.AddDefaulted_GetRef();
+	Batch.Mesh = Mesh;
+	Batch.Material = Material;
+	Batch.Component = Component;
+	return Batches.Num() - 1;
+}
+
+bool UShooterTracerManager::AddTracer(UStaticMesh* Mesh, UMaterialInterface* Material, const FVector& Origin, const FVector& EndPoint, bool bLocalShot)
+{
+	const FVector Path = EndPoint - Origin;
+	const float Length = Path.Size();
+	if (Mesh == nullptr || Length < KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	if (!bLocalShot)
+	{
+		const float ViewDistSq = GetViewDistSquared(Origin, EndPoint);
+		if (ViewDistSq > FMath::Square(TracersCullDistance))
+		{
+			INC_DWORD_STAT(STAT_ShooterDroppedTracers);
+			return false;
+		}
+
+		if (ViewDistSq > FMath::Square(TracersLODDistance) && (NumFarTracers++ % FMath::Max(1, TracersFarKeepEveryNth)) != 0)
+		{
+			INC_DWORD_STAT(STAT_ShooterDroppedTracers);
+			return false;
+		}
+	}
+
+	if (Tracers.Num() >= TracersMaxTracers)
+	{
+		if (!bLocalShot || Tracers.Num() == 0)
+		{
+			INC_DWORD_STAT(STAT_ShooterDroppedTracers);
+			return false;
+		}
+
+		Tracers.RemoveAt(0, 1, false);
+		DEC_DWORD_STAT(STAT_ShooterLiveTracers);
+	}
+
+	FTracer& Tracer = Tracers.AddDefaulted_GetRef();
+	Tracer.Origin = Origin;
+	Tracer.Direction = Path / Length;
+	Tracer.Length = Length;
+	Tracer.StartTime = GetWorld()->GetTimeSeconds();
+	Tracer.BatchIndex = FindOrAddBatch(Mesh, Material);
+	INC_DWORD_STAT(STAT_ShooterLiveTracers);
+
+	return true;
+}
+
+void UShooterTracerManager::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterTracerManagerUpdate);
+
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+	const float SegmentLength = FMath::Max(1.0f, TracersSegmentLength);
+
+	for (FTracerBatch& Batch : Batches)
+	{
+		Batch.InstanceTransforms.Reset();
+	}
+
+	// every split screen player sees the same instances
+	TArray<FVector, TInlineAllocator<4>> ViewLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		if (PC && PC->IsLocalController() && PC->PlayerCameraManager)
+		{
+			ViewLocations.Add(PC->PlayerCameraManager->GetCameraLocation());
+		}
+	}
+
+	for (int32 i = Tracers.Num() - 1; i >= 0; i--)
+	{
+		const FTracer& Tracer = Tracers[i];
+		const float TravelDist = (TimeSeconds - Tracer.StartTime) * TracersSpeed;
+		const float HeadDist = FMath::Min(TravelDist, Tracer.Length);
+		const float TailDist = FMath::Max(0.0f, TravelDist - SegmentLength);
+
+		if (TailDist >= Tracer.Length)
+		{
+			Tracers.RemoveAt(i, 1, false);
+			DEC_DWORD_STAT(STAT_ShooterLiveTracers);
+			continue;
+		}
+
+		// fired this frame, not out of the muzzle yet
+		if (HeadDist <= TailDist)
+		{
+			continue;
+		}
+
+		const FVector Center = Tracer.Origin + Tracer.Direction * (0.5f * (HeadDist + TailDist));
+
+		// keep roughly the same screen width once past the LOD distance, sized for the closest view so it doesn't balloon in another player's
+		float Width = TracersWidth;
+		if (ViewLocations.Num() > 0)
+		{
+			float ViewDistSq = MAX_FLT;
+			for (const FVector& ViewLocation : ViewLocations)
+			{
+				ViewDistSq = FMath::Min(ViewDistSq, FVector::DistSquared(ViewLocation, Center));
+			}
+			Width *= FMath::Max(1.0f, FMath::Sqrt(ViewDistSq) / FMath::Max(1.0f, TracersLODDistance));
+		}
+
+		Batches[Tracer.BatchIndex].InstanceTransforms.Add(FTransform(Tracer.Direction.Rotation(), Center, FVector((HeadDist - TailDist) / 100.0f, Width / 100.0f, Width / 100.0f)));
+	}
+
+	for (FTracerBatch& Batch : Batches)
+	{
+		UInstancedStaticMeshComponent* Component = Batch.Component;
+		const int32 NumTransforms = Batch.InstanceTransforms.Num();
+
+		// removing from the end never shifts the remaining instances
+		while (Component->GetInstanceCount() > NumTransforms)
+		{
+			Component->RemoveInstance(Component->GetInstanceCount() - 1);
+		}
+		while (Component->GetInstanceCount() < NumTransforms)
+		{
+			Component->AddInstance(FTransform::Identity);
+		}
+
+		if (NumTransforms > 0)
+		{
+			Component->BatchUpdateInstancesTransforms(0, Batch.InstanceTransforms, true, true, true);
+		}
+	}
+}
+
+bool UShooterTracerManager::IsTickable() const
+{
+	// one more tick after the last tracer expires to clear its instance
+	return Tracers.Num() > 0 || Batches.ContainsByPredicate([](const FTracerBatch& Batch) { return Batch.Component->GetInstanceCount() > 0; });
+}
+
+TStatId UShooterTracerManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterTracerManager, STATGROUP_Tickables);
+}
+
+UWorld* UShooterTracerManager::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
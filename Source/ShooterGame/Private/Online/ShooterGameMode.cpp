@@ -10,6 +10,17 @@
 #include "Online/ShooterGameSession.h"
 #include "Bots/ShooterAIController.h"
 #include "ShooterTeamStart.h"
+#include "Player/ShooterPawnSpatialIndex.h"
+#include "Player/ShooterRespawnPool.h"
+
+DECLARE_CYCLE_STAT(TEXT("Choose Player Start"), STAT_ShooterChoosePlayerStart, STATGROUP_ShooterGame);
+
+static float SpawnSafeEnemyDistance = 1500.0f;
+FAutoConsoleVariableRef CVarSpawnSafeEnemyDistance(
+	TEXT("ShooterGame.Spawn.SafeEnemyDistance"),
+	SpawnSafeEnemyDistance,
+	TEXT("Free spawn points at least this far from the nearest enemy are picked at random. If there are none, the free one furthest from enemies is used."),
+	ECVF_Default);
 
 
 AShooterGameMode::AShooterGameMode(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
@@ -31,6 +42,9 @@ AShooterGameMode::AShooterGameMode(const FObjectInitializer& ObjectInitializer)
 
 	bAllowBots = true;	
 	bNeedsBotCreation = true;
+	SpawnCapsuleRadius = 0.0f;
+	SpawnCapsuleHalfHeight = 0.0f;
+	SpawnWaveFrame = 0;
 	bUseSeamlessTravel = FParse::Param(FCommandLine::Get(), TEXT("NoSeamlessTravel")) ? false : true;
 }
 
@@ -366,6 +380,26 @@ UClass* AShooterGameMode::GetDefaultPawnClassForController_Implementation(AContr
 	return Super::GetDefaultPawnClassForController_Implementation(InController);
 }
 
+APawn* AShooterGameMode::SpawnDefaultPawnAtTransform_Implementation(AController* NewPlayer, const FTransform& SpawnTransform)
+{
+	UShooterRespawnPool* RespawnPool = UShooterRespawnPool::Get(this);
+	if (RespawnPool)
+	{
+		if (AShooterCharacter* PooledPawn = RespawnPool->AcquirePawn(GetDefaultPawnClassForController(NewPlayer), SpawnTransform))
+		{
+			return PooledPawn;
+		}
+	}
+
+	APawn* NewPawn = Super::SpawnDefaultPawnAtTransform_Implementation(NewPlayer, SpawnTransform);
+	if (RespawnPool)
+	{
+		RespawnPool->AddPawn(Cast<AShooterCharacter>(NewPawn));
+	}
+
+	return NewPawn;
+}
+
 void AShooterGameMode::RestartPlayer(AController* NewPlayer)
 {
 	Super::RestartPlayer(NewPlayer);
@@ -386,49 +420,188 @@ void AShooterGameMode::RestartPlayer(AController* NewPlayer)
 
 AActor* AShooterGameMode::ChoosePlayerStart_Implementation(AController* Player)
 {
-	TArray<APlayerStart*> PreferredSpawns;
-	TArray<APlayerStart*> FallbackSpawns;
+	SCOPE_CYCLE_COUNTER(STAT_ShooterChoosePlayerStart);
+
+	PrepareSpawnWave();
+
+	if (APlayerStart* PIEStart = PIESpawnPoint.Get())
+	{
+		// Always prefer the first "Play from Here" PlayerStart, if we find one while in PIE mode
+		return PIEStart;
+	}
+
+	TArray<int32, TInlineAllocator<64>> PreferredSpawns;
+	TArray<int32, TInlineAllocator<64>> FallbackSpawns;
+
+	for (int32 i = 0; i < SpawnPoints.Num(); i++)
+	{
+		APlayerStart* TestSpawn = SpawnPoints[i].Start.Get();
+		if (TestSpawn && IsSpawnpointAllowed(TestSpawn, Player))
+		{
+			if (IsSpawnpointPreferred(TestSpawn, Player))
+			{
+				PreferredSpawns.Add(i);
+			}
+			else
+			{
+				FallbackSpawns.Add(i);
+			}
+		}
+	}
+
+	int32 BestIndex = INDEX_NONE;
+	if (PreferredSpawns.Num() > 0)
+	{
+		// pick at random from the free spawns away from enemies, or the free spawn furthest from them
+		const TArray<float>& EnemyDistSq = GetSpawnEnemyDistSq(Player);
+		const float SafeDistSq = FMath::Square(SpawnSafeEnemyDistance);
+
+		TArray<int32, TInlineAllocator<64>> SafeSpawns;
+		int32 FurthestIndex = PreferredSpawns[0];
+		for (int32 Index : PreferredSpawns)
+		{
+			if (EnemyDistSq[Index] >= SafeDistSq)
+			{
+				SafeSpawns.Add(Index);
+			}
+			if (EnemyDistSq[Index] > EnemyDistSq[FurthestIndex])
+			{
+				FurthestIndex = Index;
+			}
+		}
+
+		BestIndex = SafeSpawns.Num() > 0 ? SafeSpawns[FMath::RandHelper(SafeSpawns.Num())] : FurthestIndex;
+	}
+	else if (FallbackSpawns.Num() > 0)
+	{
+		BestIndex = FallbackSpawns[FMath::RandHelper(FallbackSpawns.Num())];
+	}
+
+	if (BestIndex != INDEX_NONE)
+	{
+		SpawnPoints[BestIndex].bClaimed = true;
+		return SpawnPoints[BestIndex].Start.Get();
+	}
+
+	return Super::ChoosePlayerStart_Implementation(Player);
+}
+
+void AShooterGameMode::CacheSpawnPoints()
+{
+	SpawnPoints.Reset();
+	SpawnPointIndices.Reset();
+	PIESpawnPoint.Reset();
 
-	APlayerStart* BestStart = NULL;
 	for (TActorIterator<APlayerStart> It(GetWorld()); It; ++It)
 	{
 		APlayerStart* TestSpawn = *It;
 		if (TestSpawn->IsA<APlayerStartPIE>())
 		{
-			// Always prefer the first "Play from Here" PlayerStart, if we find one while in PIE mode
-			BestStart = TestSpawn;
+			PIESpawnPoint = TestSpawn;
 			break;
 		}
-		else
+
+		FSpawnPointEntry& Entry = SpawnPoints.AddDefaulted_GetRef();
+		Entry.Start = TestSpawn;
+		Entry.Location = TestSpawn->GetActorLocation();
+		Entry.bOccupied = false;
+		Entry.bClaimed = false;
+		SpawnPointIndices.Add(TestSpawn, SpawnPoints.Num() - 1);
+	}
+
+	// capsule extents don't change during the match, read them from the class defaults once
+	SpawnCapsuleRadius = 0.0f;
+	SpawnCapsuleHalfHeight = 0.0f;
+	for (UClass* PawnClass : { DefaultPawnClass.Get(), BotPawnClass.Get() })
+	{
+		const ACharacter* DefaultCharacter = PawnClass ? Cast<ACharacter>(PawnClass->GetDefaultObject()) : NULL;
+		if (DefaultCharacter)
 		{
-			if (IsSpawnpointAllowed(TestSpawn, Player))
-			{
-				if (IsSpawnpointPreferred(TestSpawn, Player))
-				{
-					PreferredSpawns.Add(TestSpawn);
-				}
-				else
-				{
-					FallbackSpawns.Add(TestSpawn);
-				}
-			}
+			SpawnCapsuleRadius = FMath::Max(SpawnCapsuleRadius, DefaultCharacter->GetCapsuleComponent()->GetScaledCapsuleRadius());
+			SpawnCapsuleHalfHeight = FMath::Max(SpawnCapsuleHalfHeight, DefaultCharacter->GetCapsuleComponent()->GetScaledCapsuleHalfHeight());
 		}
 	}
+}
 
-	
-	if (BestStart == NULL)
+void AShooterGameMode::PrepareSpawnWave()
+{
+	if (SpawnWaveFrame == GFrameCounter && (PIESpawnPoint.IsValid() || SpawnPoints.Num() > 0))
 	{
-		if (PreferredSpawns.Num() > 0)
+		return;
+	}
+
+	// a stale PIE start isn't explicitly null, rebuild rather than fall back to the entries cached before it
+	const bool bTableValid = PIESpawnPoint.IsValid() || (PIESpawnPoint.IsExplicitlyNull() && SpawnPoints.Num() > 0 && !SpawnPoints.ContainsByPredicate([](const FSpawnPointEntry& Entry) { return !Entry.Start.IsValid(); }));
+	if (!bTableValid)
+	{
+		CacheSpawnPoints();
+	}
+
+	SpawnWaveFrame = GFrameCounter;
+	SpawnEnemyDistSq.Reset();
+
+	for (FSpawnPointEntry& Entry : SpawnPoints)
+	{
+		// without a pawn class to size the capsule no spawn is preferred
+		Entry.bOccupied = SpawnCapsuleRadius <= 0.0f || IsSpawnLocationOccupied(Entry.Location);
+		Entry.bClaimed = false;
+	}
+}
+
+bool AShooterGameMode::IsSpawnLocationOccupied(const FVector& SpawnLocation) const
+{
+	UShooterPawnSpatialIndex* PawnIndex = UShooterPawnSpatialIndex::Get(this);
+	if (PawnIndex == NULL)
+	{
+		return false;
+	}
+
+	// pawns share the player and bot capsule sizes, so the query sphere only has to reach the corner of the overlap test below
+	const float MaxCombinedRadius = SpawnCapsuleRadius * 2.0f;
+	const float MaxCombinedHeight = SpawnCapsuleHalfHeight * 4.0f;
+	FShooterPawnQueryResults NearbyPawns;
+	PawnIndex->FindPawnsInRadius(SpawnLocation, FMath::Sqrt(FMath::Square(MaxCombinedRadius) + FMath::Square(MaxCombinedHeight)), NearbyPawns);
+
+	for (const FShooterPawnQueryResult& Result : NearbyPawns)
+	{
+		const UCapsuleComponent* OtherCapsule = Result.Pawn->GetCapsuleComponent();
+		const float CombinedHeight = (SpawnCapsuleHalfHeight + OtherCapsule->GetScaledCapsuleHalfHeight()) * 2.0f;
+		const float CombinedRadius = SpawnCapsuleRadius + OtherCapsule->GetScaledCapsuleRadius();
+		const FVector OtherLocation = Result.Pawn->GetActorLocation();
+
+		// check if player start overlaps this pawn
+		if (FMath::Abs(SpawnLocation.Z - OtherLocation.Z) < CombinedHeight && (SpawnLocation - OtherLocation).Size2D() < CombinedRadius)
 		{
-			BestStart = PreferredSpawns[FMath::RandHelper(PreferredSpawns.Num())];
+			return true;
 		}
-		else if (FallbackSpawns.Num() > 0)
+	}
+
+	return false;
+}
+
+const TArray<float>& AShooterGameMode::GetSpawnEnemyDistSq(AController* Player)
+{
+	// everyone on a team shares enemies, and in free for all the spawning player has no pawn to exclude
+	AShooterPlayerState* PlayerState = Player ? Cast<AShooterPlayerState>(Player->PlayerState) : NULL;
+	const int32 TeamNum = PlayerState ? PlayerState->GetTeamNum() : INDEX_NONE;
+
+	TArray<float>* EnemyDistSq = SpawnEnemyDistSq.Find(TeamNum);
+	if (EnemyDistSq == NULL)
+	{
+		EnemyDistSq = &SpawnEnemyDistSq.Add(TeamNum);
+		EnemyDistSq->Init(MAX_FLT, SpawnPoints.Num());
+
+		UShooterPawnSpatialIndex* PawnIndex = UShooterPawnSpatialIndex::Get(this);
+		if (PawnIndex)
 		{
-			BestStart = FallbackSpawns[FMath::RandHelper(FallbackSpawns.Num())];
+			for (int32 i = 0; i < SpawnPoints.Num(); i++)
+			{
+				(*EnemyDistSq)[i] = PawnIndex->GetNearestEnemyDistSq(Player, SpawnPoints[i].Location);
+			}
 		}
 	}
 
-	return BestStart ? BestStart : Super::ChoosePlayerStart_Implementation(Player);
+	return *EnemyDistSq;
 }
 
 bool AShooterGameMode::IsSpawnpointAllowed(APlayerStart* SpawnPoint, AController* Player) const
@@ -454,38 +627,15 @@ bool AShooterGameMode::IsSpawnpointAllowed(APlayerStart* SpawnPoint, AController
 
 bool AShooterGameMode::IsSpawnpointPreferred(APlayerStart* SpawnPoint, AController* Player) const
 {
-	ACharacter* MyPawn = Cast<ACharacter>((*DefaultPawnClass)->GetDefaultObject<ACharacter>());	
-	AShooterAIController* AIController = Cast<AShooterAIController>(Player);
-	if( AIController != nullptr )
+	const int32* Index = SpawnPointIndices.Find(SpawnPoint);
+	if (Index && SpawnWaveFrame == GFrameCounter)
 	{
-		MyPawn = Cast<ACharacter>(BotPawnClass->GetDefaultObject<ACharacter>());
+		const FSpawnPointEntry& Entry = SpawnPoints[*Index];
+		return !Entry.bOccupied && !Entry.bClaimed;
 	}
-	
-	if (MyPawn)
-	{
-		const FVector SpawnLocation = SpawnPoint->GetActorLocation();
-		for (ACharacter* OtherPawn : TActorRange<ACharacter>(GetWorld()))
-		{
-			if (OtherPawn != MyPawn)
-			{
-				const float CombinedHeight = (MyPawn->GetCapsuleComponent()->GetScaledCapsuleHalfHeight() + OtherPawn->GetCapsuleComponent()->GetScaledCapsuleHalfHeight()) * 2.0f;
-				const float CombinedRadius = MyPawn->GetCapsuleComponent()->GetScaledCapsuleRadius() + OtherPawn->GetCapsuleComponent()->GetScaledCapsuleRadius();
-				const FVector OtherLocation = OtherPawn->GetActorLocation();
 
-				// check if player start overlaps this pawn
-				if (FMath::Abs(SpawnLocation.Z - OtherLocation.Z) < CombinedHeight && (SpawnLocation - OtherLocation).Size2D() < CombinedRadius)
-				{
-					return false;
-				}
-			}
-		}
-	}
-	else
-	{
-		return false;
-	}
-	
-	return true;
+	// not part of the current wave, test the occupancy grid directly
+	return SpawnCapsuleRadius > 0.0f && !IsSpawnLocationOccupied(SpawnPoint->GetActorLocation());
 }
 
 void AShooterGameMode::CreateBotControllers()
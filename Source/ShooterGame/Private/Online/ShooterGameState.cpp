@@ -11,6 +11,7 @@ AShooterGameState::AShooterGameState(const FObjectInitializer& ObjectInitializer
 	NumTeams = 0;
 	RemainingTime = 0;
 	bTimerPaused = false;
+	LeaderboardVersion = 0;
 
 	UShooterGameInstance* GameInstance = GetWorld() != nullptr ? Cast<UShooterGameInstance>(GetWorld()->GetGameInstance()) : nullptr;
 
@@ -27,34 +28,144 @@ void AShooterGameState::GetLifetimeReplicatedProps( TArray< FLifetimeProperty >
 	DOREPLIFETIME( AShooterGameState, TeamScores );
 }
 
+/** leaderboard key, matches the whole points shown on the scoreboard */
+static int32 GetLeaderboardScore(const TWeakObjectPtr<AShooterPlayerState>& PlayerState)
+{
+	return PlayerState.IsValid() ? FMath::TruncToInt(PlayerState->GetScore()) : MIN_int32;
+}
+
 void AShooterGameState::GetRankedMap(int32 TeamIndex, RankedPlayerMap& OutRankedMap) const
 {
-	OutRankedMap.Empty();
+	OutRankedMap.Reset();
 
-	//first, we need to go over all the PlayerStates, grab their score, and rank them
-	TMultiMap<int32, AShooterPlayerState*> SortedMap;
-	for(int32 i = 0; i < PlayerArray.Num(); ++i)
+	int32 Rank = 0;
+	for (const TWeakObjectPtr<AShooterPlayerState>& PlayerState : GetTeamLeaderboard(TeamIndex))
 	{
-		int32 Score = 0;
-		AShooterPlayerState* CurPlayerState = Cast<AShooterPlayerState>(PlayerArray[i]);
-		if (CurPlayerState && (CurPlayerState->GetTeamNum() == TeamIndex))
+		if (PlayerState.IsValid())
 		{
-			SortedMap.Add(FMath::TruncToInt(CurPlayerState->GetScore()), CurPlayerState);
+			OutRankedMap.Add(Rank++, PlayerState);
 		}
 	}
+}
 
-	//sort by the keys
-	SortedMap.KeySort(TGreater<int32>());
+const TeamLeaderboard& AShooterGameState::GetTeamLeaderboard(int32 TeamIndex) const
+{
+	static const TeamLeaderboard EmptyLeaderboard;
+	return TeamLeaderboards.IsValidIndex(TeamIndex) ? TeamLeaderboards[TeamIndex] : EmptyLeaderboard;
+}
 
-	//now, add them back to the ranked map
-	OutRankedMap.Empty();
+int32 AShooterGameState::GetLeaderboardRank(const AShooterPlayerState* PlayerState) const
+{
+	return PlayerState ? GetTeamLeaderboard(PlayerState->GetTeamNum()).IndexOfByKey(PlayerState) : INDEX_NONE;
+}
 
-	int32 Rank = 0;
-	for(TMultiMap<int32, AShooterPlayerState*>::TIterator It(SortedMap); It; ++It)
+void AShooterGameState::AddPlayerState(APlayerState* PlayerState)
+{
+	Super::AddPlayerState(PlayerState);
+
+	AShooterPlayerState* ShooterPlayerState = Cast<AShooterPlayerState>(PlayerState);
+	if (ShooterPlayerState && !PlayerState->IsInactive())
+	{
+		RemoveFromLeaderboard(ShooterPlayerState);
+		AddToLeaderboard(ShooterPlayerState);
+	}
+}
+
+void AShooterGameState::RemovePlayerState(APlayerState* PlayerState)
+{
+	RemoveFromLeaderboard(Cast<AShooterPlayerState>(PlayerState));
+
+	Super::RemovePlayerState(PlayerState);
+}
+
+void AShooterGameState::NotifyPlayerTeamChanged(AShooterPlayerState* PlayerState)
+{
+	// only players in PlayerArray are ranked
+	if (RemoveFromLeaderboard(PlayerState))
+	{
+		AddToLeaderboard(PlayerState);
+	}
+}
+
+void AShooterGameState::NotifyPlayerScoreChanged(AShooterPlayerState* PlayerState)
+{
+	if (PlayerState == NULL || !TeamLeaderboards.IsValidIndex(PlayerState->GetTeamNum()))
+	{
+		return;
+	}
+
+	TeamLeaderboard& Leaderboard = TeamLeaderboards[PlayerState->GetTeamNum()];
+	const int32 OldIndex = Leaderboard.IndexOfByKey(PlayerState);
+	if (OldIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	// a score change only moves one player, bubble it into place; ties keep their current order
+	const int32 Score = FMath::TruncToInt(PlayerState->GetScore());
+	int32 Index = OldIndex;
+	while (Index > 0 && GetLeaderboardScore(Leaderboard[Index - 1]) < Score)
+	{
+		Leaderboard.Swap(Index, Index - 1);
+		Index--;
+	}
+	while (Index < Leaderboard.Num() - 1 && GetLeaderboardScore(Leaderboard[Index + 1]) > Score)
+	{
+		Leaderboard.Swap(Index, Index + 1);
+		Index++;
+	}
+
+	if (Index != OldIndex)
+	{
+		LeaderboardVersion++;
+	}
+}
+
+void AShooterGameState::AddToLeaderboard(AShooterPlayerState* PlayerState)
+{
+	const int32 TeamIndex = PlayerState->GetTeamNum();
+	if (TeamIndex < 0)
+	{
+		return;
+	}
+
+	if (TeamIndex >= TeamLeaderboards.Num())
 	{
-		OutRankedMap.Add(Rank++, It.Value());
+		TeamLeaderboards.SetNum(TeamIndex + 1);
 	}
-	
+
+	// insert after everyone with the same or better score
+	TeamLeaderboard& Leaderboard = TeamLeaderboards[TeamIndex];
+	const int32 Score = FMath::TruncToInt(PlayerState->GetScore());
+	int32 Index = 0;
+	while (Index < Leaderboard.Num() && GetLeaderboardScore(Leaderboard[Index]) >= Score)
+	{
+		Index++;
+	}
+
+	Leaderboard.Insert(TWeakObjectPtr<AShooterPlayerState>(PlayerState), Index);
+	LeaderboardVersion++;
+}
+
+bool AShooterGameState::RemoveFromLeaderboard(const AShooterPlayerState* PlayerState)
+{
+	if (PlayerState == NULL)
+	{
+		return false;
+	}
+
+	for (TeamLeaderboard& Leaderboard : TeamLeaderboards)
+	{
+		const int32 Index = Leaderboard.IndexOfByKey(PlayerState);
+		if (Index != INDEX_NONE)
+		{
+			Leaderboard.RemoveAt(Index, 1, false);
+			LeaderboardVersion++;
+			return true;
+		}
+	}
+
+	return false;
 }
 
 
@@ -0,0 +1,165 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "ShooterRepGraphGridAnalysisCommandlet.h"
+#include "ShooterReplicationGraph.h"
+#include "Engine/LevelStreaming.h"
+#include "GameFramework/PlayerStart.h"
+
+UShooterRepGraphGridAnalysisCommandlet::UShooterRepGraphGridAnalysisCommandlet(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsServer = true;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UShooterRepGraphGridAnalysisCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamVals;
+	ParseCommandLine(*Params, Tokens, Switches, ParamVals);
+
+	const FString MapName = ParamVals.FindRef(TEXT("Map"));
+	if (MapName.IsEmpty())
+	{
+		UE_LOG(LogShooterReplicationGraph, Error, TEXT("Usage: -run=ShooterRepGraphGridAnalysis -Map=/Game/Maps/<Map> [-CellSize=<uu>] [-Csv=<Path>]"));
+		return 1;
+	}
+
+	UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (World == nullptr)
+	{
+		UE_LOG(LogShooterReplicationGraph, Error, TEXT("Failed to load map %s"), *MapName);
+		return 1;
+	}
+
+	// Sub levels aren't loaded with the map, pull them in so the analysis sees the whole world
+	TArray<ULevel*> Levels;
+	Levels.Add(World->PersistentLevel);
+	for (ULevelStreaming* StreamingLevel : World->GetStreamingLevels())
+	{
+		UPackage* LevelPackage = StreamingLevel ? LoadPackage(nullptr, *StreamingLevel->GetWorldAssetPackageName(), LOAD_None) : nullptr;
+		UWorld* LevelWorld = LevelPackage ? UWorld::FindWorldInPackage(LevelPackage) : nullptr;
+		if (LevelWorld && LevelWorld->PersistentLevel)
+		{
+			Levels.Add(LevelWorld->PersistentLevel);
+		}
+	}
+
+	const float CullDistance = UShooterReplicationGraph::GetPawnCullDistance();
+	FShooterRepGraphGridSettings Settings = UShooterReplicationGraph::ComputeGridSettings(Levels, CullDistance);
+
+	if (ParamVals.Contains(TEXT("CellSize")))
+	{
+		Settings.CellSize = FMath::Max(100.f, FCString::Atof(*ParamVals.FindRef(TEXT("CellSize"))));
+	}
+
+	auto GetCell = [&Settings](float X, float Y)
+	{
+		return FIntPoint(
+			FMath::Max(0, FMath::FloorToInt((X - Settings.SpatialBias.X) / Settings.CellSize)),
+			FMath::Max(0, FMath::FloorToInt((Y - Settings.SpatialBias.Y) / Settings.CellSize)));
+	};
+
+	// Like GridNode, an actor goes into every cell its cull distance reaches
+	TMap<FIntPoint, int32> CellCounts;
+	int32 NumActors = 0;
+
+	auto AddToCells = [&](const FVector& Location, float ActorCullDistance)
+	{
+		const FIntPoint MinCell = GetCell(Location.X - ActorCullDistance, Location.Y - ActorCullDistance);
+		const FIntPoint MaxCell = GetCell(Location.X + ActorCullDistance, Location.Y + ActorCullDistance);
+		for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+			{
+				CellCounts.FindOrAdd(FIntPoint(X, Y))++;
+			}
+		}
+		NumActors++;
+	};
+
+	for (ULevel* Level : Levels)
+	{
+		for (AActor* Actor : Level->Actors)
+		{
+			if (Actor == nullptr)
+			{
+				continue;
+			}
+
+			if (Actor->IsA<APlayerStart>())
+			{
+				// Stand-in for the pawn that spawns there
+				AddToCells(Actor->GetActorLocation(), CullDistance);
+			}
+			else if (Actor->GetIsReplicated() && !(Actor->bAlwaysRelevant || Actor->bOnlyRelevantToOwner || Actor->bNetUseOwnerRelevancy))
+			{
+				AddToCells(Actor->GetActorLocation(), FMath::Sqrt(Actor->NetCullDistanceSquared));
+			}
+		}
+	}
+
+	// Every cell of the play area counts, empty ones included
+	const FIntPoint PlayMinCell = GetCell(Settings.PlayBounds.Min.X, Settings.PlayBounds.Min.Y);
+	const FIntPoint PlayMaxCell = GetCell(Settings.PlayBounds.Max.X, Settings.PlayBounds.Max.Y);
+
+	static const int32 BucketLimits[] = { 0, 2, 4, 8, 16, 32, 64, 128, MAX_int32 };
+	int32 BucketCounts[UE_ARRAY_COUNT(BucketLimits)] = { 0 };
+	int32 NumCells = 0;
+	int32 MaxPerCell = 0;
+	int64 TotalPerCell = 0;
+
+	TArray<FString> CsvLines;
+	CsvLines.Add(TEXT("CellX,CellY,Actors"));
+
+	for (int32 X = PlayMinCell.X; X <= PlayMaxCell.X; X++)
+	{
+		for (int32 Y = PlayMinCell.Y; Y <= PlayMaxCell.Y; Y++)
+		{
+			const int32 Count = CellCounts.FindRef(FIntPoint(X, Y));
+
+			int32 BucketIdx = 0;
+			while (Count > BucketLimits[BucketIdx])
+			{
+				BucketIdx++;
+			}
+			BucketCounts[BucketIdx]++;
+
+			NumCells++;
+			MaxPerCell = FMath::Max(MaxPerCell, Count);
+			TotalPerCell += Count;
+
+			CsvLines.Add(FString::Printf(TEXT("%d,%d,%d"), X, Y, Count));
+		}
+	}
+
+	const FVector PlaySize = Settings.PlayBounds.GetSize();
+	UE_LOG(LogShooterReplicationGraph, Display, TEXT("Grid analysis for %s"), *MapName);
+	UE_LOG(LogShooterReplicationGraph, Display, TEXT("  CellSize %.0f, SpatialBias (%.0f, %.0f), pawn cull distance %.0f"), Settings.CellSize, Settings.SpatialBias.X, Settings.SpatialBias.Y, CullDistance);
+	UE_LOG(LogShooterReplicationGraph, Display, TEXT("  Play area %.0f x %.0f, %d player starts, %d pickups, %d spatialized actors"), PlaySize.X, PlaySize.Y, Settings.NumPlayerStarts, Settings.NumPickups, NumActors);
+	UE_LOG(LogShooterReplicationGraph, Display, TEXT("  %d cells, %.1f actors per cell on average, %d at most"), NumCells, NumCells > 0 ? (float)TotalPerCell / NumCells : 0.f, MaxPerCell);
+	UE_LOG(LogShooterReplicationGraph, Display, TEXT("  Actors per cell:"));
+
+	for (int32 BucketIdx = 0; BucketIdx < UE_ARRAY_COUNT(BucketLimits); BucketIdx++)
+	{
+		const FString Range = BucketIdx == 0 ? TEXT("0")
+			: BucketLimits[BucketIdx] == MAX_int32 ? FString::Printf(TEXT("%d+"), BucketLimits[BucketIdx - 1] + 1)
+			: FString::Printf(TEXT("%d-%d"), BucketLimits[BucketIdx - 1] + 1, BucketLimits[BucketIdx]);
+
+		const int32 BarLength = NumCells > 0 ? FMath::CeilToInt(50.f * BucketCounts[BucketIdx] / NumCells) : 0;
+		UE_LOG(LogShooterReplicationGraph, Display, TEXT("  %8s %6d %s"), *Range, BucketCounts[BucketIdx], *FString::ChrN(BarLength, TEXT('#')));
+	}
+
+	const FString CsvFilename = ParamVals.FindRef(TEXT("Csv"));
+	if (!CsvFilename.IsEmpty() && !FFileHelper::SaveStringArrayToFile(CsvLines, *CsvFilename))
+	{
+		UE_LOG(LogShooterReplicationGraph, Error, TEXT("Failed to write %s"), *CsvFilename);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,25 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ShooterRepGraphGridAnalysisCommandlet.generated.h"
+
+/**
+ * Reports how a map would be laid out in the replication graph's GridNode, without running it.
+ *
+ *   UE4Editor-Cmd ShooterGame -run=ShooterRepGraphGridAnalysis -Map=/Game/Maps/Highrise [-CellSize=10000] [-Csv=Path]
+ *
+ * Prints the auto tuned cell size and bias (or uses -CellSize) and a histogram of how many spatialized actors each cell would
+ * hold, counting replicated actors placed in the level with their cull distance and a pawn at every player start.
+ */
+UCLASS()
+class UShooterRepGraphGridAnalysisCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+
+	virtual int32 Main(const FString& Params) override;
+};
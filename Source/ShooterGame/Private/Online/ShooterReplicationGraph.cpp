@@ -33,12 +33,20 @@
 *		UShooterReplicationGraphNode_AlwaysRelevant_ForConnection
 *		This is the node for connection specific always relevant actors. This node does not maintain a persistent list but builds it each frame. This is possible because (currently)
 *		these actors are all easily accessed from the PlayerController. A persistent list would require notifications to be broadcast when these actors change, which would be possible
-*		but currently not necessary.
+*		but currently not necessary. It also returns the always relevant actors of the streaming levels visible on the client. Whether a level has any non dormant actors is counted
+*		by the graph from dormancy events, so a connection only looks at individual actors while a fully dormant level is settling on it.
+*		
+*		UShooterReplicationGraphNode_AimPriority_ForConnection
+*		Connection specific node that doesn't gather anything. It classifies the pawns around the viewer (from the pawn spatial index) by view direction every few frames and
+*		sets their per connection replication period from the band. The period is the only per connection knob the default prioritizer offers, so while the node is enabled
+*		the pawn class period is raised (AimPriority.PawnPeriod) to leave room below it: pawns in view and in the aim cone are promoted towards every frame, pawns far
+*		behind the viewer are demoted. Under saturation the connection's bandwidth goes to what the player is looking at. See ShooterRepGraph.AimPriority.Show.
 *		
 *		UShooterReplicationGraphNode_PlayerStateFrequencyLimiter
-*		A custom node for handling player state replication. This replicates a small rolling set of player states (currently 2/frame). This is so player states replicate
+*		A custom node for handling player state replication. This replicates a small rolling set of player states per frame. This is so player states replicate
 *		to simulated connections at a low, steady frequency, and to take advantage of serialization sharing. Auto proxy player states are replicated at higher frequency (to the
-*		owning connection only) via UShooterReplicationGraphNode_AlwaysRelevant_ForConnection.
+*		owning connection only) via UShooterReplicationGraphNode_AlwaysRelevant_ForConnection. The rolling buckets are persistent: player states are routed here like any
+*		other actor and the buckets are compacted as players leave. The bucket size adapts to the player count and to how many connections are out of bandwidth.
 *		
 *		UReplicationGraphNode_TearOff_ForConnection
 *		Connection specific node for handling tear off actors. This is created and managed in the base implementation of Replication Graph.
@@ -73,6 +81,11 @@
 *		Net.RepGraph.PrintAllActorInfo <ActorMatchString> - will print the class, global, and connection replication info associated with an actor/class. If MatchString is empty will print everything. Call directly from client.
 *		
 *		ShooterRepGraph.PrintRouting - will print the EClassRepNodeMapping for each class. That is, how a given actor class is routed (or not) in the Replication Graph.
+*		
+*		ShooterRepGraph.AimPriority.Show <ConnectionIdx> <Seconds> - will log and draw how pawns are banded by UShooterReplicationGraphNode_AimPriority_ForConnection for a connection (all if omitted).
+*		
+*		To measure how the graph scales, run a dedicated server with -gauntlet=ShooterTestControllerRepGraphBenchmark (see UShooterTestControllerRepGraphBenchmark). It replicates to
+*		simulated connections and writes per node gather times to a CSV.
 *	
 */
 
@@ -96,7 +109,11 @@
 #include "Player/ShooterCharacter.h"
 #include "Online/ShooterPlayerState.h"
 #include "Weapons/ShooterWeapon.h"
+#include "Weapons/ShooterProjectile.h"
 #include "Pickups/ShooterPickup.h"
+#include "Player/ShooterPawnSpatialIndex.h"
+#include "GameFramework/PlayerStart.h"
+#include "Engine/LevelBounds.h"
 
 DEFINE_LOG_CATEGORY( LogShooterReplicationGraph );
 
@@ -121,9 +138,92 @@ static FAutoConsoleVariableRef CVarShooterRepSpatialBiasY(TEXT("ShooterRepGraph.
 int32 CVar_ShooterRepGraph_DynamicActorFrequencyBuckets = 3;
 static FAutoConsoleVariableRef CVarShooterRepDynamicActorFrequencyBuckets(TEXT("ShooterRepGraph.DynamicActorFrequencyBuckets"), CVar_ShooterRepGraph_DynamicActorFrequencyBuckets, TEXT(""), ECVF_Default );
 
+// If nonzero, CellSize and SpatialBias above are ignored and computed per map, see UShooterReplicationGraph::ComputeGridSettings.
+int32 CVar_ShooterRepGraph_AutoTuneGrid = 1;
+static FAutoConsoleVariableRef CVarShooterRepGraphAutoTuneGrid(TEXT("ShooterRepGraph.AutoTuneGrid"), CVar_ShooterRepGraph_AutoTuneGrid, TEXT("Compute grid cell size and spatial bias from the map when it starts."), ECVF_Default );
+
+// Gameplay points (player starts, pickups) the auto tuned grid aims for per cell. Denser maps get smaller cells, down to half the pawn cull distance.
+float CVar_ShooterRepGraph_AutoTuneGridPointsPerCell = 8.f;
+static FAutoConsoleVariableRef CVarShooterRepGraphAutoTuneGridPointsPerCell(TEXT("ShooterRepGraph.AutoTuneGrid.PointsPerCell"), CVar_ShooterRepGraph_AutoTuneGridPointsPerCell, TEXT(""), ECVF_Default );
+
 int32 CVar_ShooterRepGraph_DisableSpatialRebuilds = 1;
 static FAutoConsoleVariableRef CVarShooterRepDisableSpatialRebuilds(TEXT("ShooterRepGraph.DisableSpatialRebuilds"), CVar_ShooterRepGraph_DisableSpatialRebuilds, TEXT(""), ECVF_Default );
 
+// Every player state should be gathered at least once in this many frames. Together with the player count this sets how many player states go out per frame.
+int32 CVar_ShooterRepGraph_PlayerStateCycleFrames = 30;
+static FAutoConsoleVariableRef CVarShooterRepPlayerStateCycleFrames(TEXT("ShooterRepGraph.PlayerState.CycleFrames"), CVar_ShooterRepGraph_PlayerStateCycleFrames, TEXT("Target number of frames for a full pass over all player states."), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_PlayerStateMinPerFrame = 2;
+static FAutoConsoleVariableRef CVarShooterRepPlayerStateMinPerFrame(TEXT("ShooterRepGraph.PlayerState.MinPerFrame"), CVar_ShooterRepGraph_PlayerStateMinPerFrame, TEXT("Min player states gathered per frame."), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_PlayerStateMaxPerFrame = 8;
+static FAutoConsoleVariableRef CVarShooterRepPlayerStateMaxPerFrame(TEXT("ShooterRepGraph.PlayerState.MaxPerFrame"), CVar_ShooterRepGraph_PlayerStateMaxPerFrame, TEXT("Max player states gathered per frame."), ECVF_Default );
+
+// When more than this fraction of connections is saturated, player states back off to MinPerFrame so they don't compete with gameplay actors.
+float CVar_ShooterRepGraph_PlayerStateSaturatedRatio = 0.25f;
+static FAutoConsoleVariableRef CVarShooterRepPlayerStateSaturatedRatio(TEXT("ShooterRepGraph.PlayerState.SaturatedRatio"), CVar_ShooterRepGraph_PlayerStateSaturatedRatio, TEXT("Fraction of saturated connections at which player state replication backs off."), ECVF_Default );
+
+// How often, in frames, the player states per frame are re-evaluated.
+int32 CVar_ShooterRepGraph_PlayerStateUpdateInterval = 30;
+static FAutoConsoleVariableRef CVarShooterRepPlayerStateUpdateInterval(TEXT("ShooterRepGraph.PlayerState.UpdateInterval"), CVar_ShooterRepGraph_PlayerStateUpdateInterval, TEXT(""), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_AimPriority_Enable = 1;
+static FAutoConsoleVariableRef CVarShooterRepAimPriorityEnable(TEXT("ShooterRepGraph.AimPriority.Enable"), CVar_ShooterRepGraph_AimPriority_Enable, TEXT("Steer pawn replication per connection by the viewer's aim."), ECVF_Default );
+
+// Pawns further than this are left alone. Matches the pawn cull distance.
+float CVar_ShooterRepGraph_AimPriority_Radius = 15000.f;
+static FAutoConsoleVariableRef CVarShooterRepAimPriorityRadius(TEXT("ShooterRepGraph.AimPriority.Radius"), CVar_ShooterRepGraph_AimPriority_Radius, TEXT(""), ECVF_Default );
+
+float CVar_ShooterRepGraph_AimPriority_AimConeAngle = 10.f;
+static FAutoConsoleVariableRef CVarShooterRepAimPriorityAimConeAngle(TEXT("ShooterRepGraph.AimPriority.AimConeAngle"), CVar_ShooterRepGraph_AimPriority_AimConeAngle, TEXT("Half angle of the aim cone, in degrees."), ECVF_Default );
+
+float CVar_ShooterRepGraph_AimPriority_ViewAngle = 55.f;
+static FAutoConsoleVariableRef CVarShooterRepAimPriorityViewAngle(TEXT("ShooterRepGraph.AimPriority.ViewAngle"), CVar_ShooterRepGraph_AimPriority_ViewAngle, TEXT("Half angle treated as inside the view frustum, in degrees."), ECVF_Default );
+
+float CVar_ShooterRepGraph_AimPriority_BehindAngle = 110.f;
+static FAutoConsoleVariableRef CVarShooterRepAimPriorityBehindAngle(TEXT("ShooterRepGraph.AimPriority.BehindAngle"), CVar_ShooterRepGraph_AimPriority_BehindAngle, TEXT("Pawns further than this angle from the view direction are behind the viewer, in degrees."), ECVF_Default );
+
+// Pawns this close are never demoted, they can still shoot the viewer in the back.
+float CVar_ShooterRepGraph_AimPriority_MinDemoteDistance = 2000.f;
+static FAutoConsoleVariableRef CVarShooterRepAimPriorityMinDemoteDistance(TEXT("ShooterRepGraph.AimPriority.MinDemoteDistance"), CVar_ShooterRepGraph_AimPriority_MinDemoteDistance, TEXT(""), ECVF_Default );
+
+// Pawns already replicate every frame by default, so the bands could only demote. The class period is raised to this when the graph is set up with aim priority enabled.
+int32 CVar_ShooterRepGraph_AimPriority_PawnPeriod = 3;
+static FAutoConsoleVariableRef CVarShooterRepAimPriorityPawnPeriod(TEXT("ShooterRepGraph.AimPriority.PawnPeriod"), CVar_ShooterRepGraph_AimPriority_PawnPeriod, TEXT("Replication period, in frames, of pawns outside the view. Read when the graph is initialized."), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_AimPriority_InViewPeriod = 2;
+static FAutoConsoleVariableRef CVarShooterRepAimPriorityInViewPeriod(TEXT("ShooterRepGraph.AimPriority.InViewPeriod"), CVar_ShooterRepGraph_AimPriority_InViewPeriod, TEXT("Replication period, in frames, of pawns in the view. Pawns in the aim cone replicate every frame."), ECVF_Default );
+
+int32 CVar_ShooterRepGraph_AimPriority_BehindPeriod = 6;
+static FAutoConsoleVariableRef CVarShooterRepAimPriorityBehindPeriod(TEXT("ShooterRepGraph.AimPriority.BehindPeriod"), CVar_ShooterRepGraph_AimPriority_BehindPeriod, TEXT("Replication period, in frames, of pawns behind the viewer."), ECVF_Default );
+
+// Connections are staggered across these frames so only a fraction of them update per frame.
+int32 CVar_ShooterRepGraph_AimPriority_UpdateInterval = 3;
+static FAutoConsoleVariableRef CVarShooterRepAimPriorityUpdateInterval(TEXT("ShooterRepGraph.AimPriority.UpdateInterval"), CVar_ShooterRepGraph_AimPriority_UpdateInterval, TEXT(""), ECVF_Default );
+
+/** Times a node's gather for UShooterReplicationGraph::SetGatherProfiling */
+struct FShooterRepGraphGatherScope
+{
+	FShooterRepGraphGatherScope(const UReplicationGraphNode* InNode)
+		: Node(InNode)
+		, Graph(Cast<UShooterReplicationGraph>(InNode->GetOuter()))
+		, StartTime(Graph && Graph->IsProfilingGather() ? FPlatformTime::Seconds() : 0.0)
+	{
+	}
+
+	~FShooterRepGraphGatherScope()
+	{
+		if (StartTime > 0.0)
+		{
+			Graph->RecordNodeGather(Node, FPlatformTime::Seconds() - StartTime);
+		}
+	}
+
+	const UReplicationGraphNode* Node;
+	UShooterReplicationGraph* Graph;
+	double StartTime;
+};
+
 // ----------------------------------------------------------------------------------------------------------
 
 
@@ -155,6 +255,9 @@ void UShooterReplicationGraph::ResetGameWorldState()
 {
 	Super::ResetGameWorldState();
 
+	// GridNode was emptied by the reset, the next world may be laid out differently
+	bGridNeedsTuning = true;
+
 	AlwaysRelevantStreamingLevelActors.Empty();
 
 	for (UNetReplicationGraphConnection* ConnManager : Connections)
@@ -192,10 +295,12 @@ void UShooterReplicationGraph::InitGlobalActorClassSettings()
 
 	AddInfo( AShooterWeapon::StaticClass(),							EClassRepNodeMapping::NotRouted);				// Handled via DependantActor replication (Pawn)
 	AddInfo( ALevelScriptActor::StaticClass(),						EClassRepNodeMapping::NotRouted);				// Not needed
-	AddInfo( APlayerState::StaticClass(),							EClassRepNodeMapping::NotRouted);				// Special cased via UShooterReplicationGraphNode_PlayerStateFrequencyLimiter
+	AddInfo( APlayerState::StaticClass(),							EClassRepNodeMapping::PlayerStateFrequencyLimited);	// Routes to UShooterReplicationGraphNode_PlayerStateFrequencyLimiter
 	AddInfo( AReplicationGraphDebugActor::StaticClass(),			EClassRepNodeMapping::NotRouted);				// Not needed. Replicated special case inside RepGraph
 	AddInfo( AInfo::StaticClass(),									EClassRepNodeMapping::RelevantAllConnections);	// Non spatialized, relevant to all
 	AddInfo( AShooterPickup::StaticClass(),							EClassRepNodeMapping::Spatialize_Static);		// Spatialized and never moves. Routes to GridNode.
+	AddInfo( AShooterProjectile::StaticClass(),						EClassRepNodeMapping::Spatialize_Dormancy);		// Pooled, dormant while waiting for reuse. Routes to GridNode.
+	AddInfo( AShooterCharacter::StaticClass(),						EClassRepNodeMapping::Spatialize_Dormancy);		// Pooled, dormant while waiting for respawn. Routes to GridNode.
 
 #if WITH_GAMEPLAY_DEBUGGER
 	AddInfo( AGameplayDebuggerCategoryReplicator::StaticClass(),	EClassRepNodeMapping::NotRouted);				// Replicated via UShooterReplicationGraphNode_AlwaysRelevant_ForConnection
@@ -281,7 +386,12 @@ void UShooterReplicationGraph::InitGlobalActorClassSettings()
 	PawnClassRepInfo.DistancePriorityScale = 1.f;
 	PawnClassRepInfo.StarvationPriorityScale = 1.f;
 	PawnClassRepInfo.ActorChannelFrameTimeout = 4;
-	PawnClassRepInfo.SetCullDistanceSquared(15000.f * 15000.f); // Yuck
+	if (CVar_ShooterRepGraph_AimPriority_Enable)
+	{
+		// the aim priority node promotes pawns below this per connection
+		PawnClassRepInfo.ReplicationPeriodFrame = FMath::Clamp(CVar_ShooterRepGraph_AimPriority_PawnPeriod, 1, (int32)MAX_uint16);
+	}
+	PawnClassRepInfo.SetCullDistanceSquared(FMath::Square(GetPawnCullDistance())); // shared with the grid tuning, see TuneGridNode
 	SetClassInfo( APawn::StaticClass(), PawnClassRepInfo );
 
 	FClassReplicationInfo PlayerStateRepInfo;
@@ -362,9 +472,10 @@ void UShooterReplicationGraph::InitGlobalGraphNodes()
 	//	Spatial Actors
 	// -----------------------------------------------
 
-	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode = CreateNewNode<UShooterReplicationGraphNode_GridSpatialization2D>();
 	GridNode->CellSize = CVar_ShooterRepGraph_CellSize;
 	GridNode->SpatialBias = FVector2D(CVar_ShooterRepGraph_SpatialBiasX, CVar_ShooterRepGraph_SpatialBiasY);
+	bGridNeedsTuning = true;
 
 	if (CVar_ShooterRepGraph_DisableSpatialRebuilds)
 	{
@@ -382,10 +493,105 @@ void UShooterReplicationGraph::InitGlobalGraphNodes()
 	// -----------------------------------------------
 	//	Player State specialization. This will return a rolling subset of the player states to replicate
 	// -----------------------------------------------
-	UShooterReplicationGraphNode_PlayerStateFrequencyLimiter* PlayerStateNode = CreateNewNode<UShooterReplicationGraphNode_PlayerStateFrequencyLimiter>();
+	PlayerStateNode = CreateNewNode<UShooterReplicationGraphNode_PlayerStateFrequencyLimiter>();
 	AddGlobalGraphNode(PlayerStateNode);
 }
 
+float UShooterReplicationGraph::GetPawnCullDistance()
+{
+	return 15000.f;
+}
+
+FShooterRepGraphGridSettings UShooterReplicationGraph::ComputeGridSettings(const TArray<ULevel*>& Levels, float CullDistance)
+{
+	FShooterRepGraphGridSettings Settings;
+	FBox LevelBounds(ForceInit);
+
+	for (ULevel* Level : Levels)
+	{
+		if (Level == nullptr)
+		{
+			continue;
+		}
+
+		LevelBounds += ALevelBounds::CalculateLevelBounds(Level);
+
+		for (AActor* Actor : Level->Actors)
+		{
+			if (Actor == nullptr)
+			{
+				continue;
+			}
+
+			// Players spawn at the starts and move between the pickups, together they outline the playable area
+			if (Actor->IsA<APlayerStart>())
+			{
+				Settings.PlayBounds += Actor->GetActorLocation();
+				Settings.NumPlayerStarts++;
+			}
+			else if (Actor->IsA<AShooterPickup>())
+			{
+				Settings.PlayBounds += Actor->GetActorLocation();
+				Settings.NumPickups++;
+			}
+		}
+	}
+
+	if (!Settings.PlayBounds.IsValid)
+	{
+		Settings.PlayBounds = LevelBounds.IsValid ? LevelBounds : FBox(FVector(-CullDistance), FVector(CullDistance));
+	}
+
+	const FVector PlaySize = Settings.PlayBounds.GetSize();
+	const float PlayExtent = FMath::Max(PlaySize.X, PlaySize.Y);
+
+	if (PlayExtent <= CullDistance)
+	{
+		// Everything is in range of everything anyway, keep the grid to a handful of cells so moving actors touch as few as possible
+		Settings.CellSize = CullDistance;
+	}
+	else
+	{
+		// Smaller cells gather fewer actors per connection but put every moving actor in more cells. Only dense maps are worth going below the cull distance.
+		const float PlayArea = FMath::Max(PlaySize.X, 1.f) * FMath::Max(PlaySize.Y, 1.f);
+		const float PointsPerCullArea = (Settings.NumPlayerStarts + Settings.NumPickups) * FMath::Square(CullDistance) / PlayArea;
+		const float CellFraction = PointsPerCullArea > 0.f ? FMath::Sqrt(CVar_ShooterRepGraph_AutoTuneGridPointsPerCell / PointsPerCullArea) : 1.f;
+		Settings.CellSize = CullDistance * FMath::Clamp(CellFraction, 0.5f, 1.f);
+	}
+
+	// Actors never go below the bias. Leave room for a cull distance around the playable area, but don't let a huge sky box push it further than needed.
+	const FVector2D PlayMin(Settings.PlayBounds.Min.X - CullDistance, Settings.PlayBounds.Min.Y - CullDistance);
+	const FVector2D LevelMin = LevelBounds.IsValid ? FVector2D(LevelBounds.Min.X, LevelBounds.Min.Y) : PlayMin;
+	const float MaxExtraMargin = 4.f * CullDistance;
+	Settings.SpatialBias.X = FMath::Max(FMath::Min(PlayMin.X, LevelMin.X), PlayMin.X - MaxExtraMargin);
+	Settings.SpatialBias.Y = FMath::Max(FMath::Min(PlayMin.Y, LevelMin.Y), PlayMin.Y - MaxExtraMargin);
+
+	return Settings;
+}
+
+void UShooterReplicationGraph::TuneGridNode()
+{
+	bGridNeedsTuning = false;
+
+	UWorld* World = GetWorld();
+	if (CVar_ShooterRepGraph_AutoTuneGrid == 0 || World == nullptr)
+	{
+		GridNode->CellSize = CVar_ShooterRepGraph_CellSize;
+		GridNode->SpatialBias = FVector2D(CVar_ShooterRepGraph_SpatialBiasX, CVar_ShooterRepGraph_SpatialBiasY);
+		return;
+	}
+
+	const float CullDistance = GetPawnCullDistance();
+	const FShooterRepGraphGridSettings Settings = ComputeGridSettings(World->GetLevels(), CullDistance);
+
+	GridNode->CellSize = Settings.CellSize;
+	GridNode->SpatialBias = Settings.SpatialBias;
+
+	const FVector PlaySize = Settings.PlayBounds.GetSize();
+	UE_LOG(LogShooterReplicationGraph, Display, TEXT("Grid for %s: CellSize %.0f, SpatialBias (%.0f, %.0f). Play area %.0f x %.0f, %d player starts, %d pickups, pawn cull distance %.0f"),
+		*World->GetMapName(), Settings.CellSize, Settings.SpatialBias.X, Settings.SpatialBias.Y, PlaySize.X, PlaySize.Y, Settings.NumPlayerStarts, Settings.NumPickups, CullDistance);
+}
+
 void UShooterReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
 {
 	Super::InitConnectionGraphNodes(RepGraphConnection);
@@ -397,6 +603,9 @@ void UShooterReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConn
 	RepGraphConnection->OnClientVisibleLevelNameRemove.AddUObject(AlwaysRelevantConnectionNode, &UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::OnClientLevelVisibilityRemove);
 
 	AddConnectionGraphNode(AlwaysRelevantConnectionNode, RepGraphConnection);
+
+	UShooterReplicationGraphNode_AimPriority_ForConnection* AimPriorityNode = CreateNewNode<UShooterReplicationGraphNode_AimPriority_ForConnection>();
+	AddConnectionGraphNode(AimPriorityNode, RepGraphConnection);
 }
 
 EClassRepNodeMapping UShooterReplicationGraph::GetMappingPolicy(UClass* Class)
@@ -409,6 +618,13 @@ EClassRepNodeMapping UShooterReplicationGraph::GetMappingPolicy(UClass* Class)
 void UShooterReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
 {
 	EClassRepNodeMapping Policy = GetMappingPolicy(ActorInfo.Class);
+
+	// The level's actors are being added, so the world is loaded by now
+	if (bGridNeedsTuning && IsSpatialized(Policy))
+	{
+		TuneGridNode();
+	}
+
 	switch(Policy)
 	{
 		case EClassRepNodeMapping::NotRouted:
@@ -424,12 +640,31 @@ void UShooterReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedA
 			}
 			else
 			{
-				FActorRepListRefView& RepList = AlwaysRelevantStreamingLevelActors.FindOrAdd(ActorInfo.StreamingLevelName);
-				RepList.ConditionalAdd(ActorInfo.Actor);
+				FShooterAlwaysRelevantStreamingLevel& Level = AlwaysRelevantStreamingLevelActors.FindOrAdd(ActorInfo.StreamingLevelName);
+				if (Level.Actors.Contains(ActorInfo.Actor) == false)
+				{
+					Level.Actors.Add(ActorInfo.Actor);
+					if (ActorInfo.Actor->NetDormancy <= DORM_Awake)
+					{
+						Level.NumAwake++;
+					}
+
+					// Even a dormant actor has to reach every client once
+					Level.DormancyEpoch++;
+
+					GlobalInfo.Events.DormancyChange.AddUObject(this, &UShooterReplicationGraph::OnAlwaysRelevantStreamingActorDormancyChange, ActorInfo.StreamingLevelName);
+					GlobalInfo.Events.DormancyFlush.AddUObject(this, &UShooterReplicationGraph::OnAlwaysRelevantStreamingActorDormancyFlush, ActorInfo.StreamingLevelName);
+				}
 			}
 			break;
 		}
 
+		case EClassRepNodeMapping::PlayerStateFrequencyLimited:
+		{
+			PlayerStateNode->NotifyAddNetworkActor(ActorInfo);
+			break;
+		}
+
 		case EClassRepNodeMapping::Spatialize_Static:
 		{
 			GridNode->AddActor_Static(ActorInfo, GlobalInfo);
@@ -468,15 +703,34 @@ void UShooterReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicat
 			}
 			else
 			{
-				FActorRepListRefView& RepList = AlwaysRelevantStreamingLevelActors.FindChecked(ActorInfo.StreamingLevelName);
-				if (RepList.RemoveFast(ActorInfo.Actor) == false)
+				FShooterAlwaysRelevantStreamingLevel& Level = AlwaysRelevantStreamingLevelActors.FindChecked(ActorInfo.StreamingLevelName);
+				if (Level.Actors.RemoveFast(ActorInfo.Actor) == false)
 				{
 					UE_LOG(LogShooterReplicationGraph, Warning, TEXT("Actor %s was not found in AlwaysRelevantStreamingLevelActors list. LevelName: %s"), *GetActorRepListTypeDebugString(ActorInfo.Actor), *ActorInfo.StreamingLevelName.ToString());
-				}				
+				}
+				else
+				{
+					if (ActorInfo.Actor->NetDormancy <= DORM_Awake)
+					{
+						Level.NumAwake = FMath::Max(0, Level.NumAwake - 1);
+					}
+
+					if (FGlobalActorReplicationInfo* GlobalInfo = GlobalActorReplicationInfoMap.Find(ActorInfo.Actor))
+					{
+						GlobalInfo->Events.DormancyChange.RemoveAll(this);
+						GlobalInfo->Events.DormancyFlush.RemoveAll(this);
+					}
+				}
 			}
 			break;
 		}
 
+		case EClassRepNodeMapping::PlayerStateFrequencyLimited:
+		{
+			PlayerStateNode->NotifyRemoveNetworkActor(ActorInfo);
+			break;
+		}
+
 		case EClassRepNodeMapping::Spatialize_Static:
 		{
 			GridNode->RemoveActor_Static(ActorInfo);
@@ -497,6 +751,67 @@ void UShooterReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicat
 	};
 }
 
+int32 UShooterReplicationGraph::ServerReplicateActors(float DeltaSeconds)
+{
+	if (bProfileGather)
+	{
+		GatherProfile.NodeGatherSeconds.Reset();
+		GatherProfile.NumConnections = 0;
+		GatherProfile.NumActorsGathered = 0;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 Result = Super::ServerReplicateActors(DeltaSeconds);
+	LastReplicateActorsSeconds = FPlatformTime::Seconds() - StartTime;
+	return Result;
+}
+
+void UShooterReplicationGraph::RecordNodeGather(const UReplicationGraphNode* Node, double Seconds)
+{
+	GatherProfile.NodeGatherSeconds.FindOrAdd(Node->GetClass()->GetFName()) += Seconds;
+}
+
+void UShooterReplicationGraph::RecordConnectionGathered(const FConnectionGatherActorListParameters& Params)
+{
+	for (int32 ListIdx = 0; ListIdx < Params.OutGatheredReplicationLists.NumLists(EActorRepListTypeFlags::Default); ++ListIdx)
+	{
+		GatherProfile.NumActorsGathered += Params.OutGatheredReplicationLists.GetList(EActorRepListTypeFlags::Default, ListIdx).Num();
+	}
+
+	GatherProfile.NumConnections++;
+}
+
+void UShooterReplicationGraph::OnAlwaysRelevantStreamingActorDormancyChange(FActorRepListType Actor, FGlobalActorReplicationInfo& GlobalInfo, ENetDormancy NewValue, ENetDormancy OldValue, FName StreamingLevelName)
+{
+	FShooterAlwaysRelevantStreamingLevel* Level = AlwaysRelevantStreamingLevelActors.Find(StreamingLevelName);
+	if (Level == nullptr)
+	{
+		return;
+	}
+
+	const bool bWasAwake = OldValue <= DORM_Awake;
+	const bool bIsAwake = NewValue <= DORM_Awake;
+
+	if (bIsAwake && !bWasAwake)
+	{
+		Level->NumAwake++;
+		Level->DormancyEpoch++;
+	}
+	else if (!bIsAwake && bWasAwake)
+	{
+		Level->NumAwake = FMath::Max(0, Level->NumAwake - 1);
+	}
+}
+
+void UShooterReplicationGraph::OnAlwaysRelevantStreamingActorDormancyFlush(FActorRepListType Actor, FGlobalActorReplicationInfo& GlobalInfo, FName StreamingLevelName)
+{
+	// The actor replicates once more to every connection before going dormant again
+	if (FShooterAlwaysRelevantStreamingLevel* Level = AlwaysRelevantStreamingLevelActors.Find(StreamingLevelName))
+	{
+		Level->DormancyEpoch++;
+	}
+}
+
 // Since we listen to global (static) events, we need to watch out for cross world broadcasts (PIE)
 #if WITH_EDITOR
 #define CHECK_WORLDS(X) if(X->GetWorld() != GetWorld()) return;
@@ -564,6 +879,14 @@ void UShooterReplicationGraph::OnGameplayDebuggerOwnerChange(AGameplayDebuggerCa
 
 // ------------------------------------------------------------------------------
 
+void UShooterReplicationGraphNode_GridSpatialization2D::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	FShooterRepGraphGatherScope GatherScope(this);
+	Super::GatherActorListsForConnection(Params);
+}
+
+// ------------------------------------------------------------------------------
+
 void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::ResetGameWorldState()
 {
 	AlwaysRelevantStreamingLevelsNeedingReplication.Empty();
@@ -572,6 +895,7 @@ void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::ResetGameWorldSt
 void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
 {
 	QUICK_SCOPE_CYCLE_COUNTER( UShooterReplicationGraphNode_AlwaysRelevant_ForConnection_GatherActorListsForConnection );
+	FShooterRepGraphGatherScope GatherScope(this);
 
 	UShooterReplicationGraph* ShooterGraph = CastChecked<UShooterReplicationGraph>(GetOuter());
 
@@ -589,8 +913,15 @@ void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorLists
 		}
 	};
 
-	for (const FNetViewer& CurViewer : Params.Viewers)
+	// One slot per viewer, the main viewer first followed by its children
+	if (PastRelevantActors.Num() != Params.Viewers.Num())
+	{
+		PastRelevantActors.SetNum(Params.Viewers.Num());
+	}
+
+	for (int32 ViewerIdx = 0; ViewerIdx < Params.Viewers.Num(); ++ViewerIdx)
 	{
+		const FNetViewer& CurViewer = Params.Viewers[ViewerIdx];
 		ReplicationActorList.ConditionalAdd(CurViewer.InViewer);
 		ReplicationActorList.ConditionalAdd(CurViewer.ViewTarget);
 
@@ -614,18 +945,15 @@ void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorLists
 				}
 			}
 
-			FAlwaysRelevantActorInfo* LastData = PastRelevantActors.FindByKey<UNetConnection*>(CurViewer.Connection);
+			FAlwaysRelevantActorInfo* LastData = &PastRelevantActors[ViewerIdx];
 
-			// We've not seen this actor before, go ahead and add them.
-			if (LastData == nullptr)
+			// We've not seen this viewer in this slot before, start fresh.
+			if (LastData->Connection != CurViewer.Connection)
 			{
-				FAlwaysRelevantActorInfo NewActorInfo;
-				NewActorInfo.Connection = CurViewer.Connection;
-				LastData = &(PastRelevantActors[PastRelevantActors.Add(NewActorInfo)]);
+				*LastData = FAlwaysRelevantActorInfo();
+				LastData->Connection = CurViewer.Connection;
 			}
 
-			check(LastData != nullptr);
-
 			if (AShooterCharacter* Pawn = Cast<AShooterCharacter>(PC->GetPawn()))
 			{
 				ResetActorCullDistance(Pawn, static_cast<AActor*&>(LastData->LastViewer));
@@ -653,22 +981,19 @@ void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorLists
 		}
 	}
 
-	PastRelevantActors.RemoveAll([&](FAlwaysRelevantActorInfo& RelActorInfo) {
-		return RelActorInfo.Connection == nullptr;
-	});
-
 	Params.OutGatheredReplicationLists.AddReplicationActorList(ReplicationActorList);
 
 	// Always relevant streaming level actors.
 	FPerConnectionActorInfoMap& ConnectionActorInfoMap = Params.ConnectionManager.ActorInfoMap;
 	
-	TMap<FName, FActorRepListRefView>& AlwaysRelevantStreamingLevelActors = ShooterGraph->AlwaysRelevantStreamingLevelActors;
+	TMap<FName, FShooterAlwaysRelevantStreamingLevel>& AlwaysRelevantStreamingLevelActors = ShooterGraph->AlwaysRelevantStreamingLevelActors;
 
 	for (int32 Idx=AlwaysRelevantStreamingLevelsNeedingReplication.Num()-1; Idx >= 0; --Idx)
 	{
-		const FName& StreamingLevel = AlwaysRelevantStreamingLevelsNeedingReplication[Idx];
+		FVisibleStreamingLevel& VisibleLevel = AlwaysRelevantStreamingLevelsNeedingReplication[Idx];
+		const FName& StreamingLevel = VisibleLevel.LevelName;
 
-		FActorRepListRefView* Ptr = AlwaysRelevantStreamingLevelActors.Find(StreamingLevel);
+		FShooterAlwaysRelevantStreamingLevel* Ptr = AlwaysRelevantStreamingLevelActors.Find(StreamingLevel);
 		if (Ptr == nullptr)
 		{
 			// No always relevant lists for that level
@@ -677,37 +1002,51 @@ void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorLists
 			continue;
 		}
 
-		FActorRepListRefView& RepList = *Ptr;
+		FShooterAlwaysRelevantStreamingLevel& Level = *Ptr;
+		FActorRepListRefView& RepList = Level.Actors;
 
-		if (RepList.Num() > 0)
+		if (RepList.Num() == 0)
 		{
-			bool bAllDormant = true;
-			for (FActorRepListType Actor : RepList)
-			{
-				FConnectionReplicationActorInfo& ConnectionActorInfo = ConnectionActorInfoMap.FindOrAdd(Actor);
-				if (ConnectionActorInfo.bDormantOnConnection == false)
-				{
-					bAllDormant = false;
-					break;
-				}
-			}
+			UE_LOG(LogShooterReplicationGraph, Warning, TEXT("UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorListsForConnection - empty RepList %s"), *Params.ConnectionManager.GetName());
+			continue;
+		}
 
-			if (bAllDormant)
-			{
-				UE_CLOG(CVar_ShooterRepGraph_DisplayClientLevelStreaming > 0, LogShooterReplicationGraph, Display, TEXT("CLIENTSTREAMING All AlwaysRelevant Actors Dormant on StreamingLevel %s for %s. Removing list."), *StreamingLevel.ToString(), *Params.ConnectionManager.GetName());
-				AlwaysRelevantStreamingLevelsNeedingReplication.RemoveAtSwap(Idx, 1, false);
-			}
-			else
+		if (Level.NumAwake > 0)
+		{
+			VisibleLevel.bSettled = false;
+			Params.OutGatheredReplicationLists.AddReplicationActorList(RepList);
+			continue;
+		}
+
+		// Nothing changed since all of the level's actors went dormant on this connection
+		if (VisibleLevel.bSettled && VisibleLevel.SettledEpoch == Level.DormancyEpoch)
+		{
+			continue;
+		}
+
+		// Every actor wants to be dormant, but this connection may not have received all of them yet. Only checked until the level settles, not in steady state.
+		bool bAllDormant = true;
+		for (FActorRepListType Actor : RepList)
+		{
+			FConnectionReplicationActorInfo& ConnectionActorInfo = ConnectionActorInfoMap.FindOrAdd(Actor);
+			if (ConnectionActorInfo.bDormantOnConnection == false)
 			{
-				UE_CLOG(CVar_ShooterRepGraph_DisplayClientLevelStreaming > 0, LogShooterReplicationGraph, Display, TEXT("CLIENTSTREAMING Adding always Actors on StreamingLevel %s for %s because it has at least one non dormant actor"), *StreamingLevel.ToString(), *Params.ConnectionManager.GetName());
-				Params.OutGatheredReplicationLists.AddReplicationActorList(RepList);
+				bAllDormant = false;
+				break;
 			}
 		}
+
+		if (bAllDormant)
+		{
+			UE_CLOG(CVar_ShooterRepGraph_DisplayClientLevelStreaming > 0, LogShooterReplicationGraph, Display, TEXT("CLIENTSTREAMING All AlwaysRelevant Actors Dormant on StreamingLevel %s for %s. Settling list."), *StreamingLevel.ToString(), *Params.ConnectionManager.GetName());
+			VisibleLevel.bSettled = true;
+			VisibleLevel.SettledEpoch = Level.DormancyEpoch;
+		}
 		else
 		{
-			UE_LOG(LogShooterReplicationGraph, Warning, TEXT("UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorListsForConnection - empty RepList %s"), *Params.ConnectionManager.GetName());
+			UE_CLOG(CVar_ShooterRepGraph_DisplayClientLevelStreaming > 0, LogShooterReplicationGraph, Display, TEXT("CLIENTSTREAMING Adding always Actors on StreamingLevel %s for %s because it has at least one non dormant actor"), *StreamingLevel.ToString(), *Params.ConnectionManager.GetName());
+			Params.OutGatheredReplicationLists.AddReplicationActorList(RepList);
 		}
-
 	}
 
 #if WITH_GAMEPLAY_DEBUGGER
@@ -721,13 +1060,14 @@ void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorLists
 void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::OnClientLevelVisibilityAdd(FName LevelName, UWorld* StreamingWorld)
 {
 	UE_CLOG(CVar_ShooterRepGraph_DisplayClientLevelStreaming > 0, LogShooterReplicationGraph, Display, TEXT("CLIENTSTREAMING ::OnClientLevelVisibilityAdd - %s"), *LevelName.ToString());
-	AlwaysRelevantStreamingLevelsNeedingReplication.Add(LevelName);
+	FVisibleStreamingLevel& VisibleLevel = AlwaysRelevantStreamingLevelsNeedingReplication.AddDefaulted_GetRef();
+	VisibleLevel.LevelName = LevelName;
 }
 
 void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::OnClientLevelVisibilityRemove(FName LevelName)
 {
 	UE_CLOG(CVar_ShooterRepGraph_DisplayClientLevelStreaming > 0, LogShooterReplicationGraph, Display, TEXT("CLIENTSTREAMING ::OnClientLevelVisibilityRemove - %s"), *LevelName.ToString());
-	AlwaysRelevantStreamingLevelsNeedingReplication.Remove(LevelName);
+	AlwaysRelevantStreamingLevelsNeedingReplication.RemoveAll([LevelName](const FVisibleStreamingLevel& VisibleLevel) { return VisibleLevel.LevelName == LevelName; });
 }
 
 void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const
@@ -736,12 +1076,12 @@ void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::LogNode(FReplica
 	DebugInfo.PushIndent();
 	LogActorRepList(DebugInfo, NodeName, ReplicationActorList);
 
-	for (const FName& LevelName : AlwaysRelevantStreamingLevelsNeedingReplication)
+	for (const FVisibleStreamingLevel& VisibleLevel : AlwaysRelevantStreamingLevelsNeedingReplication)
 	{
 		UShooterReplicationGraph* ShooterGraph = CastChecked<UShooterReplicationGraph>(GetOuter());
-		if (FActorRepListRefView* RepList = ShooterGraph->AlwaysRelevantStreamingLevelActors.Find(LevelName))
+		if (FShooterAlwaysRelevantStreamingLevel* Level = ShooterGraph->AlwaysRelevantStreamingLevelActors.Find(VisibleLevel.LevelName))
 		{
-			LogActorRepList(DebugInfo, FString::Printf(TEXT("AlwaysRelevant StreamingLevel List: %s"), *LevelName.ToString()), *RepList);
+			LogActorRepList(DebugInfo, FString::Printf(TEXT("AlwaysRelevant StreamingLevel List: %s (Awake: %d, Settled: %d)"), *VisibleLevel.LevelName.ToString(), Level->NumAwake, VisibleLevel.bSettled), Level->Actors);
 		}
 	}
 
@@ -750,46 +1090,327 @@ void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::LogNode(FReplica
 
 // ------------------------------------------------------------------------------
 
+/** Per connection replication period of a pawn in the band */
+static uint16 GetAimBandReplicationPeriod(EShooterRepAimBand Band, uint16 DefaultPeriod)
+{
+	switch (Band)
+	{
+		case EShooterRepAimBand::InAimCone:
+			return 1;
+		case EShooterRepAimBand::InView:
+			return FMath::Min(DefaultPeriod, static_cast<uint16>(FMath::Clamp(CVar_ShooterRepGraph_AimPriority_InViewPeriod, 1, (int32)MAX_uint16)));
+		case EShooterRepAimBand::Behind:
+			return FMath::Max(DefaultPeriod, static_cast<uint16>(FMath::Clamp(CVar_ShooterRepGraph_AimPriority_BehindPeriod, 1, (int32)MAX_uint16)));
+		default:
+			return DefaultPeriod;
+	}
+}
+
+void UShooterReplicationGraphNode_AimPriority_ForConnection::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	FShooterRepGraphGatherScope GatherScope(this);
+
+	// Added last and gathers nothing itself, the connection's lists are complete here
+	if (GatherScope.StartTime > 0.0)
+	{
+		GatherScope.Graph->RecordConnectionGathered(Params);
+	}
+
+	ConnectionOrderNum = Params.ConnectionManager.ConnectionOrderNum;
+
+	FPerConnectionActorInfoMap& ActorInfoMap = Params.ConnectionManager.ActorInfoMap;
+	FGlobalActorReplicationInfoMap& GlobalInfoMap = *GraphGlobals->GlobalActorReplicationInfoMap;
+
+	auto SetBand = [&](FActorRepListType Actor, EShooterRepAimBand Band)
+	{
+		if (FGlobalActorReplicationInfo* GlobalInfo = GlobalInfoMap.Find(Actor))
+		{
+			FConnectionReplicationActorInfo& ConnectionActorInfo = ActorInfoMap.FindOrAdd(Actor);
+			ConnectionActorInfo.ReplicationPeriodFrame = GetAimBandReplicationPeriod(Band, GlobalInfo->Settings.ReplicationPeriodFrame);
+		}
+	};
+
+	if (CVar_ShooterRepGraph_AimPriority_Enable == 0 || Params.Viewers.Num() == 0)
+	{
+		for (const TPair<TWeakObjectPtr<AActor>, EShooterRepAimBand>& It : PawnBands)
+		{
+			if (AActor* Pawn = It.Key.Get())
+			{
+				SetBand(Pawn, EShooterRepAimBand::Default);
+			}
+		}
+		PawnBands.Reset();
+		return;
+	}
+
+	// Bands change slowly, connections take turns
+	const int32 UpdateInterval = FMath::Max(1, CVar_ShooterRepGraph_AimPriority_UpdateInterval);
+	if ((Params.ReplicationFrameNum + ConnectionOrderNum) % UpdateInterval != 0)
+	{
+		return;
+	}
+
+	UShooterPawnSpatialIndex* PawnIndex = UShooterPawnSpatialIndex::Get(GetOuter());
+	if (PawnIndex == nullptr)
+	{
+		return;
+	}
+
+	QUICK_SCOPE_CYCLE_COUNTER( UShooterReplicationGraphNode_AimPriority_ForConnection_GatherActorListsForConnection );
+
+	// Splitscreen children share the connection, the main viewer decides
+	const FNetViewer& Viewer = Params.Viewers[0];
+	LastViewLocation = Viewer.ViewLocation;
+	LastViewDir = Viewer.ViewDir;
+
+	FShooterPawnQueryResults NearbyPawns;
+	PawnIndex->FindPawnsInRadius(Viewer.ViewLocation, CVar_ShooterRepGraph_AimPriority_Radius, NearbyPawns, false);
+
+	const float AimConeCos = FMath::Cos(FMath::DegreesToRadians(CVar_ShooterRepGraph_AimPriority_AimConeAngle));
+	const float ViewCos = FMath::Cos(FMath::DegreesToRadians(CVar_ShooterRepGraph_AimPriority_ViewAngle));
+	const float BehindCos = FMath::Cos(FMath::DegreesToRadians(CVar_ShooterRepGraph_AimPriority_BehindAngle));
+	const float MinDemoteDistSq = FMath::Square(CVar_ShooterRepGraph_AimPriority_MinDemoteDistance);
+
+	TMap<TWeakObjectPtr<AActor>, EShooterRepAimBand> NewPawnBands;
+	NewPawnBands.Reserve(NearbyPawns.Num());
+
+	for (const FShooterPawnQueryResult& Result : NearbyPawns)
+	{
+		AActor* Pawn = Result.Pawn;
+		if (Pawn == Viewer.ViewTarget || Pawn->GetOwner() == Viewer.InViewer)
+		{
+			continue;
+		}
+
+		const FVector ToPawn = Pawn->GetActorLocation() - Viewer.ViewLocation;
+		const float DistSq = ToPawn.SizeSquared();
+
+		EShooterRepAimBand Band = EShooterRepAimBand::Default;
+		if (DistSq > KINDA_SMALL_NUMBER)
+		{
+			const float CosAngle = (ToPawn * FMath::InvSqrt(DistSq)) | Viewer.ViewDir;
+			if (CosAngle >= AimConeCos)
+			{
+				Band = EShooterRepAimBand::InAimCone;
+			}
+			else if (CosAngle >= ViewCos)
+			{
+				Band = EShooterRepAimBand::InView;
+			}
+			else if (CosAngle <= BehindCos && DistSq >= MinDemoteDistSq)
+			{
+				Band = EShooterRepAimBand::Behind;
+			}
+		}
+
+		// Only touch the connection's actor info when the band changes
+		const EShooterRepAimBand* OldBand = PawnBands.Find(Pawn);
+		if (OldBand == nullptr || *OldBand != Band)
+		{
+			SetBand(Pawn, Band);
+		}
+
+		NewPawnBands.Add(Pawn, Band);
+	}
+
+	// Pawns that left the radius or died go back to their class period
+	for (const TPair<TWeakObjectPtr<AActor>, EShooterRepAimBand>& It : PawnBands)
+	{
+		AActor* Pawn = It.Key.Get();
+		if (Pawn && It.Value != EShooterRepAimBand::Default && NewPawnBands.Contains(It.Key) == false)
+		{
+			SetBand(Pawn, EShooterRepAimBand::Default);
+		}
+	}
+
+	PawnBands = MoveTemp(NewPawnBands);
+}
+
+void UShooterReplicationGraphNode_AimPriority_ForConnection::LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const
+{
+	int32 NumPerBand[4] = { 0 };
+	for (const TPair<TWeakObjectPtr<AActor>, EShooterRepAimBand>& It : PawnBands)
+	{
+		NumPerBand[static_cast<int32>(It.Value)]++;
+	}
+
+	DebugInfo.Log(NodeName);
+	DebugInfo.PushIndent();
+	DebugInfo.Log(FString::Printf(TEXT("Default: %d, InView: %d, InAimCone: %d, Behind: %d"), NumPerBand[0], NumPerBand[1], NumPerBand[2], NumPerBand[3]));
+	DebugInfo.PopIndent();
+}
+
+void UShooterReplicationGraphNode_AimPriority_ForConnection::DrawDebugPriorities(float Duration) const
+{
+	UShooterReplicationGraph* ShooterGraph = Cast<UShooterReplicationGraph>(GetOuter());
+	UWorld* World = ShooterGraph ? ShooterGraph->GetWorld() : nullptr;
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	const float AimConeAngle = FMath::DegreesToRadians(CVar_ShooterRepGraph_AimPriority_AimConeAngle);
+	DrawDebugCone(World, LastViewLocation, LastViewDir, 5000.f, AimConeAngle, AimConeAngle, 16, FColor::Green, false, Duration);
+
+	for (const TPair<TWeakObjectPtr<AActor>, EShooterRepAimBand>& It : PawnBands)
+	{
+		const AActor* Pawn = It.Key.Get();
+		if (IsValid(Pawn) == false)
+		{
+			continue;
+		}
+
+		FColor Color = FColor::White;
+		const TCHAR* BandName = TEXT("Default");
+		switch (It.Value)
+		{
+			case EShooterRepAimBand::InAimCone:	Color = FColor::Green;	BandName = TEXT("InAimCone");	break;
+			case EShooterRepAimBand::InView:	Color = FColor::Yellow;	BandName = TEXT("InView");		break;
+			case EShooterRepAimBand::Behind:	Color = FColor::Red;	BandName = TEXT("Behind");		break;
+			default: break;
+		}
+
+		DrawDebugLine(World, LastViewLocation, Pawn->GetActorLocation(), Color, false, Duration);
+		DrawDebugString(World, Pawn->GetActorLocation(), BandName, nullptr, Color, Duration);
+
+		UE_LOG(LogShooterReplicationGraph, Display, TEXT("  [%d] %-40s %-10s Dist: %.0f"), ConnectionOrderNum, *Pawn->GetName(), BandName, FVector::Dist(LastViewLocation, Pawn->GetActorLocation()));
+	}
+}
+
+// ------------------------------------------------------------------------------
+
 UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::UShooterReplicationGraphNode_PlayerStateFrequencyLimiter()
 {
 	bRequiresPrepareForReplicationCall = true;
 }
 
-void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::PrepareForReplication()
+void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo)
 {
-	QUICK_SCOPE_CYCLE_COUNTER( UShooterReplicationGraphNode_PlayerStateFrequencyLimiter_GlobalPrepareForReplication );
+	if (ActorBucketIndices.Contains(ActorInfo.Actor) == false)
+	{
+		AddToBuckets(ActorInfo.Actor);
+	}
+}
+
+bool UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound)
+{
+	int32 BucketIdx = INDEX_NONE;
+	if (ActorBucketIndices.RemoveAndCopyValue(ActorInfo.Actor, BucketIdx) == false)
+	{
+		UE_CLOG(bWarnIfNotFound, LogShooterReplicationGraph, Warning, TEXT("Player state %s was not found in UShooterReplicationGraphNode_PlayerStateFrequencyLimiter"), *GetActorRepListTypeDebugString(ActorInfo.Actor));
+		return false;
+	}
 
+	ReplicationActorLists[BucketIdx].RemoveFast(ActorInfo.Actor);
+
+	// Fill the hole with the last player state of the last bucket so only the last bucket is ever partially filled
+	const int32 LastBucketIdx = ReplicationActorLists.Num() - 1;
+	FActorRepListRefView& LastBucket = ReplicationActorLists[LastBucketIdx];
+	if (BucketIdx != LastBucketIdx && LastBucket.Num() > 0)
+	{
+		FActorRepListType MovedActor = LastBucket[LastBucket.Num() - 1];
+		LastBucket.RemoveFast(MovedActor);
+		ReplicationActorLists[BucketIdx].Add(MovedActor);
+		ActorBucketIndices.Add(MovedActor, BucketIdx);
+	}
+
+	if (LastBucket.Num() == 0)
+	{
+		ReplicationActorLists.Pop(false);
+	}
+
+	return true;
+}
+
+void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::NotifyResetAllNetworkActors()
+{
 	ReplicationActorLists.Reset();
+	ActorBucketIndices.Reset();
 	ForceNetUpdateReplicationActorList.Reset();
+}
 
-	ReplicationActorLists.AddDefaulted();
-	FActorRepListRefView* CurrentList = &ReplicationActorLists[0];
+void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::AddToBuckets(FActorRepListType Actor)
+{
+	if (ReplicationActorLists.Num() == 0 || ReplicationActorLists.Last().Num() >= TargetActorsPerFrame)
+	{
+		ReplicationActorLists.AddDefaulted();
+	}
+
+	ReplicationActorLists.Last().Add(Actor);
+	ActorBucketIndices.Add(Actor, ReplicationActorLists.Num() - 1);
+}
+
+void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::RebuildBuckets()
+{
+	TArray<FActorRepListType> Actors;
+	ActorBucketIndices.GenerateKeyArray(Actors);
+
+	ReplicationActorLists.Reset();
+	ActorBucketIndices.Reset();
+
+	for (FActorRepListType Actor : Actors)
+	{
+		AddToBuckets(Actor);
+	}
+}
+
+void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::UpdateTargetActorsPerFrame()
+{
+	const int32 MinPerFrame = FMath::Max(1, CVar_ShooterRepGraph_PlayerStateMinPerFrame);
+	const int32 MaxPerFrame = FMath::Max(MinPerFrame, CVar_ShooterRepGraph_PlayerStateMaxPerFrame);
 
-	// We rebuild our lists of player states each frame. This is not as efficient as it could be but its the simplest way
-	// to handle players disconnecting and keeping the lists compact. If the lists were persistent we would need to defrag them as players left.
+	// Enough per frame that every player state goes out once per cycle
+	const int32 NumPlayerStates = ActorBucketIndices.Num();
+	int32 NewTarget = FMath::Clamp(FMath::DivideAndRoundUp(NumPlayerStates, FMath::Max(1, CVar_ShooterRepGraph_PlayerStateCycleFrames)), MinPerFrame, MaxPerFrame);
 
-	for (TActorIterator<APlayerState> It(GetWorld()); It; ++It)
+	// Back off while too many connections are already out of bandwidth. Lists are shared by all connections, so this is a global decision.
+	if (UReplicationGraph* Graph = Cast<UReplicationGraph>(GetOuter()))
 	{
-		APlayerState* PS = *It;
-		if (IsActorValidForReplicationGather(PS) == false)
+		int32 NumSaturated = 0;
+		for (UNetReplicationGraphConnection* ConnectionManager : Graph->Connections)
 		{
-			continue;
+			if (ConnectionManager && ConnectionManager->NetConnection && ConnectionManager->NetConnection->IsNetReady(false) == false)
+			{
+				NumSaturated++;
+			}
 		}
 
-		if (CurrentList->Num() >= TargetActorsPerFrame)
+		if (Graph->Connections.Num() > 0 && NumSaturated > Graph->Connections.Num() * CVar_ShooterRepGraph_PlayerStateSaturatedRatio)
 		{
-			ReplicationActorLists.AddDefaulted();
-			CurrentList = &ReplicationActorLists.Last(); 
+			NewTarget = MinPerFrame;
 		}
-		
-		CurrentList->Add(PS);
-	}	
+	}
+
+	if (NewTarget != TargetActorsPerFrame)
+	{
+		TargetActorsPerFrame = NewTarget;
+		RebuildBuckets();
+	}
+}
+
+void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::PrepareForReplication()
+{
+	QUICK_SCOPE_CYCLE_COUNTER( UShooterReplicationGraphNode_PlayerStateFrequencyLimiter_GlobalPrepareForReplication );
+
+	ForceNetUpdateReplicationActorList.Reset();
+
+	// The buckets themselves are maintained by NotifyAdd/RemoveNetworkActor, all that's left per frame is adapting their size once in a while
+	if (++FramesSinceTargetUpdate >= CVar_ShooterRepGraph_PlayerStateUpdateInterval)
+	{
+		FramesSinceTargetUpdate = 0;
+		UpdateTargetActorsPerFrame();
+	}
 }
 
 void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
 {
-	const int32 ListIdx = Params.ReplicationFrameNum % ReplicationActorLists.Num();
-	Params.OutGatheredReplicationLists.AddReplicationActorList(ReplicationActorLists[ListIdx]);
+	FShooterRepGraphGatherScope GatherScope(this);
+
+	if (ReplicationActorLists.Num() > 0)
+	{
+		const int32 ListIdx = Params.ReplicationFrameNum % ReplicationActorLists.Num();
+		Params.OutGatheredReplicationLists.AddReplicationActorList(ReplicationActorLists[ListIdx]);
+	}
 
 	if (ForceNetUpdateReplicationActorList.Num() > 0)
 	{
@@ -802,6 +1423,8 @@ void UShooterReplicationGraphNode_PlayerStateFrequencyLimiter::LogNode(FReplicat
 	DebugInfo.Log(NodeName);
 	DebugInfo.PushIndent();	
 
+	DebugInfo.Log(FString::Printf(TEXT("TargetActorsPerFrame: %d, PlayerStates: %d"), TargetActorsPerFrame, ActorBucketIndices.Num()));
+
 	int32 i=0;
 	for (const FActorRepListRefView& List : ReplicationActorLists)
 	{
@@ -862,3 +1485,35 @@ FAutoConsoleCommandWithWorldAndArgs ChangeFrequencyBucketsCmd(TEXT("ShooterRepGr
 		Node->SetNonStreamingCollectionSize(Buckets);
 	}
 }));
+
+// ------------------------------------------------------------------------------
+
+FAutoConsoleCommandWithWorldAndArgs ShowAimPriorityCmd(TEXT("ShooterRepGraph.AimPriority.Show"), TEXT("Logs and draws the aim priority band of the pawns around a connection's viewer. Args: <ConnectionIdx (-1 for all)> <Seconds>"), FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray< FString >& Args, UWorld* World) 
+{
+	int32 ConnectionIdx = INDEX_NONE;
+	float Duration = 5.f;
+	if (Args.Num() > 0)
+	{
+		LexTryParseString<int32>(ConnectionIdx, *Args[0]);
+	}
+	if (Args.Num() > 1)
+	{
+		LexTryParseString<float>(Duration, *Args[1]);
+	}
+
+	for (TObjectIterator<UShooterReplicationGraphNode_AimPriority_ForConnection> It; It; ++It)
+	{
+		// nodes of other worlds, e.g. other PIE instances, are left alone
+		UShooterReplicationGraphNode_AimPriority_ForConnection* Node = *It;
+		UShooterReplicationGraph* Graph = Cast<UShooterReplicationGraph>(Node->GetOuter());
+		if (Node->HasAnyFlags(RF_ClassDefaultObject) || Graph == nullptr || Graph->GetWorld() != World)
+		{
+			continue;
+		}
+
+		if (ConnectionIdx == INDEX_NONE || Node->GetConnectionOrderNum() == ConnectionIdx)
+		{
+			Node->DrawDebugPriorities(Duration);
+		}
+	}
+}));
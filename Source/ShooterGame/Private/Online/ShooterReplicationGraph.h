@@ -9,6 +9,7 @@
 class AShooterCharacter;
 class AShooterWeapon;
 class UReplicationGraphNode_GridSpatialization2D;
+class UShooterReplicationGraphNode_PlayerStateFrequencyLimiter;
 class AGameplayDebuggerCategoryReplicator;
 
 DECLARE_LOG_CATEGORY_EXTERN( LogShooterReplicationGraph, Display, All );
@@ -17,8 +18,9 @@ DECLARE_LOG_CATEGORY_EXTERN( LogShooterReplicationGraph, Display, All );
 UENUM()
 enum class EClassRepNodeMapping : uint32
 {
-	NotRouted,						// Doesn't map to any node. Used for special case actors that handled by special case nodes (UShooterReplicationGraphNode_PlayerStateFrequencyLimiter)
+	NotRouted,						// Doesn't map to any node. Used for special case actors that handled by special case nodes (UShooterReplicationGraphNode_AlwaysRelevant_ForConnection)
 	RelevantAllConnections,			// Routes to an AlwaysRelevantNode or AlwaysRelevantStreamingLevelNode node
+	PlayerStateFrequencyLimited,	// Routes to PlayerStateNode: persistent rolling buckets of player states
 	
 	// ONLY SPATIALIZED Enums below here! See UShooterReplicationGraph::IsSpatialized
 
@@ -27,6 +29,44 @@ enum class EClassRepNodeMapping : uint32
 	Spatialize_Dormancy,			// Routes to GridNode: While dormant we treat as static. When flushed/not dormant dynamic. Note this is for things that "move while not dormant".
 };
 
+/** Always relevant actors of one streaming level. The dormancy bookkeeping is kept up to date by the actors' dormancy events, so connections never have to poll the actors */
+struct FShooterAlwaysRelevantStreamingLevel
+{
+	FActorRepListRefView Actors;
+
+	/** Actors in the list that are not dormant */
+	int32 NumAwake = 0;
+
+	/** Bumped whenever an actor flushes dormancy or wakes up. Connections that saw the level fully dormant at an older epoch have to gather it again */
+	uint32 DormancyEpoch = 0;
+};
+
+/** GridNode layout picked for a map, see UShooterReplicationGraph::ComputeGridSettings */
+struct FShooterRepGraphGridSettings
+{
+	float CellSize = 0.f;
+	FVector2D SpatialBias = FVector2D::ZeroVector;
+
+	/** Area covered by player starts and pickups */
+	FBox PlayBounds = FBox(ForceInit);
+
+	int32 NumPlayerStarts = 0;
+	int32 NumPickups = 0;
+};
+
+/** Gather cost of one replication frame, see UShooterReplicationGraph::SetGatherProfiling */
+struct FShooterRepGraphGatherProfile
+{
+	/** Gather seconds per node class, summed over all connections. Only the grid and the ShooterGame nodes are timed. */
+	TMap<FName, double> NodeGatherSeconds;
+
+	/** Connections that were gathered for */
+	int32 NumConnections = 0;
+
+	/** Actors in all gathered lists, summed over all connections */
+	int32 NumActorsGathered = 0;
+};
+
 /** ShooterGame Replication Graph implementation. See additional notes in ShooterReplicationGraph.cpp! */
 UCLASS(transient, config=Engine)
 class UShooterReplicationGraph :public UReplicationGraph
@@ -44,6 +84,24 @@ public:
 	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
 	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
 	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+
+	/** Time the node gathers of every ServerReplicateActors from now on. For benchmarks. */
+	void SetGatherProfiling(bool bEnable) { bProfileGather = bEnable; }
+
+	bool IsProfilingGather() const { return bProfileGather; }
+
+	/** Gather cost of the last ServerReplicateActors, while profiling */
+	const FShooterRepGraphGatherProfile& GetLastGatherProfile() const { return GatherProfile; }
+
+	/** Add a node's gather time to the current frame's profile */
+	void RecordNodeGather(const UReplicationGraphNode* Node, double Seconds);
+
+	/** Add the lists gathered for a connection to the current frame's profile, called once all of its nodes were gathered */
+	void RecordConnectionGathered(const FConnectionGatherActorListParameters& Params);
+
+	/** Wall time of the last ServerReplicateActors */
+	double GetLastReplicateActorsSeconds() const { return LastReplicateActorsSeconds; }
 	
 	UPROPERTY()
 	TArray<UClass*>	SpatializedClasses;
@@ -60,7 +118,10 @@ public:
 	UPROPERTY()
 	UReplicationGraphNode_ActorList* AlwaysRelevantNode;
 
-	TMap<FName, FActorRepListRefView> AlwaysRelevantStreamingLevelActors;
+	UPROPERTY()
+	UShooterReplicationGraphNode_PlayerStateFrequencyLimiter* PlayerStateNode;
+
+	TMap<FName, FShooterAlwaysRelevantStreamingLevel> AlwaysRelevantStreamingLevelActors;
 
 	void OnCharacterEquipWeapon(AShooterCharacter* Character, AShooterWeapon* NewWeapon);
 	void OnCharacterUnEquipWeapon(AShooterCharacter* Character, AShooterWeapon* OldWeapon);
@@ -71,8 +132,28 @@ public:
 
 	void PrintRepNodePolicies();
 
+	/** Pick GridNode cell size and spatial bias from the layout of the levels and the cull distance of pawns. Also used by the grid analysis commandlet. */
+	static FShooterRepGraphGridSettings ComputeGridSettings(const TArray<ULevel*>& Levels, float CullDistance);
+
+	/** Cull distance of pawns, the most common spatialized actors */
+	static float GetPawnCullDistance();
+
 private:
 
+	double LastReplicateActorsSeconds = 0.0;
+
+	bool bProfileGather = false;
+	FShooterRepGraphGatherProfile GatherProfile;
+
+	/** Set up GridNode for the current world, before the first spatialized actor is added to it */
+	void TuneGridNode();
+
+	/** GridNode is empty and hasn't been set up for the current world yet */
+	bool bGridNeedsTuning = true;
+
+	void OnAlwaysRelevantStreamingActorDormancyChange(FActorRepListType Actor, FGlobalActorReplicationInfo& GlobalInfo, ENetDormancy NewValue, ENetDormancy OldValue, FName StreamingLevelName);
+	void OnAlwaysRelevantStreamingActorDormancyFlush(FActorRepListType Actor, FGlobalActorReplicationInfo& GlobalInfo, FName StreamingLevelName);
+
 	EClassRepNodeMapping GetMappingPolicy(UClass* Class);
 
 	bool IsSpatialized(EClassRepNodeMapping Mapping) const { return Mapping >= EClassRepNodeMapping::Spatialize_Static; }
@@ -80,6 +161,17 @@ private:
 	TClassMap<EClassRepNodeMapping> ClassRepNodePolicies;
 };
 
+/** Grid node that reports its gather time while the graph is profiling, see UShooterReplicationGraph::SetGatherProfiling */
+UCLASS()
+class UShooterReplicationGraphNode_GridSpatialization2D : public UReplicationGraphNode_GridSpatialization2D
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+};
+
 UCLASS()
 class UShooterReplicationGraphNode_AlwaysRelevant_ForConnection : public UReplicationGraphNode
 {
@@ -106,20 +198,78 @@ public:
 
 private:
 
-	TArray<FName, TInlineAllocator<64> > AlwaysRelevantStreamingLevelsNeedingReplication;
+	/** A streaming level visible on the client, and whether all of its always relevant actors are known to be dormant on this connection */
+	struct FVisibleStreamingLevel
+	{
+		FName LevelName;
+
+		/** DormancyEpoch of the level when all of its actors were last seen dormant on this connection */
+		uint32 SettledEpoch = 0;
+
+		bool bSettled = false;
+	};
+
+	TArray<FVisibleStreamingLevel, TInlineAllocator<64> > AlwaysRelevantStreamingLevelsNeedingReplication;
 
 	FActorRepListRefView ReplicationActorList;
 
 	UPROPERTY()
 	AActor* LastPawn = nullptr;
 
-	/** List of previously (or currently if nothing changed last tick) focused actor data per connection */
+	/** Previously (or currently if nothing changed last tick) focused actor data, indexed like the viewers of the connection */
 	UPROPERTY()
 	TArray<FAlwaysRelevantActorInfo> PastRelevantActors;
 
 	bool bInitializedPlayerState = false;
 };
 
+/** How a pawn sits relative to a connection's view, see UShooterReplicationGraphNode_AimPriority_ForConnection */
+enum class EShooterRepAimBand : uint8
+{
+	Default,	// Outside the view but not behind the viewer, or close enough to matter anyway
+	InView,		// Inside the view frustum
+	InAimCone,	// Inside the viewer's aim cone
+	Behind,		// Behind the viewer and far enough away
+};
+
+/**
+ * Per connection node that steers replication of nearby pawns by where they are relative to the viewer.
+ * Pawns in the aim cone are considered every frame, pawns in view more often than the pawn class period (raised while the node is enabled) and pawns behind the viewer
+ * less often, leaving more of a saturated connection to what the player is looking at.
+ * Does not gather anything itself, pawns keep coming from the GridNode.
+ */
+UCLASS()
+class UShooterReplicationGraphNode_AimPriority_ForConnection : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& Actor) override { }
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound=true) override { return false; }
+	virtual void NotifyResetAllNetworkActors() override { PawnBands.Reset(); }
+
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+	virtual void LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const override;
+
+	/** Draw the current band of every tracked pawn from the viewer, see ShooterRepGraph.AimPriority.Show */
+	void DrawDebugPriorities(float Duration) const;
+
+	int32 GetConnectionOrderNum() const { return ConnectionOrderNum; }
+
+private:
+
+	/** Band of each pawn we changed the replication period of on this connection. Weak, pawns that were destroyed since the last update must not get their connection info back. */
+	TMap<TWeakObjectPtr<AActor>, EShooterRepAimBand> PawnBands;
+
+	/** Viewer at the last update, for debugging */
+	FVector LastViewLocation = FVector::ZeroVector;
+	FVector LastViewDir = FVector::ForwardVector;
+
+	int32 ConnectionOrderNum = INDEX_NONE;
+};
+
 /** This is a specialized node for handling PlayerState replication in a frequency limited fashion. It tracks all player states but only returns a subset of them to the replication driver each frame. */
 UCLASS()
 class UShooterReplicationGraphNode_PlayerStateFrequencyLimiter : public UReplicationGraphNode
@@ -128,8 +278,9 @@ class UShooterReplicationGraphNode_PlayerStateFrequencyLimiter : public UReplica
 
 	UShooterReplicationGraphNode_PlayerStateFrequencyLimiter();
 
-	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& Actor) override { }
-	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound=true) override { return false; }
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& Actor) override;
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound=true) override;
+	virtual void NotifyResetAllNetworkActors() override;
 
 	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
 
@@ -137,11 +288,28 @@ class UShooterReplicationGraphNode_PlayerStateFrequencyLimiter : public UReplica
 
 	virtual void LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const override;
 
-	/** How many actors we want to return to the replication driver per frame. Will not suppress ForceNetUpdate. */
+	/** How many actors we want to return to the replication driver per frame. Will not suppress ForceNetUpdate. Adapted to player count and bandwidth, see UpdateTargetActorsPerFrame. */
 	int32 TargetActorsPerFrame = 2;
 
 private:
-	
+
+	/** append to the last bucket, starting a new one when it is full */
+	void AddToBuckets(FActorRepListType Actor);
+
+	/** redistribute all player states after TargetActorsPerFrame changed */
+	void RebuildBuckets();
+
+	/** pick TargetActorsPerFrame from player count and how many connections are out of bandwidth */
+	void UpdateTargetActorsPerFrame();
+
+	/** persistent buckets, all full except the last one. Compacted with swap-removes as players leave */
 	TArray<FActorRepListRefView> ReplicationActorLists;
+
+	/** bucket each tracked player state is in */
+	TMap<FActorRepListType, int32> ActorBucketIndices;
+
 	FActorRepListRefView ForceNetUpdateReplicationActorList;
+
+	/** frames since TargetActorsPerFrame was last evaluated */
+	int32 FramesSinceTargetUpdate = 0;
 };
\ No newline at end of file
@@ -0,0 +1,203 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Online/ShooterVisibilityCache.h"
+
+DECLARE_CYCLE_STAT(TEXT("Visibility Cache Refresh"), STAT_ShooterVisibilityCacheRefresh, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Visibility Traces Issued"), STAT_ShooterVisibilityTraces, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Visibility Cache Hits"), STAT_ShooterVisibilityCacheHits, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Visibility Cache Misses"), STAT_ShooterVisibilityCacheMisses, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Visibility Stale Hits"), STAT_ShooterVisibilityStaleHits, STATGROUP_ShooterGame);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Visibility Max Staleness (s)"), STAT_ShooterVisibilityMaxStaleness, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Visibility Cached Pairs"), STAT_ShooterVisibilityPairs, STATGROUP_ShooterGame);
+
+static int32 NetPauseRelevancyTraceBudget = 64;
+FAutoConsoleVariableRef CVarNetPauseRelevancyTraceBudget(
+	TEXT("p.NetPauseRelevancyTraceBudget"),
+	NetPauseRelevancyTraceBudget,
+	TEXT("Max line of sight traces issued per frame to refresh the pause relevancy cache. The pair in progress may finish over budget."),
+	ECVF_Default);
+
+static float NetPauseRelevancyRefreshInterval = 0.25f;
+FAutoConsoleVariableRef CVarNetPauseRelevancyRefreshInterval(
+	TEXT("p.NetPauseRelevancyRefreshInterval"),
+	NetPauseRelevancyRefreshInterval,
+	TEXT("Age in seconds after which a cached (viewer, character) visibility result is refreshed."),
+	ECVF_Default);
+
+static float NetPauseRelevancyEvictTime = 2.0f;
+FAutoConsoleVariableRef CVarNetPauseRelevancyEvictTime(
+	TEXT("p.NetPauseRelevancyEvictTime"),
+	NetPauseRelevancyEvictTime,
+	TEXT("Cached pairs that haven't been queried for this many seconds are dropped."),
+	ECVF_Default);
+
+UShooterVisibilityCache::UShooterVisibilityCache(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	RefreshCursor = 0;
+}
+
+UShooterVisibilityCache* UShooterVisibilityCache::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UShooterVisibilityCache>() : nullptr;
+}
+
+bool UShooterVisibilityCache::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UShooterVisibilityCache::Deinitialize()
+{
+	Entries.Empty();
+	EntryIndices.Empty();
+	RefreshCursor = 0;
+
+	Super::Deinitialize();
+}
+
+bool UShooterVisibilityCache::IsVisible(APlayerController* Viewer, AShooterCharacter* Target)
+{
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+	const FVisibilityKey Key(Viewer, Target);
+
+	if (const int32* Index = EntryIndices.Find(Key))
+	{
+		FVisibilityEntry& Entry = Entries[*Index];
+		Entry.LastQueryTime = TimeSeconds;
+
+		if (Entry.LastRefreshTime >= 0.0f)
+		{
+			INC_DWORD_STAT(STAT_ShooterVisibilityCacheHits);
+			if (TimeSeconds - Entry.LastRefreshTime > NetPauseRelevancyRefreshInterval)
+			{
+				INC_DWORD_STAT(STAT_ShooterVisibilityStaleHits);
+			}
+			return Entry.bVisible;
+		}
+	}
+	else
+	{
+		FVisibilityEntry& Entry = Entries.AddDefaulted_GetRef();
+		Entry.Key = Key;
+		Entry.Viewer = Viewer;
+		Entry.Target = Target;
+		Entry.LastRefreshTime = -1.0f;
+		Entry.LastQueryTime = TimeSeconds;
+		Entry.bVisible = true;
+
+		EntryIndices.Add(Key, Entries.Num() - 1);
+	}
+
+	INC_DWORD_STAT(STAT_ShooterVisibilityCacheMisses);
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Refresh
+
+void UShooterVisibilityCache::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterVisibilityCacheRefresh);
+
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+	int32 TraceBudget = NetPauseRelevancyTraceBudget;
+	float MaxStaleness = 0.0f;
+
+	// visit every entry at most once per frame, starting where the last pass ran out of budget
+	int32 NumToVisit = Entries.Num();
+	RefreshCursor = Entries.Num() > 0 ? RefreshCursor % Entries.Num() : 0;
+
+	while (NumToVisit-- > 0 && Entries.Num() > 0)
+	{
+		FVisibilityEntry& Entry = Entries[RefreshCursor];
+
+		if (!Entry.Viewer.IsValid() || !Entry.Target.IsValid() || TimeSeconds - Entry.LastQueryTime > NetPauseRelevancyEvictTime)
+		{
+			// the last entry is swapped into the cursor slot, so visit the same index again
+			RemoveEntryAt(RefreshCursor);
+			RefreshCursor = Entries.Num() > 0 ? RefreshCursor % Entries.Num() : 0;
+			continue;
+		}
+
+		const float Age = Entry.LastRefreshTime >= 0.0f ? TimeSeconds - Entry.LastRefreshTime : MAX_flt;
+		if (Age > NetPauseRelevancyRefreshInterval)
+		{
+			if (TraceBudget <= 0)
+			{
+				// keep the cursor here so this pair is first in line next frame
+				break;
+			}
+
+			TraceBudget -= RefreshEntry(Entry, TimeSeconds);
+		}
+		else
+		{
+			MaxStaleness = FMath::Max(MaxStaleness, Age);
+		}
+
+		RefreshCursor = (RefreshCursor + 1) % Entries.Num();
+	}
+
+	INC_DWORD_STAT_BY(STAT_ShooterVisibilityTraces, NetPauseRelevancyTraceBudget - TraceBudget);
+	SET_FLOAT_STAT(STAT_ShooterVisibilityMaxStaleness, MaxStaleness);
+	SET_DWORD_STAT(STAT_ShooterVisibilityPairs, Entries.Num());
+}
+
+bool UShooterVisibilityCache::IsTickable() const
+{
+	return Entries.Num() > 0;
+}
+
+TStatId UShooterVisibilityCache::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterVisibilityCache, STATGROUP_Tickables);
+}
+
+UWorld* UShooterVisibilityCache::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+int32 UShooterVisibilityCache::RefreshEntry(FVisibilityEntry& Entry, float TimeSeconds)
+{
+	APlayerController* PC = Entry.Viewer.Get();
+	AShooterCharacter* Target = Entry.Target.Get();
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	FCollisionQueryParams CollisionParams(SCENE_QUERY_STAT(LineOfSight), true, PC->GetPawn());
+	CollisionParams.AddIgnoredActor(Target);
+
+	int32 NumTraces = 0;
+	Entry.bVisible = false;
+	for (const FVector& PointToTest : Target->GetPauseReplicationCheckPoints())
+	{
+		NumTraces++;
+		if (!GetWorld()->LineTraceTestByChannel(PointToTest, ViewLocation, ECC_Visibility, CollisionParams))
+		{
+			Entry.bVisible = true;
+			break;
+		}
+	}
+
+	Entry.LastRefreshTime = TimeSeconds;
+	return NumTraces;
+}
+
+void UShooterVisibilityCache::RemoveEntryAt(int32 Index)
+{
+	EntryIndices.Remove(Entries[Index].Key);
+
+	const int32 LastIndex = Entries.Num() - 1;
+	if (Index != LastIndex)
+	{
+		EntryIndices.Add(Entries[LastIndex].Key, Index);
+	}
+
+	Entries.RemoveAtSwap(Index, 1, false);
+}
@@ -31,14 +31,26 @@ void AShooterPickup::BeginPlay()
 {
 	Super::BeginPlay();
 
-	RespawnPickup();
-
 	// register on pickup list (server only), don't care about unregistering (in FinishDestroy) - no streaming
 	AShooterGameMode* GameMode = GetWorld()->GetAuthGameMode<AShooterGameMode>();
 	if (GameMode)
 	{
 		GameMode->LevelPickups.Add(this);
+		GameMode->GetPickupRegistry().RegisterPickup(this, bIsActive);
 	}
+
+	RespawnPickup();
+}
+
+void AShooterPickup::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	AShooterGameMode* GameMode = GetWorld()->GetAuthGameMode<AShooterGameMode>();
+	if (GameMode)
+	{
+		GameMode->GetPickupRegistry().UnregisterPickup(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AShooterPickup::NotifyActorBeginOverlap(class AActor* Other)
@@ -52,6 +64,11 @@ bool AShooterPickup::CanBePickedUp(class AShooterCharacter* TestPawn) const
 	return TestPawn && TestPawn->IsAlive();
 }
 
+UClass* AShooterPickup::GetPickupWeaponType() const
+{
+	return NULL;
+}
+
 void AShooterPickup::GivePickupTo(class AShooterCharacter* Pawn)
 {
 }
@@ -96,6 +113,12 @@ void AShooterPickup::RespawnPickup()
 
 void AShooterPickup::OnPickedUp()
 {
+	AShooterGameMode* GameMode = GetWorld()->GetAuthGameMode<AShooterGameMode>();
+	if (GameMode)
+	{
+		GameMode->GetPickupRegistry().SetPickupActive(this, false);
+	}
+
 	if (RespawningFX)
 	{
 		PickupPSC->SetTemplate(RespawningFX);
@@ -116,6 +139,12 @@ void AShooterPickup::OnPickedUp()
 
 void AShooterPickup::OnRespawned()
 {
+	AShooterGameMode* GameMode = GetWorld()->GetAuthGameMode<AShooterGameMode>();
+	if (GameMode)
+	{
+		GameMode->GetPickupRegistry().SetPickupActive(this, true);
+	}
+
 	if (ActiveFX)
 	{
 		PickupPSC->SetTemplate(ActiveFX);
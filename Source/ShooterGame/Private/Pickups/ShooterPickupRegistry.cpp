@@ -0,0 +1,196 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Pickups/ShooterPickupRegistry.h"
+#include "Pickups/ShooterPickup.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pickup Registry Query"), STAT_ShooterPickupRegistryQuery, STATGROUP_ShooterGame);
+
+static float PickupRegistryCellSize = 1500.0f;
+FAutoConsoleVariableRef CVarPickupRegistryCellSize(
+	TEXT("ShooterGame.PickupRegistry.CellSize"),
+	PickupRegistryCellSize,
+	TEXT("Size of the pickup registry grid cells, in uu. Applies to registries created after the change."),
+	ECVF_Default);
+
+FShooterPickupRegistry::FShooterPickupRegistry()
+{
+	CellSize = FMath::Max(100.0f, PickupRegistryCellSize);
+}
+
+FIntPoint FShooterPickupRegistry::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void FShooterPickupRegistry::RegisterPickup(AShooterPickup* Pickup, bool bIsActive)
+{
+	if (Pickup == nullptr || Pickups.Contains(Pickup))
+	{
+		return;
+	}
+
+	// group by the native class, blueprint subclasses of the same pickup share a group
+	UClass* PickupClass = Pickup->GetClass();
+	while (PickupClass && !PickupClass->HasAnyClassFlags(CLASS_Native))
+	{
+		PickupClass = PickupClass->GetSuperClass();
+	}
+	UClass* WeaponType = Pickup->GetPickupWeaponType();
+
+	int32 GroupIndex = Groups.IndexOfByPredicate([PickupClass, WeaponType](const FPickupGroup& Group)
+	{
+		return Group.PickupClass == PickupClass && Group.WeaponType == WeaponType;
+	});
+
+	if (GroupIndex == INDEX_NONE)
+	{
+		GroupIndex = Groups.AddDefaulted();
+		FPickupGroup& NewGroup = Groups[GroupIndex];
+		NewGroup.PickupClass = PickupClass;
+		NewGroup.WeaponType = WeaponType;
+		NewGroup.MinCell = FIntPoint(MAX_int32, MAX_int32);
+		NewGroup.MaxCell = FIntPoint(MIN_int32, MIN_int32);
+		NewGroup.NumActive = 0;
+	}
+
+	FPickupGroup& Group = Groups[GroupIndex];
+
+	FPickupSlot& Slot = Pickups.Add(Pickup);
+	Slot.GroupIndex = GroupIndex;
+	Slot.Cell = GetCell(Pickup->GetActorLocation());
+	Slot.bActive = false;
+
+	Group.MinCell = Group.MinCell.ComponentMin(Slot.Cell);
+	Group.MaxCell = Group.MaxCell.ComponentMax(Slot.Cell);
+
+	SetPickupActive(Pickup, bIsActive);
+}
+
+void FShooterPickupRegistry::UnregisterPickup(AShooterPickup* Pickup)
+{
+	if (Pickups.Contains(Pickup))
+	{
+		SetPickupActive(Pickup, false);
+		Pickups.Remove(Pickup);
+	}
+}
+
+void FShooterPickupRegistry::SetPickupActive(AShooterPickup* Pickup, bool bIsActive)
+{
+	FPickupSlot* Slot = Pickups.Find(Pickup);
+	if (Slot == nullptr || Slot->bActive == bIsActive)
+	{
+		return;
+	}
+
+	FPickupGroup& Group = Groups[Slot->GroupIndex];
+	Slot->bActive = bIsActive;
+
+	if (bIsActive)
+	{
+		Group.ActiveCells.FindOrAdd(Slot->Cell).Add(Pickup);
+		Group.NumActive++;
+	}
+	else
+	{
+		TArray<AShooterPickup*, TInlineAllocator<4>>* CellPickups = Group.ActiveCells.Find(Slot->Cell);
+		if (CellPickups)
+		{
+			CellPickups->RemoveSingleSwap(Pickup, false);
+			if (CellPickups->Num() == 0)
+			{
+				Group.ActiveCells.Remove(Slot->Cell);
+			}
+		}
+		Group.NumActive--;
+	}
+}
+
+AShooterPickup* FShooterPickupRegistry::FindNearestAvailable(UClass* PickupClass, UClass* WeaponType, const FVector& Origin, AShooterCharacter* ForPawn, float* OutDistSq) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterPickupRegistryQuery);
+
+	AShooterPickup* BestPickup = nullptr;
+	float BestDistSq = MAX_FLT;
+
+	for (const FPickupGroup& Group : Groups)
+	{
+		if (Group.NumActive == 0 || !Group.PickupClass->IsChildOf(PickupClass))
+		{
+			continue;
+		}
+
+		if (WeaponType && (Group.WeaponType == nullptr || !Group.WeaponType->IsChildOf(WeaponType)))
+		{
+			continue;
+		}
+
+		// each group only has to beat the best so far
+		float GroupDistSq = BestDistSq;
+		AShooterPickup* GroupPickup = FindNearestInGroup(Group, Origin, ForPawn, BestDistSq, GroupDistSq);
+		if (GroupPickup)
+		{
+			BestPickup = GroupPickup;
+			BestDistSq = GroupDistSq;
+		}
+	}
+
+	if (OutDistSq)
+	{
+		*OutDistSq = BestDistSq;
+	}
+	return BestPickup;
+}
+
+AShooterPickup* FShooterPickupRegistry::FindNearestInGroup(const FPickupGroup& Group, const FVector& Origin, AShooterCharacter* ForPawn, float MaxDistSq, float& OutDistSq) const
+{
+	const FIntPoint OriginCell = GetCell(Origin);
+
+	// no pickup of the group lies further away than this
+	const int32 LastRing = FMath::Max(
+		FMath::Max(FMath::Abs(Group.MinCell.X - OriginCell.X), FMath::Abs(Group.MaxCell.X - OriginCell.X)),
+		FMath::Max(FMath::Abs(Group.MinCell.Y - OriginCell.Y), FMath::Abs(Group.MaxCell.Y - OriginCell.Y)));
+
+	AShooterPickup* BestPickup = nullptr;
+	float BestDistSq = MaxDistSq;
+
+	for (int32 Ring = 0; Ring <= LastRing; Ring++)
+	{
+		// every cell in the ring is at least this far from the origin
+		const float RingMinDist = FMath::Max(0, Ring - 1) * CellSize;
+		if (FMath::Square(RingMinDist) >= BestDistSq)
+		{
+			break;
+		}
+
+		for (int32 X = OriginCell.X - Ring; X <= OriginCell.X + Ring; X++)
+		{
+			// only the border of the square is in this ring
+			const bool bEdgeColumn = (X == OriginCell.X - Ring || X == OriginCell.X + Ring);
+			const int32 YStep = bEdgeColumn ? 1 : FMath::Max(1, Ring * 2);
+
+			for (int32 Y = OriginCell.Y - Ring; Y <= OriginCell.Y + Ring; Y += YStep)
+			{
+				const TArray<AShooterPickup*, TInlineAllocator<4>>* CellPickups = Group.ActiveCells.Find(FIntPoint(X, Y));
+				if (CellPickups == nullptr)
+				{
+					continue;
+				}
+
+				for (AShooterPickup* Pickup : *CellPickups)
+				{
+					const float DistSq = FVector::DistSquared(Pickup->GetActorLocation(), Origin);
+					if (DistSq < BestDistSq && (ForPawn == nullptr || Pickup->CanBePickedUp(ForPawn)))
+					{
+						BestDistSq = DistSq;
+						BestPickup = Pickup;
+					}
+				}
+			}
+		}
+	}
+
+	OutDistSq = BestDistSq;
+	return BestPickup;
+}
@@ -3,8 +3,13 @@
 #include "ShooterGame.h"
 #include "Weapons/ShooterWeapon.h"
 #include "Weapons/ShooterDamageType.h"
+#include "Weapons/ShooterLagCompensation.h"
 #include "UI/ShooterHUD.h"
 #include "Online/ShooterPlayerState.h"
+#include "Online/ShooterVisibilityCache.h"
+#include "Player/ShooterPawnSpatialIndex.h"
+#include "Player/ShooterSignificanceManager.h"
+#include "Player/ShooterRespawnPool.h"
 #include "Animation/AnimMontage.h"
 #include "Animation/AnimInstance.h"
 #include "Sound/SoundNodeLocalPlayer.h"
@@ -64,9 +69,15 @@ AShooterCharacter::AShooterCharacter(const FObjectInitializer& ObjectInitializer
 	bWantsToRun = false;
 	bWantsToFire = false;
 	LowHealthPercentage = 0.5f;
+	bTeamColorsDirty = false;
+	Significance = EShooterSignificance::Full;
+	bPooled = false;
+	PoolGeneration = 0;
 
 	BaseTurnRate = 45.f;
 	BaseLookUpRate = 45.f;
+
+	bPauseReplicationCheckPointsValid = false;
 }
 
 void AShooterCharacter::PostInitializeComponents()
@@ -77,10 +88,31 @@ void AShooterCharacter::PostInitializeComponents()
 	{
 		Health = GetMaxHealth();
 
+		// record bounds history for validating client hits
+		if (UShooterLagCompensation* LagCompensation = UShooterLagCompensation::Get(this))
+		{
+			LagCompensation->RegisterPawn(this);
+		}
+
+		// make this pawn visible to proximity queries
+		if (UShooterPawnSpatialIndex* PawnIndex = UShooterPawnSpatialIndex::Get(this))
+		{
+			PawnIndex->RegisterPawn(this);
+		}
+
 		// Needs to happen after character is added to repgraph
 		GetWorldTimerManager().SetTimerForNextTick(this, &AShooterCharacter::SpawnDefaultInventory);
 	}
 
+	// relevancy check points follow the capsule
+	GetCapsuleComponent()->TransformUpdated.AddUObject(this, &AShooterCharacter::OnCapsuleTransformUpdated);
+
+	// throttle ticks by distance and visibility
+	if (UShooterSignificanceManager* SignificanceManager = UShooterSignificanceManager::Get(this))
+	{
+		SignificanceManager->RegisterPawn(this);
+	}
+
 	// set initial mesh visibility (3rd person view)
 	UpdatePawnMeshes();
 
@@ -90,7 +122,11 @@ void AShooterCharacter::PostInitializeComponents()
 		MeshMIDs.Add(GetMesh()->CreateAndSetMaterialInstanceDynamic(iMat));
 	}
 
-	// play respawn effects
+	PlayRespawnEffects();
+}
+
+void AShooterCharacter::PlayRespawnEffects()
+{
 	if (GetNetMode() != NM_DedicatedServer)
 	{
 		if (RespawnFX)
@@ -109,6 +145,29 @@ void AShooterCharacter::Destroyed()
 {
 	Super::Destroyed();
 	DestroyInventory();
+
+	if (bPooled && GetLocalRole() == ROLE_Authority)
+	{
+		if (UShooterRespawnPool* RespawnPool = UShooterRespawnPool::Get(this))
+		{
+			RespawnPool->NotifyPawnDestroyed(this);
+		}
+	}
+
+	if (UShooterLagCompensation* LagCompensation = UShooterLagCompensation::Get(this))
+	{
+		LagCompensation->UnregisterPawn(this);
+	}
+
+	if (UShooterPawnSpatialIndex* PawnIndex = UShooterPawnSpatialIndex::Get(this))
+	{
+		PawnIndex->UnregisterPawn(this);
+	}
+
+	if (UShooterSignificanceManager* SignificanceManager = UShooterSignificanceManager::Get(this))
+	{
+		SignificanceManager->UnregisterPawn(this);
+	}
 }
 
 void AShooterCharacter::PawnClientRestart()
@@ -124,6 +183,8 @@ void AShooterCharacter::PawnClientRestart()
 	// set team colors for 1st person view
 	UMaterialInstanceDynamic* Mesh1PMID = Mesh1P->CreateAndSetMaterialInstanceDynamic(0);
 	UpdateTeamColors(Mesh1PMID);
+
+	UpdateLocallyControlledSound();
 }
 
 void AShooterCharacter::PossessedBy(class AController* InController)
@@ -132,6 +193,40 @@ void AShooterCharacter::PossessedBy(class AController* InController)
 
 	// [server] as soon as PlayerState is assigned, set team colors of this pawn for local player
 	UpdateTeamColorsAllMIDs();
+
+	UpdateLocallyControlledSound();
+}
+
+void AShooterCharacter::UnPossessed()
+{
+	Super::UnPossessed();
+
+	UpdateLocallyControlledSound();
+}
+
+void AShooterCharacter::OnRep_Controller()
+{
+	Super::OnRep_Controller();
+
+	UpdateLocallyControlledSound();
+}
+
+void AShooterCharacter::UpdateLocallyControlledSound()
+{
+	const APlayerController* PC = Cast<APlayerController>(GetController());
+	USoundNodeLocalPlayer::SetLocallyControlled(GetUniqueID(), PC ? PC->IsLocalController() : false);
+}
+
+void AShooterCharacter::PostNetInit()
+{
+	Super::PostNetInit();
+
+	// dead and waiting in the respawn pool when this client first saw it
+	if (bPooled && Health <= 0.0f)
+	{
+		bIsDying = true;
+		OnReleasedToPool();
+	}
 }
 
 void AShooterCharacter::OnRep_PlayerState()
@@ -337,14 +432,24 @@ void AShooterCharacter::OnDeath(float KillingDamage, struct FDamageEvent const&
 		return;
 	}
 
-	SetReplicatingMovement(false);
-	TearOff();
+	// pooled pawns keep their channel for the next life
+	if (!bPooled)
+	{
+		SetReplicatingMovement(false);
+		TearOff();
+	}
 	bIsDying = true;
 
 	if (GetLocalRole() == ROLE_Authority)
 	{
 		ReplicateHit(KillingDamage, DamageEvent, PawnInstigator, DamageCauser, true);
 
+		// corpses can't be hit, free the history slot
+		if (UShooterLagCompensation* LagCompensation = UShooterLagCompensation::Get(this))
+		{
+			LagCompensation->UnregisterPawn(this);
+		}
+
 		// play the force feedback effect on the client player controller
 		AShooterPlayerController* PC = Cast<AShooterPlayerController>(Controller);
 		if (PC && DamageEvent.DamageTypeClass)
@@ -365,8 +470,15 @@ void AShooterCharacter::OnDeath(float KillingDamage, struct FDamageEvent const&
 		UGameplayStatics::PlaySoundAtLocation(this, DeathSound, GetActorLocation());
 	}
 
-	// remove all weapons
-	DestroyInventory();
+	// remove all weapons, pooled pawns keep theirs for the next life
+	if (bPooled)
+	{
+		HolsterInventory();
+	}
+	else
+	{
+		DestroyInventory();
+	}
 
 	// switch back to 3rd person view
 	UpdatePawnMeshes();
@@ -384,6 +496,24 @@ void AShooterCharacter::OnDeath(float KillingDamage, struct FDamageEvent const&
 		RunLoopAC->Stop();
 	}
 
+	if (bPooled)
+	{
+		// a ragdoll copy takes over the body, the pawn is hidden until it's reused
+		UShooterRespawnPool* RespawnPool = UShooterRespawnPool::Get(this);
+		if (RespawnPool && GetNetMode() != NM_DedicatedServer)
+		{
+			RespawnPool->SpawnCorpse(this);
+		}
+
+		OnReleasedToPool();
+
+		if (RespawnPool && GetLocalRole() == ROLE_Authority)
+		{
+			RespawnPool->ReleasePawn(this);
+		}
+		return;
+	}
+
 	if (GetMesh())
 	{
 		static FName CollisionProfileName(TEXT("Ragdoll"));
@@ -549,6 +679,81 @@ void AShooterCharacter::TornOff()
 	SetLifeSpan(25.f);
 }
 
+void AShooterCharacter::SetPooled()
+{
+	bPooled = true;
+}
+
+void AShooterCharacter::OnAcquiredFromPool()
+{
+	SetNetDormancy(DORM_Awake);
+
+	PoolGeneration++;
+	Health = GetMaxHealth();
+	LastHitBy = NULL;
+
+	// don't replay the death to clients when they wake up
+	LastTakeHitTimeTimeout = 0.0f;
+
+	ResetForReuse();
+
+	if (UShooterLagCompensation* LagCompensation = UShooterLagCompensation::Get(this))
+	{
+		LagCompensation->RegisterPawn(this);
+	}
+
+	// refill and equip the weapons the pawn kept, same timing as a fresh spawn
+	GetWorldTimerManager().SetTimerForNextTick(this, &AShooterCharacter::SpawnDefaultInventory);
+
+	PlayRespawnEffects();
+}
+
+void AShooterCharacter::OnReleasedToPool()
+{
+	SetLifeSpan(0.0f);
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->DisableMovement();
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+}
+
+void AShooterCharacter::ResetForReuse()
+{
+	bIsDying = false;
+	bWantsToRun = false;
+	bWantsToRunToggled = false;
+	bIsTargeting = false;
+	bWantsToFire = false;
+
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+
+	UShooterCharacterMovement* ShooterMovement = Cast<UShooterCharacterMovement>(GetCharacterMovement());
+	if (ShooterMovement)
+	{
+		ShooterMovement->ResetForReuse();
+	}
+	GetCharacterMovement()->SetComponentTickEnabled(true);
+
+	// material instances survive the death, team colors are set again when possessed
+	UpdatePawnMeshes();
+}
+
+void AShooterCharacter::OnRep_PoolGeneration()
+{
+	// initial replication, PostNetInit takes care of pawns still waiting in the pool
+	if (!HasActorBegunPlay())
+	{
+		return;
+	}
+
+	ResetForReuse();
+	PlayRespawnEffects();
+}
+
 bool AShooterCharacter::IsMoving()
 {
 	return FMath::Abs(GetLastMovementInputVector().Size()) > 0.f;
@@ -564,6 +769,21 @@ void AShooterCharacter::SpawnDefaultInventory()
 		return;
 	}
 
+	// pooled pawns keep their weapons between lives
+	if (Inventory.Num() > 0)
+	{
+		for (AShooterWeapon* Weapon : Inventory)
+		{
+			if (Weapon)
+			{
+				Weapon->ResetForReuse();
+			}
+		}
+
+		EquipWeapon(Inventory[0]);
+		return;
+	}
+
 	int32 NumWeaponClasses = DefaultInventoryClasses.Num();
 	for (int32 i = 0; i < NumWeaponClasses; i++)
 	{
@@ -602,6 +822,16 @@ void AShooterCharacter::DestroyInventory()
 	}
 }
 
+void AShooterCharacter::HolsterInventory()
+{
+	if (GetLocalRole() < ROLE_Authority)
+	{
+		return;
+	}
+
+	SetCurrentWeapon(NULL);
+}
+
 void AShooterCharacter::AddWeapon(AShooterWeapon* Weapon)
 {
 	if (Weapon && GetLocalRole() == ROLE_Authority)
@@ -1097,10 +1327,6 @@ void AShooterCharacter::OnStartJump()
 	UShooterCharacterMovement* movementComponent = Cast<UShooterCharacterMovement>(GetCharacterMovement());
 	if(movementComponent)
 	{
-		if(!HasAuthority())
-		{
-			movementComponent->ServerSetJetpackingRPC(true);
-		}
 		movementComponent->SetJetpacking(true);
 	}
 
@@ -1114,10 +1340,6 @@ void AShooterCharacter::OnStopJump()
 	UShooterCharacterMovement* movementComponent = Cast<UShooterCharacterMovement>(GetCharacterMovement());
 	if(movementComponent)
 	{
-		if(!HasAuthority())
-		{
-			movementComponent->ServerSetJetpackingRPC(false);
-		}
 		movementComponent->SetJetpacking(false);
 	}
 }
@@ -1130,10 +1352,6 @@ void AShooterCharacter::TeleportPressed()
 	UShooterCharacterMovement* movementComponent = Cast<UShooterCharacterMovement>(GetCharacterMovement());
 	if(movementComponent)
 	{
-		if(!HasAuthority())
-		{
-			movementComponent->ServerSetTeleportingRPC(true);
-		}
 		movementComponent->SetTeleporting(true);
 	}
 }
@@ -1144,10 +1362,6 @@ void AShooterCharacter::TeleportReleased()
 	UShooterCharacterMovement* movementComponent = Cast<UShooterCharacterMovement>(GetCharacterMovement());
 	if(movementComponent)
 	{
-		if(!HasAuthority())
-		{
-			movementComponent->ServerSetTeleportingRPC(false);
-		}
 		movementComponent->SetTeleporting(false);
 	}
 }
@@ -1160,10 +1374,6 @@ void AShooterCharacter::RewindPressed()
 	UShooterCharacterMovement* movementComponent = Cast<UShooterCharacterMovement>(GetCharacterMovement());
 	if(movementComponent)
 	{
-		if(!HasAuthority())
-		{
-			movementComponent->ServerSetRewindingRPC(true);
-		}
 		movementComponent->SetRewinding(true);
 	}
 }
@@ -1177,6 +1387,10 @@ void AShooterCharacter::RewindReleased()
 
 void AShooterCharacter::Tick(float DeltaSeconds)
 {
+#if STATS
+	FShooterSignificanceTickScope SignificanceScope(this, UShooterSignificanceManager::ETickType::Actor);
+#endif
+
 	Super::Tick(DeltaSeconds);
 
 	if (bWantsToRunToggled && !IsRunning())
@@ -1196,7 +1410,8 @@ void AShooterCharacter::Tick(float DeltaSeconds)
 		}
 	}
 
-	if (GEngine->UseSound())
+	// culled characters skip looping sounds, see SetSignificance
+	if (GEngine->UseSound() && Significance != EShooterSignificance::Culled)
 	{
 		if (LowHealthSound)
 		{
@@ -1224,20 +1439,9 @@ void AShooterCharacter::Tick(float DeltaSeconds)
 		UpdateRunSounds();
 	}
 
-	const APlayerController* PC = Cast<APlayerController>(GetController());
-	const bool bLocallyControlled = (PC ? PC->IsLocalController() : false);
-	const uint32 UniqueID = GetUniqueID();
-	FAudioThread::RunCommandOnAudioThread([UniqueID, bLocallyControlled]()
-	{
-	    USoundNodeLocalPlayer::GetLocallyControlledActorCache().Add(UniqueID, bLocallyControlled);
-	});
-	
-	TArray<FVector> PointsToTest;
-	BuildPauseReplicationCheckPoints(PointsToTest);
-
 	if (NetVisualizeRelevancyTestPoints == 1)
 	{
-		for (FVector PointToTest : PointsToTest)
+		for (const FVector& PointToTest : GetPauseReplicationCheckPoints())
 		{
 			DrawDebugSphere(GetWorld(), PointToTest, 10.0f, 8, FColor::Red);
 		}
@@ -1250,11 +1454,7 @@ void AShooterCharacter::BeginDestroy()
 
 	if (!GExitPurge)
 	{
-		const uint32 UniqueID = GetUniqueID();
-		FAudioThread::RunCommandOnAudioThread([UniqueID]()
-		{
-			USoundNodeLocalPlayer::GetLocallyControlledActorCache().Remove(UniqueID);
-		});
+		USoundNodeLocalPlayer::RemoveLocallyControlled(GetUniqueID());
 	}
 }
 
@@ -1285,6 +1485,8 @@ void AShooterCharacter::GetLifetimeReplicatedProps(TArray< FLifetimeProperty > &
 	// everyone
 	DOREPLIFETIME(AShooterCharacter, CurrentWeapon);
 	DOREPLIFETIME(AShooterCharacter, Health);
+	DOREPLIFETIME(AShooterCharacter, PoolGeneration);
+	DOREPLIFETIME_CONDITION(AShooterCharacter, bPooled, COND_InitialOnly);
 }
 
 bool AShooterCharacter::IsReplicationPausedForConnection(const FNetViewer& ConnectionOwnerNetViewer)
@@ -1294,25 +1496,9 @@ bool AShooterCharacter::IsReplicationPausedForConnection(const FNetViewer& Conne
 		APlayerController* PC = Cast<APlayerController>(ConnectionOwnerNetViewer.InViewer);
 		check(PC);
 
-		FVector ViewLocation;
-		FRotator ViewRotation;
-		PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
-
-		FCollisionQueryParams CollisionParams(SCENE_QUERY_STAT(LineOfSight), true, PC->GetPawn());
-		CollisionParams.AddIgnoredActor(this);
-
-		TArray<FVector> PointsToTest;
-		BuildPauseReplicationCheckPoints(PointsToTest);
-
-		for (FVector PointToTest : PointsToTest)
-		{
-			if (!GetWorld()->LineTraceTestByChannel(PointToTest, ViewLocation, ECC_Visibility, CollisionParams))
-			{
-				return false;
-			}
-		}
-
-		return true;
+		// line of sight is traced on a per frame budget by the cache, never here
+		UShooterVisibilityCache* VisibilityCache = UShooterVisibilityCache::Get(this);
+		return VisibilityCache && !VisibilityCache->IsVisible(PC, this);
 	}
 
 	return false;
@@ -1395,25 +1581,71 @@ float AShooterCharacter::GetLowHealthPercentage() const
 
 void AShooterCharacter::UpdateTeamColorsAllMIDs()
 {
+	if (Significance == EShooterSignificance::Culled)
+	{
+		bTeamColorsDirty = true;
+		return;
+	}
+
+	bTeamColorsDirty = false;
 	for (int32 i = 0; i < MeshMIDs.Num(); ++i)
 	{
 		UpdateTeamColors(MeshMIDs[i]);
 	}
 }
 
-void AShooterCharacter::BuildPauseReplicationCheckPoints(TArray<FVector>& RelevancyCheckPoints)
+TArrayView<const FVector> AShooterCharacter::GetPauseReplicationCheckPoints()
+{
+	if (!bPauseReplicationCheckPointsValid)
+	{
+		BuildPauseReplicationCheckPoints();
+		bPauseReplicationCheckPointsValid = true;
+	}
+
+	return MakeArrayView(PauseReplicationCheckPoints, NumPauseReplicationCheckPoints);
+}
+
+void AShooterCharacter::OnCapsuleTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	bPauseReplicationCheckPointsValid = false;
+}
+
+void AShooterCharacter::BuildPauseReplicationCheckPoints()
 {
 	FBoxSphereBounds Bounds = GetCapsuleComponent()->CalcBounds(GetCapsuleComponent()->GetComponentTransform());
 	FBox BoundingBox = Bounds.GetBox();
 	float XDiff = Bounds.BoxExtent.X * 2;
 	float YDiff = Bounds.BoxExtent.Y * 2;
 
-	RelevancyCheckPoints.Add(BoundingBox.Min);
-	RelevancyCheckPoints.Add(FVector(BoundingBox.Min.X + XDiff, BoundingBox.Min.Y, BoundingBox.Min.Z));
-	RelevancyCheckPoints.Add(FVector(BoundingBox.Min.X, BoundingBox.Min.Y + YDiff, BoundingBox.Min.Z));
-	RelevancyCheckPoints.Add(FVector(BoundingBox.Min.X + XDiff, BoundingBox.Min.Y + YDiff, BoundingBox.Min.Z));
-	RelevancyCheckPoints.Add(FVector(BoundingBox.Max.X - XDiff, BoundingBox.Max.Y, BoundingBox.Max.Z));
-	RelevancyCheckPoints.Add(FVector(BoundingBox.Max.X, BoundingBox.Max.Y - YDiff, BoundingBox.Max.Z));
-	RelevancyCheckPoints.Add(FVector(BoundingBox.Max.X - XDiff, BoundingBox.Max.Y - YDiff, BoundingBox.Max.Z));
-	RelevancyCheckPoints.Add(BoundingBox.Max);
-}
\ No newline at end of file
+	PauseReplicationCheckPoints[0] = BoundingBox.Min;
+	PauseReplicationCheckPoints[1] = FVector(BoundingBox.Min.X + XDiff, BoundingBox.Min.Y, BoundingBox.Min.Z);
+	PauseReplicationCheckPoints[2] = FVector(BoundingBox.Min.X, BoundingBox.Min.Y + YDiff, BoundingBox.Min.Z);
+	PauseReplicationCheckPoints[3] = FVector(BoundingBox.Min.X + XDiff, BoundingBox.Min.Y + YDiff, BoundingBox.Min.Z);
+	PauseReplicationCheckPoints[4] = FVector(BoundingBox.Max.X - XDiff, BoundingBox.Max.Y, BoundingBox.Max.Z);
+	PauseReplicationCheckPoints[5] = FVector(BoundingBox.Max.X, BoundingBox.Max.Y - YDiff, BoundingBox.Max.Z);
+	PauseReplicationCheckPoints[6] = FVector(BoundingBox.Max.X - XDiff, BoundingBox.Max.Y - YDiff, BoundingBox.Max.Z);
+	PauseReplicationCheckPoints[7] = BoundingBox.Max;
+}
+
+void AShooterCharacter::SetSignificance(EShooterSignificance::Type NewSignificance)
+{
+	const EShooterSignificance::Type OldSignificance = Significance;
+	Significance = NewSignificance;
+
+	if (NewSignificance == EShooterSignificance::Culled && OldSignificance != EShooterSignificance::Culled)
+	{
+		// nobody can see or hear it, stop looping sounds until it matters again
+		if (LowHealthWarningPlayer && LowHealthWarningPlayer->IsPlaying())
+		{
+			LowHealthWarningPlayer->Stop();
+		}
+		if (RunLoopAC && RunLoopAC->IsActive())
+		{
+			RunLoopAC->Stop();
+		}
+	}
+	else if (NewSignificance != EShooterSignificance::Culled && bTeamColorsDirty)
+	{
+		UpdateTeamColorsAllMIDs();
+	}
+}
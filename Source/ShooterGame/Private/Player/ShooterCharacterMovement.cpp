@@ -2,6 +2,13 @@
 
 #include "ShooterGame.h"
 #include "Player/ShooterCharacterMovement.h"
+#include "Player/ShooterSignificanceManager.h"
+
+DECLARE_MEMORY_STAT(TEXT("Rewind History Memory"), STAT_ShooterRewindHistoryMemory, STATGROUP_ShooterGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Rewind History Buffers"), STAT_ShooterRewindHistoryBuffers, STATGROUP_ShooterGame);
+
+// Fuel burned every tick, also the tolerance for combining saved moves
+static const float JetpackFuelDrainPerTick = 0.005f;
 
 //----------------------------------------------------------------------//
 // UPawnMovementComponent
@@ -35,8 +42,26 @@ float UShooterCharacterMovement::GetMaxSpeed() const
 	return MaxSpeed;
 }
 
+void UShooterCharacterMovement::InitializeComponent()
+{
+    Super::InitializeComponent();
+
+    AllocateRewindHistory();
+}
+
+void UShooterCharacterMovement::UninitializeComponent()
+{
+    ReleaseRewindHistory();
+
+    Super::UninitializeComponent();
+}
+
 void UShooterCharacterMovement::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
 {
+#if STATS
+	FShooterSignificanceTickScope SignificanceScope(this, UShooterSignificanceManager::ETickType::Movement);
+#endif
+
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
     // Jetpack Resets
@@ -47,7 +72,7 @@ void UShooterCharacterMovement::TickComponent(float DeltaTime, enum ELevelTick T
 
     if(fCurrentFuel >= 0)
     {
-        fCurrentFuel = FMath::Clamp<float>(fCurrentFuel - .005f, 0, 1);
+        fCurrentFuel = FMath::Clamp<float>(fCurrentFuel - JetpackFuelDrainPerTick, 0, 1);
     }
 
     // Rewind Tracking
@@ -69,25 +94,14 @@ void UShooterCharacterMovement::TickComponent(float DeltaTime, enum ELevelTick T
     // Record movement for rewind
     if(!bWantsToRewind)
     {
-
-        FVector tempLocation, tempVelocity;
-        FRotator tempRotation;
-
         ACharacter* currentChar = UCharacterMovementComponent::GetCharacterOwner();
 
-        tempLocation = currentChar->GetActorLocation();
-        tempVelocity = Velocity;
-        tempRotation = currentChar->GetControlRotation();
+        FShooterRewindSample Sample;
+        Sample.Location = currentChar->GetActorLocation();
+        Sample.Velocity = Velocity;
+        Sample.Rotation = currentChar->GetControlRotation();
 
-        aActorLocation.Add(tempLocation);
-        aActorVelocity.Add(tempVelocity);
-        aActorRotation.Add(tempRotation);
-
-        // Attempt at garbage collection
-        tempLocation.Set(NULL, NULL, NULL);
-        tempVelocity.Set(NULL, NULL, NULL);
-        tempRotation = FRotator(NULL, NULL, NULL);
-        
+        PushRewindSample(Sample);
     }
 
 }
@@ -233,50 +247,13 @@ UShooterCharacterMovement::GetPredictionData_Client() const
     return ClientPredictionData;
 }
 
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-bool UShooterCharacterMovement::ServerSetJetpackingRPC_Validate(bool wantsToJetpack)
-{
-    return true;
-}
-void UShooterCharacterMovement::ServerSetJetpackingRPC_Implementation(bool wantsToJetpack)
-{
-    execSetJetpacking(wantsToJetpack);
-}
-
-bool UShooterCharacterMovement::ServerSetTeleportingRPC_Validate(bool wantsToTeleport)
-{
-    return true;
-}
-void UShooterCharacterMovement::ServerSetTeleportingRPC_Implementation(bool wantsToTeleport)
-{
-    execSetTeleporting(wantsToTeleport);
-}
-
-bool UShooterCharacterMovement::ServerSetRewindingRPC_Validate(bool wantsToRewind)
-{
-    return true;
-}
-void UShooterCharacterMovement::ServerSetRewindingRPC_Implementation(bool wantsToRewind)
-{
-    execSetRewinding(wantsToRewind);
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-void UShooterCharacterMovement::ClientSetJetpackingRPC_Implementation(bool wantsToJetpack)
+void UShooterCharacterMovement::UpdateFromCompressedFlags(uint8 Flags)
 {
-    execSetJetpacking(wantsToJetpack);
-}
+    Super::UpdateFromCompressedFlags(Flags);
 
-void UShooterCharacterMovement::ClientSetTeleportingRPC_Implementation(bool wantsToTeleport)
-{
-    execSetTeleporting(wantsToTeleport);
-}
-
-void UShooterCharacterMovement::ClientSetRewindingRPC_Implementation(bool wantsToRewind)
-{
-    execSetRewinding(wantsToRewind);
+    execSetJetpacking((Flags & FSavedMove_ShooterCharacterMovement::FLAG_WantsToJetpack) != 0);
+    execSetTeleporting((Flags & FSavedMove_ShooterCharacterMovement::FLAG_WantsToTeleport) != 0);
+    execSetRewinding((Flags & FSavedMove_ShooterCharacterMovement::FLAG_WantsToRewind) != 0);
 }
 
 //------------------------------------------------------
@@ -289,6 +266,25 @@ bool UShooterCharacterMovement::VerifyCustomMovementMode(uint8 currentMode) cons
     return false;
 }
 
+void UShooterCharacterMovement::ResetForReuse()
+{
+    bWantsToJetpack = false;
+    bWantsToTeleport = false;
+    bIsTeleporting = false;
+    bInAir = false;
+    bWantsToRewind = false;
+    bIsRewinding = false;
+
+    fCurrentFuel = JetpackMaxFuel;
+    fRemainingDuration = RewindDuration;
+    fRemainingResetDuration = 0;
+
+    iRewindHistoryHead = 0;
+    iRewindHistoryCount = 0;
+
+    SetDefaultMovementMode();
+}
+
 void UShooterCharacterMovement::ToggleGravityScale(bool gravityActive)
 {
     if(gravityActive)
@@ -355,22 +351,6 @@ void UShooterCharacterMovement::SetJetpacking(bool wantsToJetpack)
     }
 
     ToggleGravityScale(wantsToJetpack);
-
-
-    // - - - - - - - - - Network Elements - - - - - - - - - - - - -
-
-    if(!GetOwner() || !GetPawnOwner())
-    {return;}
-
-    if(!GetOwner()->HasAuthority() && GetPawnOwner()->IsLocallyControlled())
-    {
-        ServerSetJetpackingRPC(bWantsToJetpack);
-    }
-    else if(GetOwner()->HasAuthority() && !GetPawnOwner()->IsLocallyControlled())
-    {
-        ClientSetJetpackingRPC(bWantsToJetpack);
-    }
-
 }
 
 bool UShooterCharacterMovement::IsJetpacking()
@@ -463,20 +443,6 @@ void UShooterCharacterMovement::SetTeleporting(bool wantsToTeleport)
 	{
 		bIsTeleporting = false;
 	}
-
-    // - - - - - - - - - Network Elements - - - - - - - - - - - - -
-
-    if(!GetOwner() || !GetPawnOwner())
-    {return;}
-
-    if(!GetOwner()->HasAuthority() && GetPawnOwner()->IsLocallyControlled())
-    {
-        ServerSetTeleportingRPC(bWantsToTeleport);
-    }
-    else if(GetOwner()->HasAuthority() && !GetPawnOwner()->IsLocallyControlled())
-    {
-        ClientSetTeleportingRPC(bWantsToTeleport);
-    }
 }
 
 bool UShooterCharacterMovement::IsTeleporting()
@@ -525,39 +491,96 @@ void UShooterCharacterMovement::PhysRewind(float deltaTime, int32 Iterations)
     currentChar->GetController()->SetIgnoreLookInput(true);
 
 
-    // Get most recent position and details
-    FVector tempLocation = aActorLocation.Last();
-    FVector tempVelocity = aActorVelocity.Last();
-    FRotator tempRotation = aActorRotation.Last();
+    // Get most recent position and details, keeping the oldest sample as the final resting point
+    FShooterRewindSample Sample;
+    if(iRewindHistoryCount > 1)
+    {
+        PopRewindSample(Sample);
+    }
+    else if(iRewindHistoryCount == 1)
+    {
+        Sample = aRewindHistory[iRewindHistoryHead];
+        bWantsToRewind = false;
+    }
+    else
+    {
+        bWantsToRewind = false;
+        return;
+    }
 
     // Set location, velocity, and camera rotation to previous value
-    currentChar->GetCapsuleComponent()->USceneComponent::SetWorldLocation(tempLocation, false, 0, ETeleportType::None);
-    Velocity = tempVelocity;
-    //thisCharacterCameraManager->SetActorRotation(tempRotation, ETeleportType::None);
-    //currentChar->GetController()->SetControlRotation(tempRotation);
-    GetPawnOwner()->Controller->SetControlRotation(tempRotation);
-
-    // Remove last value from list
-    if(aActorLocation.Num()-1 > 0) 
-    {aActorLocation.RemoveAt(aActorLocation.Num()-1);}
-    else
-    {bWantsToRewind = false;}
+    currentChar->GetCapsuleComponent()->USceneComponent::SetWorldLocation(Sample.Location, false, 0, ETeleportType::None);
+    Velocity = Sample.Velocity;
+    //thisCharacterCameraManager->SetActorRotation(Sample.Rotation, ETeleportType::None);
+    //currentChar->GetController()->SetControlRotation(Sample.Rotation);
+    GetPawnOwner()->Controller->SetControlRotation(Sample.Rotation);
+}
 
-    if(aActorVelocity.Num()-1 > 0)
-    {aActorVelocity.RemoveAt(aActorVelocity.Num()-1);}
-    else
-    {bWantsToRewind = false;}
+void UShooterCharacterMovement::AllocateRewindHistory()
+{
+    ReleaseRewindHistory();
+
+    // One sample is consumed per rewind tick, so a full rewind never needs more than this many
+    const float TickValue = FMath::Max(RewindTickValue, KINDA_SMALL_NUMBER);
+    const int32 Capacity = FMath::Clamp(FMath::CeilToInt(RewindDuration / TickValue), 1, FMath::Max(MaxRewindHistorySamples, 1));
+
+    aRewindHistory.SetNumUninitialized(Capacity);
+    iRewindHistoryHead = 0;
+    iRewindHistoryCount = 0;
+
+    INC_MEMORY_STAT_BY(STAT_ShooterRewindHistoryMemory, aRewindHistory.GetAllocatedSize());
+    INC_DWORD_STAT(STAT_ShooterRewindHistoryBuffers);
+}
+
+void UShooterCharacterMovement::ReleaseRewindHistory()
+{
+    if(aRewindHistory.Num() > 0)
+    {
+        DEC_MEMORY_STAT_BY(STAT_ShooterRewindHistoryMemory, aRewindHistory.GetAllocatedSize());
+        DEC_DWORD_STAT(STAT_ShooterRewindHistoryBuffers);
+    }
+
+    aRewindHistory.Empty();
+    iRewindHistoryHead = 0;
+    iRewindHistoryCount = 0;
+}
 
-    if(aActorRotation.Num()-1 > 0)
-    {aActorRotation.RemoveAt(aActorRotation.Num()-1);}
+void UShooterCharacterMovement::PushRewindSample(const FShooterRewindSample& Sample)
+{
+    const int32 Capacity = aRewindHistory.Num();
+    if(Capacity == 0)
+    {
+        return;
+    }
+
+    if(iRewindHistoryCount < Capacity)
+    {
+        aRewindHistory[(iRewindHistoryHead + iRewindHistoryCount) % Capacity] = Sample;
+        iRewindHistoryCount++;
+    }
     else
-    {bWantsToRewind = false;}
+    {
+        // Full, overwrite the oldest sample and advance the head past it
+        aRewindHistory[iRewindHistoryHead] = Sample;
+        iRewindHistoryHead = (iRewindHistoryHead + 1) % Capacity;
+    }
+}
 
-    // Attempt at garbage collection
-        tempLocation.Set(NULL, NULL, NULL);
-        tempVelocity.Set(NULL, NULL, NULL);
-        tempRotation = FRotator(NULL, NULL, NULL);
+bool UShooterCharacterMovement::PopRewindSample(FShooterRewindSample& OutSample)
+{
+    if(iRewindHistoryCount == 0)
+    {
+        return false;
+    }
 
+    iRewindHistoryCount--;
+    OutSample = aRewindHistory[(iRewindHistoryHead + iRewindHistoryCount) % aRewindHistory.Num()];
+    return true;
+}
+
+SIZE_T UShooterCharacterMovement::GetRewindHistoryAllocatedSize() const
+{
+    return aRewindHistory.GetAllocatedSize();
 }
 
 void UShooterCharacterMovement::execSetRewinding(bool wantsToRewind)
@@ -590,20 +613,6 @@ void UShooterCharacterMovement::SetRewinding(bool wantsToRewind)
 	{
 		bIsRewinding = false;
 	}
-
-    // - - - - - - - - - Network Elements - - - - - - - - - - - - -
-
-    if(!GetOwner() || !GetPawnOwner())
-    {return;}
-
-    if(!GetOwner()->HasAuthority() && GetPawnOwner()->IsLocallyControlled())
-    {
-        ServerSetRewindingRPC(bWantsToRewind);
-    }
-    else if(GetOwner()->HasAuthority() && !GetPawnOwner()->IsLocallyControlled())
-    {
-        ClientSetRewindingRPC(bWantsToRewind);
-    }
 }
 
 bool UShooterCharacterMovement::IsRewinding()
@@ -630,6 +639,19 @@ FSavedMovePtr FNetworkPredictionData_Client_ShooterCharacterMovement::AllocateNe
     return FSavedMovePtr(new FSavedMove_ShooterCharacterMovement());
 }
 
+// Combining only needs enough precision to tell ticks apart, 8 bits of the max value is plenty
+static uint8 QuantizeMoveValue(float Value, float MaxValue)
+{
+    return MaxValue > 0.0f ? (uint8)FMath::Clamp(FMath::RoundToInt(Value / MaxValue * 255.0f), 0, 255) : 0;
+}
+
+// Values one tick apart can be more than one step apart, so moves combine while they differ by at most one tick's change
+static bool IsWithinOneTick(float Value, float OtherValue, float ChangePerTick, float MaxValue)
+{
+    const int32 Tolerance = MaxValue > 0.0f ? FMath::CeilToInt(ChangePerTick / MaxValue * 255.0f) : 0;
+    return FMath::Abs((int32)QuantizeMoveValue(Value, MaxValue) - (int32)QuantizeMoveValue(OtherValue, MaxValue)) <= Tolerance;
+}
+
 void FSavedMove_ShooterCharacterMovement::Clear()
 {
     Super::Clear();
@@ -644,22 +666,42 @@ void FSavedMove_ShooterCharacterMovement::Clear()
 
 uint8 FSavedMove_ShooterCharacterMovement::GetCompressedFlags() const
 {
-    return Super::GetCompressedFlags();
+    uint8 Result = Super::GetCompressedFlags();
+
+    if(savedWantsToJetpack)
+    {
+        Result |= FLAG_WantsToJetpack;
+    }
+    if(savedWantsToTeleport)
+    {
+        Result |= FLAG_WantsToTeleport;
+    }
+    if(savedWantsToRewind)
+    {
+        Result |= FLAG_WantsToRewind;
+    }
+
+    return Result;
 }
 
 bool FSavedMove_ShooterCharacterMovement::CanCombineWith(const FSavedMovePtr & NewMove, ACharacter * Character, float MaxDelta) const
 {
-    if(savedWantsToJetpack != ((FSavedMove_ShooterCharacterMovement*)&NewMove)->savedWantsToJetpack)
-    {return false;}
-    if(savedRemainingFuel != ((FSavedMove_ShooterCharacterMovement*)&NewMove)->savedRemainingFuel)
-    {return false;}
-    if(savedWantsToTeleport != ((FSavedMove_ShooterCharacterMovement*)&NewMove)->savedWantsToTeleport)
-    {return false;}
-    if(savedWantsToRewind != ((FSavedMove_ShooterCharacterMovement*)&NewMove)->savedWantsToRewind)
-    {return false;}
-    if(savedRemainingDuration != ((FSavedMove_ShooterCharacterMovement*)&NewMove)->savedRemainingDuration)
+    const FSavedMove_ShooterCharacterMovement* NewShooterMove = static_cast<const FSavedMove_ShooterCharacterMovement*>(NewMove.Get());
+
+    // Matching wants-flags with fuel/duration within a tick of each other replay close enough to be sent as one
+    const uint8 CustomFlagsMask = FLAG_WantsToJetpack | FLAG_WantsToTeleport | FLAG_WantsToRewind;
+    if((GetCompressedFlags() & CustomFlagsMask) != (NewShooterMove->GetCompressedFlags() & CustomFlagsMask))
     {return false;}
 
+    const UShooterCharacterMovement* CharacterMovement = Cast<UShooterCharacterMovement>(Character->GetCharacterMovement());
+    if(CharacterMovement)
+    {
+        if(!IsWithinOneTick(savedRemainingFuel, NewShooterMove->savedRemainingFuel, JetpackFuelDrainPerTick, CharacterMovement->JetpackMaxFuel))
+        {return false;}
+        if(!IsWithinOneTick(savedRemainingDuration, NewShooterMove->savedRemainingDuration, CharacterMovement->RewindTickValue, CharacterMovement->RewindDuration))
+        {return false;}
+    }
+
     return Super::CanCombineWith(NewMove, Character, MaxDelta);
 }
 
@@ -693,4 +735,4 @@ void FSavedMove_ShooterCharacterMovement::PrepMoveFor(ACharacter * Character)
         CharacterMovement->bWantsToRewind = savedWantsToRewind;
         CharacterMovement->fRemainingDuration = savedRemainingDuration;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,84 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Player/ShooterCorpse.h"
+
+AShooterCorpse::AShooterCorpse(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	Mesh = ObjectInitializer.CreateDefaultSubobject<USkeletalMeshComponent>(this, TEXT("CorpseMesh"));
+	RootComponent = Mesh;
+	Mesh->bReceivesDecals = false;
+	Mesh->bBlendPhysics = true;
+	Mesh->SetGenerateOverlapEvents(false);
+	Mesh->SetCollisionProfileName(TEXT("Ragdoll"));
+
+	PrimaryActorTick.bCanEverTick = false;
+	bReplicates = false;
+}
+
+void AShooterCorpse::InitFromPawn(AShooterCharacter* Pawn, float LifeSpan)
+{
+	USkeletalMeshComponent* PawnMesh = Pawn->GetMesh();
+
+	Mesh->SetSimulatePhysics(false);
+	Mesh->SetWorldTransform(PawnMesh->GetComponentTransform(), false, nullptr, ETeleportType::ResetPhysics);
+	Mesh->SetSkeletalMesh(PawnMesh->SkeletalMesh, false);
+	Mesh->SetPhysicsAsset(PawnMesh->GetPhysicsAsset());
+
+	// own copies of the team color instances, the pawn may be reused by another team while the corpse is around
+	const int32 NumMaterials = PawnMesh->GetNumMaterials();
+	MeshMIDs.SetNum(NumMaterials);
+	for (int32 iMat = 0; iMat < NumMaterials; iMat++)
+	{
+		UMaterialInterface* PawnMaterial = PawnMesh->GetMaterial(iMat);
+		UMaterialInstanceDynamic* PawnMID = Cast<UMaterialInstanceDynamic>(PawnMaterial);
+		if (PawnMID == nullptr)
+		{
+			Mesh->SetMaterial(iMat, PawnMaterial);
+			continue;
+		}
+
+		UMaterialInstanceDynamic*& MID = MeshMIDs[iMat];
+		if (MID == nullptr || MID->Parent != PawnMID->Parent)
+		{
+			MID = UMaterialInstanceDynamic::Create(PawnMID->Parent, this);
+		}
+
+		MID->CopyParameterOverrides(PawnMID);
+		Mesh->SetMaterial(iMat, MID);
+	}
+
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+
+	// start the bodies from the pose the pawn died in
+	const TArray<FTransform>& PawnPose = PawnMesh->GetComponentSpaceTransforms();
+	if (PawnPose.Num() == Mesh->GetComponentSpaceTransforms().Num())
+	{
+		Mesh->UpdateKinematicBonesToAnim(PawnPose, ETeleportType::TeleportPhysics, true);
+	}
+
+	Mesh->SetSimulatePhysics(true);
+	Mesh->WakeAllRigidBodies();
+	Mesh->SetAllPhysicsLinearVelocity(Pawn->GetVelocity());
+
+	SetLifeSpan(LifeSpan);
+}
+
+void AShooterCorpse::Deactivate()
+{
+	SetLifeSpan(0.0f);
+	Mesh->SetSimulatePhysics(false);
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+}
+
+bool AShooterCorpse::IsActive() const
+{
+	return !IsHidden();
+}
+
+void AShooterCorpse::LifeSpanExpired()
+{
+	Deactivate();
+}
@@ -0,0 +1,284 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Player/ShooterPawnSpatialIndex.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pawn Index Rebuild"), STAT_ShooterPawnIndexRebuild, STATGROUP_ShooterGame);
+DECLARE_CYCLE_STAT(TEXT("Pawn Index Query"), STAT_ShooterPawnIndexQuery, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pawn Index Entries"), STAT_ShooterPawnIndexEntries, STATGROUP_ShooterGame);
+
+static float PawnIndexCellSize = 2000.0f;
+FAutoConsoleVariableRef CVarPawnIndexCellSize(
+	TEXT("ShooterGame.PawnIndex.CellSize"),
+	PawnIndexCellSize,
+	TEXT("Size of the pawn spatial index grid cells, in uu."),
+	ECVF_Default);
+
+UShooterPawnSpatialIndex::UShooterPawnSpatialIndex(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	MinCell = FIntPoint::ZeroValue;
+	MaxCell = FIntPoint::ZeroValue;
+	CellSize = PawnIndexCellSize;
+}
+
+UShooterPawnSpatialIndex* UShooterPawnSpatialIndex::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UShooterPawnSpatialIndex>() : nullptr;
+}
+
+bool UShooterPawnSpatialIndex::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UShooterPawnSpatialIndex::Deinitialize()
+{
+	RegisteredPawns.Empty();
+	Entries.Empty();
+	CellRanges.Empty();
+
+	Super::Deinitialize();
+}
+
+void UShooterPawnSpatialIndex::RegisterPawn(AShooterCharacter* Pawn)
+{
+	if (Pawn)
+	{
+		RegisteredPawns.AddUnique(Pawn);
+	}
+}
+
+void UShooterPawnSpatialIndex::UnregisterPawn(AShooterCharacter* Pawn)
+{
+	RegisteredPawns.RemoveSingleSwap(Pawn, false);
+
+	// the snapshot must not hand out the pawn until the next rebuild, it may be garbage collected before then
+	for (FPawnEntry& Entry : Entries)
+	{
+		if (Entry.Pawn == Pawn)
+		{
+			Entry.Pawn = nullptr;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Rebuild
+
+void UShooterPawnSpatialIndex::Tick(float DeltaTime)
+{
+	Rebuild();
+}
+
+bool UShooterPawnSpatialIndex::IsTickable() const
+{
+	return RegisteredPawns.Num() > 0 || Entries.Num() > 0;
+}
+
+TStatId UShooterPawnSpatialIndex::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterPawnSpatialIndex, STATGROUP_Tickables);
+}
+
+UWorld* UShooterPawnSpatialIndex::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+FIntPoint UShooterPawnSpatialIndex::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void UShooterPawnSpatialIndex::Rebuild()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterPawnIndexRebuild);
+
+	CellSize = FMath::Max(100.0f, PawnIndexCellSize);
+
+	Entries.Reset();
+	CellRanges.Reset();
+
+	for (int32 i = RegisteredPawns.Num() - 1; i >= 0; i--)
+	{
+		AShooterCharacter* Pawn = RegisteredPawns[i].Get();
+		if (Pawn == nullptr)
+		{
+			RegisteredPawns.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		if (Pawn->IsAlive())
+		{
+			FPawnEntry& Entry = Entries.AddDefaulted_GetRef();
+			Entry.Pawn = Pawn;
+			Entry.Location = Pawn->GetActorLocation();
+		}
+	}
+
+	// group entries by cell so every cell is one contiguous range
+	Entries.Sort([this](const FPawnEntry& A, const FPawnEntry& B)
+	{
+		const FIntPoint CellA = GetCell(A.Location);
+		const FIntPoint CellB = GetCell(B.Location);
+		return CellA.X != CellB.X ? CellA.X < CellB.X : CellA.Y < CellB.Y;
+	});
+
+	MinCell = FIntPoint(MAX_int32, MAX_int32);
+	MaxCell = FIntPoint(MIN_int32, MIN_int32);
+
+	for (int32 i = 0; i < Entries.Num(); i++)
+	{
+		const FIntPoint Cell = GetCell(Entries[i].Location);
+		TPair<int32, int32>* Range = CellRanges.Find(Cell);
+		if (Range)
+		{
+			Range->Value++;
+		}
+		else
+		{
+			CellRanges.Add(Cell, TPair<int32, int32>(i, 1));
+		}
+
+		MinCell = MinCell.ComponentMin(Cell);
+		MaxCell = MaxCell.ComponentMax(Cell);
+	}
+
+	SET_DWORD_STAT(STAT_ShooterPawnIndexEntries, Entries.Num());
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Queries
+
+template<typename VisitorType, typename RingFilterType>
+void UShooterPawnSpatialIndex::VisitRings(const FVector& Origin, int32 MaxRing, RingFilterType&& ShouldVisitRing, VisitorType&& Visitor) const
+{
+	if (Entries.Num() == 0)
+	{
+		return;
+	}
+
+	const FIntPoint OriginCell = GetCell(Origin);
+
+	// no occupied cell lies further away than this
+	const int32 OccupiedRing = FMath::Max(
+		FMath::Max(FMath::Abs(MinCell.X - OriginCell.X), FMath::Abs(MaxCell.X - OriginCell.X)),
+		FMath::Max(FMath::Abs(MinCell.Y - OriginCell.Y), FMath::Abs(MaxCell.Y - OriginCell.Y)));
+	const int32 LastRing = MaxRing >= 0 ? FMath::Min(MaxRing, OccupiedRing) : OccupiedRing;
+
+	for (int32 Ring = 0; Ring <= LastRing; Ring++)
+	{
+		// every cell in the ring is at least this far from the origin
+		const float RingMinDist = FMath::Max(0, Ring - 1) * CellSize;
+		if (!ShouldVisitRing(RingMinDist * RingMinDist))
+		{
+			return;
+		}
+
+		for (int32 X = OriginCell.X - Ring; X <= OriginCell.X + Ring; X++)
+		{
+			// only the border of the square is in this ring
+			const bool bEdgeColumn = (X == OriginCell.X - Ring || X == OriginCell.X + Ring);
+			const int32 YStep = bEdgeColumn ? 1 : FMath::Max(1, Ring * 2);
+
+			for (int32 Y = OriginCell.Y - Ring; Y <= OriginCell.Y + Ring; Y += YStep)
+			{
+				const TPair<int32, int32>* Range = CellRanges.Find(FIntPoint(X, Y));
+				if (Range == nullptr)
+				{
+					continue;
+				}
+
+				for (int32 i = Range->Key; i < Range->Key + Range->Value; i++)
+				{
+					const FPawnEntry& Entry = Entries[i];
+					if (Entry.Pawn && !Visitor(Entry))
+					{
+						return;
+					}
+				}
+			}
+		}
+	}
+}
+
+void UShooterPawnSpatialIndex::FindNearestEnemies(AController* Querier, const FVector& Origin, float MaxRadius, int32 MaxResults, FShooterPawnQueryResults& OutResults) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterPawnIndexQuery);
+
+	OutResults.Reset();
+
+	const float MaxDistSq = MaxRadius > 0.0f ? FMath::Square(MaxRadius) : MAX_FLT;
+	const int32 MaxRing = MaxRadius > 0.0f ? FMath::CeilToInt(MaxRadius / CellSize) + 1 : -1;
+
+	auto ShouldVisitRing = [&OutResults, MaxDistSq, MaxResults](float RingMinDistSq)
+	{
+		if (RingMinDistSq > MaxDistSq)
+		{
+			return false;
+		}
+
+		// once we have enough results, stop at the first ring that can't beat the furthest of them
+		if (MaxResults > 0 && OutResults.Num() >= MaxResults)
+		{
+			float WorstDistSq = 0.0f;
+			for (const FShooterPawnQueryResult& Result : OutResults)
+			{
+				WorstDistSq = FMath::Max(WorstDistSq, Result.DistSq);
+			}
+			return RingMinDistSq < WorstDistSq;
+		}
+
+		return true;
+	};
+
+	VisitRings(Origin, MaxRing, ShouldVisitRing, [&](const FPawnEntry& Entry)
+	{
+		const float DistSq = FVector::DistSquared(Entry.Location, Origin);
+		if (DistSq <= MaxDistSq && Entry.Pawn->IsAlive() && Entry.Pawn->IsEnemyFor(Querier))
+		{
+			OutResults.Add({ Entry.Pawn, DistSq });
+		}
+		return true;
+	});
+
+	OutResults.Sort([](const FShooterPawnQueryResult& A, const FShooterPawnQueryResult& B) { return A.DistSq < B.DistSq; });
+	if (MaxResults > 0 && OutResults.Num() > MaxResults)
+	{
+		OutResults.SetNum(MaxResults, false);
+	}
+}
+
+void UShooterPawnSpatialIndex::FindPawnsInRadius(const FVector& Origin, float Radius, FShooterPawnQueryResults& OutResults, bool bSortByDistance) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterPawnIndexQuery);
+
+	OutResults.Reset();
+
+	const float RadiusSq = FMath::Square(Radius);
+	const int32 MaxRing = FMath::CeilToInt(Radius / CellSize) + 1;
+
+	VisitRings(Origin, MaxRing, [RadiusSq](float RingMinDistSq) { return RingMinDistSq <= RadiusSq; }, [&](const FPawnEntry& Entry)
+	{
+		const float DistSq = FVector::DistSquared(Entry.Location, Origin);
+		if (DistSq <= RadiusSq)
+		{
+			OutResults.Add({ Entry.Pawn, DistSq });
+		}
+		return true;
+	});
+
+	if (bSortByDistance)
+	{
+		OutResults.Sort([](const FShooterPawnQueryResult& A, const FShooterPawnQueryResult& B) { return A.DistSq < B.DistSq; });
+	}
+}
+
+float UShooterPawnSpatialIndex::GetNearestEnemyDistSq(AController* Querier, const FVector& Origin) const
+{
+	FShooterPawnQueryResults Results;
+	FindNearestEnemies(Querier, Origin, 0.0f, 1, Results);
+	return Results.Num() > 0 ? Results[0].DistSq : MAX_FLT;
+}
@@ -100,6 +100,8 @@ void AShooterPlayerController::PostInitializeComponents()
 	Super::PostInitializeComponents();
 	FShooterStyle::Initialize();
 	ShooterFriendUpdateTimer = 0;
+
+	USoundNodeLocalPlayer::SetLocallyControlled(GetUniqueID(), IsLocalController());
 }
 
 void AShooterPlayerController::ClearLeaderboardDelegate()
@@ -158,13 +160,6 @@ void AShooterPlayerController::TickActor(float DeltaTime, enum ELevelTick TickTy
 			}
 		}
 	}
-
-	const bool bLocallyControlled = IsLocalController();
-	const uint32 UniqueID = GetUniqueID();
-	FAudioThread::RunCommandOnAudioThread([UniqueID, bLocallyControlled]()
-	{
-		USoundNodeLocalPlayer::GetLocallyControlledActorCache().Add(UniqueID, bLocallyControlled);
-	});
 };
 
 void AShooterPlayerController::BeginDestroy()
@@ -177,11 +172,7 @@ void AShooterPlayerController::BeginDestroy()
 
 	if (!GExitPurge)
 	{
-		const uint32 UniqueID = GetUniqueID();
-		FAudioThread::RunCommandOnAudioThread([UniqueID]()
-		{
-			USoundNodeLocalPlayer::GetLocallyControlledActorCache().Remove(UniqueID);
-		});
+		USoundNodeLocalPlayer::RemoveLocallyControlled(GetUniqueID());
 	}
 }
 
@@ -198,6 +189,8 @@ void AShooterPlayerController::SetPlayer( UPlayer* InPlayer )
 		FInputModeGameOnly InputMode;
 		SetInputMode(InputMode);
 	}
+
+	USoundNodeLocalPlayer::SetLocallyControlled(GetUniqueID(), IsLocalController());
 }
 
 void AShooterPlayerController::QueryAchievements()
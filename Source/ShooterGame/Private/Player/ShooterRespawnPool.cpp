@@ -0,0 +1,219 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Player/ShooterRespawnPool.h"
+#include "Player/ShooterCorpse.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Pawns"), STAT_ShooterPooledPawns, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Free Pooled Pawns"), STAT_ShooterFreePooledPawns, STATGROUP_ShooterGame);
+
+static int32 RespawnPoolEnable = 1;
+FAutoConsoleVariableRef CVarRespawnPoolEnable(
+	TEXT("ShooterGame.RespawnPool.Enable"),
+	RespawnPoolEnable,
+	TEXT("Recycle dead pawns and their weapons on respawn instead of tearing them off and spawning new ones."),
+	ECVF_Default);
+
+static int32 RespawnPoolMaxFreePerClass = 16;
+FAutoConsoleVariableRef CVarRespawnPoolMaxFreePerClass(
+	TEXT("ShooterGame.RespawnPool.MaxFreePerClass"),
+	RespawnPoolMaxFreePerClass,
+	TEXT("Dead pawns kept per class, any more are destroyed."),
+	ECVF_Default);
+
+static int32 RespawnPoolMaxCorpses = 16;
+FAutoConsoleVariableRef CVarRespawnPoolMaxCorpses(
+	TEXT("ShooterGame.RespawnPool.MaxCorpses"),
+	RespawnPoolMaxCorpses,
+	TEXT("Ragdolls kept around at once, the oldest one is reused for a new death past this."),
+	ECVF_Default);
+
+static float RespawnPoolCorpseLifeSpan = 10.0f;
+FAutoConsoleVariableRef CVarRespawnPoolCorpseLifeSpan(
+	TEXT("ShooterGame.RespawnPool.CorpseLifeSpan"),
+	RespawnPoolCorpseLifeSpan,
+	TEXT("Seconds a ragdoll stays before it's hidden for reuse."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorld RespawnPoolStatsCmd(
+	TEXT("ShooterGame.RespawnPool.Stats"),
+	TEXT("Log respawn pool hit rate and size."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		if (UShooterRespawnPool* Pool = UShooterRespawnPool::Get(World))
+		{
+			Pool->LogStats();
+		}
+	}));
+
+UShooterRespawnPool::UShooterRespawnPool(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	NumAcquired = 0;
+	NumReused = 0;
+	PeakSize = 0;
+}
+
+UShooterRespawnPool* UShooterRespawnPool::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UShooterRespawnPool>() : nullptr;
+}
+
+bool UShooterRespawnPool::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UShooterRespawnPool::Deinitialize()
+{
+	if (NumAcquired > 0)
+	{
+		LogStats();
+	}
+
+	FreePawns.Empty();
+	PooledPawns.Empty();
+	Corpses.Empty();
+
+	Super::Deinitialize();
+}
+
+AShooterCharacter* UShooterRespawnPool::AcquirePawn(UClass* PawnClass, const FTransform& SpawnTM)
+{
+	if (PawnClass == nullptr)
+	{
+		return nullptr;
+	}
+
+	NumAcquired++;
+
+	FShooterFreePawns* FreeEntry = RespawnPoolEnable ? FreePawns.Find(PawnClass) : nullptr;
+	TArray<AShooterCharacter*>* FreeList = FreeEntry ? &FreeEntry->Pawns : nullptr;
+	while (FreeList && FreeList->Num() > 0)
+	{
+		AShooterCharacter* Pawn = FreeList->Pop(false);
+		DEC_DWORD_STAT(STAT_ShooterFreePooledPawns);
+
+		if (!IsValid(Pawn))
+		{
+			continue;
+		}
+
+		Pawn->SetActorTransform(SpawnTM, false, nullptr, ETeleportType::ResetPhysics);
+		Pawn->OnAcquiredFromPool();
+
+		NumReused++;
+		return Pawn;
+	}
+
+	return nullptr;
+}
+
+void UShooterRespawnPool::AddPawn(AShooterCharacter* Pawn)
+{
+	if (!RespawnPoolEnable || !IsValid(Pawn))
+	{
+		return;
+	}
+
+	Pawn->SetPooled();
+	PooledPawns.Add(Pawn);
+	PeakSize = FMath::Max(PeakSize, PooledPawns.Num());
+	INC_DWORD_STAT(STAT_ShooterPooledPawns);
+}
+
+void UShooterRespawnPool::ReleasePawn(AShooterCharacter* Pawn)
+{
+	if (!IsValid(Pawn))
+	{
+		return;
+	}
+
+	TArray<AShooterCharacter*>& FreeList = FreePawns.FindOrAdd(Pawn->GetClass()).Pawns;
+	if (!RespawnPoolEnable || FreeList.Num() >= RespawnPoolMaxFreePerClass || !PooledPawns.Contains(Pawn))
+	{
+		// already hidden and the corpse took over, let the final update reach clients first
+		Pawn->SetLifeSpan(1.0f);
+		return;
+	}
+
+	FreeList.Add(Pawn);
+	INC_DWORD_STAT(STAT_ShooterFreePooledPawns);
+
+	// clients keep their copy while the channel sleeps, it's reopened on the same actor on respawn
+	Pawn->SetNetDormancy(DORM_DormantAll);
+}
+
+void UShooterRespawnPool::NotifyPawnDestroyed(AShooterCharacter* Pawn)
+{
+	if (PooledPawns.Remove(Pawn) > 0)
+	{
+		DEC_DWORD_STAT(STAT_ShooterPooledPawns);
+
+		FShooterFreePawns* FreeEntry = FreePawns.Find(Pawn->GetClass());
+		if (FreeEntry && FreeEntry->Pawns.RemoveSingleSwap(Pawn, false) > 0)
+		{
+			DEC_DWORD_STAT(STAT_ShooterFreePooledPawns);
+		}
+	}
+}
+
+void UShooterRespawnPool::SpawnCorpse(AShooterCharacter* Pawn)
+{
+	USkeletalMeshComponent* PawnMesh = Pawn ? Pawn->GetMesh() : nullptr;
+	if (PawnMesh == nullptr || PawnMesh->GetPhysicsAsset() == nullptr || RespawnPoolMaxCorpses <= 0)
+	{
+		return;
+	}
+
+	// take an expired corpse, or the oldest one once the cap is hit
+	AShooterCorpse* Corpse = nullptr;
+	for (int32 i = 0; i < Corpses.Num(); i++)
+	{
+		if (!IsValid(Corpses[i]))
+		{
+			Corpses.RemoveAt(i--, 1, false);
+		}
+		else if (!Corpses[i]->IsActive())
+		{
+			Corpse = Corpses[i];
+			Corpses.RemoveAt(i, 1, false);
+			break;
+		}
+	}
+
+	if (Corpse == nullptr && Corpses.Num() >= RespawnPoolMaxCorpses)
+	{
+		Corpse = Corpses[0];
+		Corpses.RemoveAt(0, 1, false);
+	}
+
+	if (Corpse == nullptr)
+	{
+		FActorSpawnParameters SpawnInfo;
+		SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnInfo.ObjectFlags |= RF_Transient;
+		Corpse = GetWorld()->SpawnActor<AShooterCorpse>(AShooterCorpse::StaticClass(), PawnMesh->GetComponentTransform(), SpawnInfo);
+		if (Corpse == nullptr)
+		{
+			return;
+		}
+	}
+
+	Corpse->InitFromPawn(Pawn, RespawnPoolCorpseLifeSpan);
+	Corpses.Add(Corpse);
+}
+
+void UShooterRespawnPool::LogStats() const
+{
+	int32 NumFree = 0;
+	for (const TPair<UClass*, FShooterFreePawns>& Pair : FreePawns)
+	{
+		NumFree += Pair.Value.Pawns.Num();
+	}
+
+	const float HitRate = NumAcquired > 0 ? (100.0f * NumReused) / NumAcquired : 0.0f;
+	UE_LOG(LogShooter, Log, TEXT("Respawn pool: %d respawns, %.1f%% reused, %d owned (%d free), peak %d, %d corpses"),
+		NumAcquired, HitRate, PooledPawns.Num(), NumFree, PeakSize, Corpses.Num());
+}
@@ -0,0 +1,344 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Player/ShooterSignificanceManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Significance Update"), STAT_ShooterSignificanceUpdate, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance Full"), STAT_ShooterSignificanceFull, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance Reduced"), STAT_ShooterSignificanceReduced, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance Low"), STAT_ShooterSignificanceLow, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance Culled"), STAT_ShooterSignificanceCulled, STATGROUP_ShooterGame);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Significance Tick Time Saved (ms)"), STAT_ShooterSignificanceTimeSaved, STATGROUP_ShooterGame);
+
+static int32 SignificanceEnable = 1;
+FAutoConsoleVariableRef CVarSignificanceEnable(
+	TEXT("ShooterGame.Significance.Enable"),
+	SignificanceEnable,
+	TEXT("Throttle character ticks by significance. When off every character runs at full rate."),
+	ECVF_Default);
+
+static float SignificanceUpdateInterval = 0.25f;
+FAutoConsoleVariableRef CVarSignificanceUpdateInterval(
+	TEXT("ShooterGame.Significance.UpdateInterval"),
+	SignificanceUpdateInterval,
+	TEXT("Seconds between significance bucket updates."),
+	ECVF_Default);
+
+static float SignificanceNearDistance = 3000.0f;
+FAutoConsoleVariableRef CVarSignificanceNearDistance(
+	TEXT("ShooterGame.Significance.NearDistance"),
+	SignificanceNearDistance,
+	TEXT("Visible characters closer than this to a view are Full, hidden ones Reduced, in uu."),
+	ECVF_Default);
+
+static float SignificanceFarDistance = 10000.0f;
+FAutoConsoleVariableRef CVarSignificanceFarDistance(
+	TEXT("ShooterGame.Significance.FarDistance"),
+	SignificanceFarDistance,
+	TEXT("Visible characters further than this from every view are Low, hidden ones Culled, in uu."),
+	ECVF_Default);
+
+static float SignificanceReducedTickInterval = 0.033f;
+FAutoConsoleVariableRef CVarSignificanceReducedTickInterval(
+	TEXT("ShooterGame.Significance.ReducedTickInterval"),
+	SignificanceReducedTickInterval,
+	TEXT("Actor tick interval of Reduced characters, components stay at full rate."),
+	ECVF_Default);
+
+static float SignificanceLowTickInterval = 0.1f;
+FAutoConsoleVariableRef CVarSignificanceLowTickInterval(
+	TEXT("ShooterGame.Significance.LowTickInterval"),
+	SignificanceLowTickInterval,
+	TEXT("Actor, movement and mesh tick interval of Low characters."),
+	ECVF_Default);
+
+static float SignificanceCulledTickInterval = 0.25f;
+FAutoConsoleVariableRef CVarSignificanceCulledTickInterval(
+	TEXT("ShooterGame.Significance.CulledTickInterval"),
+	SignificanceCulledTickInterval,
+	TEXT("Actor, movement and mesh tick interval of Culled characters."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorld SignificanceStatsCmd(
+	TEXT("ShooterGame.Significance.Stats"),
+	TEXT("Log characters per significance bucket and the estimated tick time saved."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		if (UShooterSignificanceManager* Manager = UShooterSignificanceManager::Get(World))
+		{
+			Manager->LogStats();
+		}
+	}));
+
+UShooterSignificanceManager::UShooterSignificanceManager(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	UpdateCountdown = 0.0f;
+	AverageTickCycles[0] = 0.0f;
+	AverageTickCycles[1] = 0.0f;
+	FMemory::Memzero(NumPerBucket);
+}
+
+UShooterSignificanceManager* UShooterSignificanceManager::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UShooterSignificanceManager>() : nullptr;
+}
+
+bool UShooterSignificanceManager::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UShooterSignificanceManager::Deinitialize()
+{
+	ManagedPawns.Empty();
+
+	Super::Deinitialize();
+}
+
+void UShooterSignificanceManager::RegisterPawn(AShooterCharacter* Pawn)
+{
+	if (Pawn && !ManagedPawns.ContainsByPredicate([Pawn](const FManagedPawn& Managed) { return Managed.Pawn == Pawn; }))
+	{
+		ManagedPawns.Add({ Pawn, EShooterSignificance::Full });
+	}
+}
+
+void UShooterSignificanceManager::UnregisterPawn(AShooterCharacter* Pawn)
+{
+	const int32 Index = ManagedPawns.IndexOfByPredicate([Pawn](const FManagedPawn& Managed) { return Managed.Pawn == Pawn; });
+	if (Index != INDEX_NONE)
+	{
+		if (Pawn && ManagedPawns[Index].Significance != EShooterSignificance::Full)
+		{
+			ApplySignificance(Pawn, EShooterSignificance::Full, false);
+		}
+		ManagedPawns.RemoveAtSwap(Index, 1, false);
+	}
+}
+
+void UShooterSignificanceManager::RecordTickCost(ETickType TickType, uint32 Cycles)
+{
+	float& Average = AverageTickCycles[(int32)TickType];
+	Average = (Average > 0.0f) ? FMath::Lerp(Average, (float)Cycles, 0.01f) : (float)Cycles;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Buckets
+
+float UShooterSignificanceManager::GetActorTickInterval(EShooterSignificance::Type Significance) const
+{
+	switch (Significance)
+	{
+	case EShooterSignificance::Reduced:
+		return SignificanceReducedTickInterval;
+	case EShooterSignificance::Low:
+		return SignificanceLowTickInterval;
+	case EShooterSignificance::Culled:
+		return SignificanceCulledTickInterval;
+	default:
+		return 0.0f;
+	}
+}
+
+float UShooterSignificanceManager::GetComponentTickInterval(EShooterSignificance::Type Significance) const
+{
+	switch (Significance)
+	{
+	case EShooterSignificance::Low:
+		return SignificanceLowTickInterval;
+	case EShooterSignificance::Culled:
+		return SignificanceCulledTickInterval;
+	default:
+		return 0.0f;
+	}
+}
+
+EShooterSignificance::Type UShooterSignificanceManager::EvaluateSignificance(const AShooterCharacter* Pawn, bool bServerPolicy) const
+{
+	if (!SignificanceEnable || !Pawn->IsAlive())
+	{
+		return EShooterSignificance::Full;
+	}
+
+	if (bServerPolicy ? Pawn->IsPlayerControlled() : Pawn->IsLocallyControlled())
+	{
+		return EShooterSignificance::Full;
+	}
+
+	float ClosestDistSq = MAX_FLT;
+	for (const FVector& ViewLocation : ViewLocations)
+	{
+		ClosestDistSq = FMath::Min(ClosestDistSq, FVector::DistSquared(ViewLocation, Pawn->GetActorLocation()));
+	}
+
+	const bool bNear = ClosestDistSq < FMath::Square(SignificanceNearDistance);
+	const bool bFar = ClosestDistSq > FMath::Square(SignificanceFarDistance);
+
+	if (bServerPolicy)
+	{
+		// bots still have to play, never cull them
+		return bNear ? EShooterSignificance::Full : (bFar ? EShooterSignificance::Low : EShooterSignificance::Reduced);
+	}
+
+	const bool bVisible = Pawn->GetMesh() && Pawn->GetMesh()->WasRecentlyRendered(0.2f);
+	if (bVisible)
+	{
+		return bNear ? EShooterSignificance::Full : (bFar ? EShooterSignificance::Low : EShooterSignificance::Reduced);
+	}
+
+	return bNear ? EShooterSignificance::Reduced : (bFar ? EShooterSignificance::Culled : EShooterSignificance::Low);
+}
+
+void UShooterSignificanceManager::ApplySignificance(AShooterCharacter* Pawn, EShooterSignificance::Type Significance, bool bServerPolicy) const
+{
+	Pawn->SetActorTickInterval(GetActorTickInterval(Significance));
+
+	// authoritative movement and poses are needed for gameplay and hit validation
+	if (!bServerPolicy && Pawn->GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		const float ComponentInterval = GetComponentTickInterval(Significance);
+
+		UCharacterMovementComponent* Movement = Pawn->GetCharacterMovement();
+		if (Movement)
+		{
+			// jetpack fuel drains per tick
+			Movement->SetComponentTickInterval(Movement->MovementMode == MOVE_Custom ? 0.0f : ComponentInterval);
+		}
+
+		USkeletalMeshComponent* Mesh = Pawn->GetMesh();
+		if (Mesh)
+		{
+			Mesh->SetComponentTickInterval(ComponentInterval);
+			Mesh->VisibilityBasedAnimTickOption = (Significance == EShooterSignificance::Culled) ? EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered : EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+		}
+	}
+
+	Pawn->SetSignificance(Significance);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Update
+
+void UShooterSignificanceManager::Tick(float DeltaTime)
+{
+#if STATS
+	SET_FLOAT_STAT(STAT_ShooterSignificanceTimeSaved, EstimateTimeSaved(DeltaTime));
+#endif
+
+	UpdateCountdown -= DeltaTime;
+	if (UpdateCountdown > 0.0f)
+	{
+		return;
+	}
+	UpdateCountdown = SignificanceUpdateInterval;
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterSignificanceUpdate);
+
+	const bool bServerPolicy = GetWorld()->GetNetMode() == NM_DedicatedServer;
+
+	// local views on clients, every player's view on servers
+	ViewLocations.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		if (PC && (bServerPolicy || PC->IsLocalController()))
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			ViewLocations.Add(ViewLocation);
+		}
+	}
+
+	FMemory::Memzero(NumPerBucket);
+
+	for (int32 i = ManagedPawns.Num() - 1; i >= 0; i--)
+	{
+		FManagedPawn& Managed = ManagedPawns[i];
+		AShooterCharacter* Pawn = Managed.Pawn.Get();
+		if (Pawn == nullptr)
+		{
+			ManagedPawns.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		EShooterSignificance::Type Significance = EvaluateSignificance(Pawn, bServerPolicy);
+
+		// the pawn a local player is spectating
+		if (!bServerPolicy && Significance != EShooterSignificance::Full)
+		{
+			for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+			{
+				APlayerController* PC = It->Get();
+				if (PC && PC->IsLocalController() && PC->GetViewTarget() == Pawn)
+				{
+					Significance = EShooterSignificance::Full;
+					break;
+				}
+			}
+		}
+
+		if (Significance != Managed.Significance)
+		{
+			ApplySignificance(Pawn, Significance, bServerPolicy);
+			Managed.Significance = Significance;
+		}
+
+		NumPerBucket[Significance]++;
+	}
+
+	SET_DWORD_STAT(STAT_ShooterSignificanceFull, NumPerBucket[EShooterSignificance::Full]);
+	SET_DWORD_STAT(STAT_ShooterSignificanceReduced, NumPerBucket[EShooterSignificance::Reduced]);
+	SET_DWORD_STAT(STAT_ShooterSignificanceLow, NumPerBucket[EShooterSignificance::Low]);
+	SET_DWORD_STAT(STAT_ShooterSignificanceCulled, NumPerBucket[EShooterSignificance::Culled]);
+}
+
+float UShooterSignificanceManager::EstimateTimeSaved(float DeltaTime) const
+{
+	const bool bServerPolicy = GetWorld()->GetNetMode() == NM_DedicatedServer;
+
+	float SavedCycles = 0.0f;
+	for (const FManagedPawn& Managed : ManagedPawns)
+	{
+		// fraction of frames the tick is skipped
+		const float ActorInterval = GetActorTickInterval(Managed.Significance);
+		if (ActorInterval > DeltaTime)
+		{
+			SavedCycles += (1.0f - DeltaTime / ActorInterval) * AverageTickCycles[(int32)ETickType::Actor];
+		}
+
+		const AShooterCharacter* Pawn = Managed.Pawn.Get();
+		const float ComponentInterval = GetComponentTickInterval(Managed.Significance);
+		if (!bServerPolicy && Pawn && Pawn->GetLocalRole() == ROLE_SimulatedProxy && ComponentInterval > DeltaTime)
+		{
+			SavedCycles += (1.0f - DeltaTime / ComponentInterval) * AverageTickCycles[(int32)ETickType::Movement];
+		}
+	}
+
+	return (float)FPlatformTime::ToMilliseconds(FMath::TruncToInt(SavedCycles));
+}
+
+void UShooterSignificanceManager::LogStats() const
+{
+	const float DeltaTime = FApp::GetDeltaTime();
+	UE_LOG(LogShooter, Log, TEXT("Significance: %d characters, %d full, %d reduced, %d low, %d culled, ~%.3f ms tick time saved per frame"),
+		ManagedPawns.Num(), NumPerBucket[EShooterSignificance::Full], NumPerBucket[EShooterSignificance::Reduced],
+		NumPerBucket[EShooterSignificance::Low], NumPerBucket[EShooterSignificance::Culled], EstimateTimeSaved(DeltaTime));
+}
+
+bool UShooterSignificanceManager::IsTickable() const
+{
+	return ManagedPawns.Num() > 0;
+}
+
+TStatId UShooterSignificanceManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterSignificanceManager, STATGROUP_Tickables);
+}
+
+UWorld* UShooterSignificanceManager::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
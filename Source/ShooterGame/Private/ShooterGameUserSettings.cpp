@@ -20,6 +20,14 @@ void UShooterGameUserSettings::SetToDefaults()
 	bIsDedicatedServer = false;
 	bIsForceSystemResolution = false;
 	NVIDIAReflex = 1;
+
+#if PLATFORM_DESKTOP
+	MaxDecals = 256;
+	DecalCullDistance = 8000.0f;
+#else
+	MaxDecals = 64;
+	DecalCullDistance = 4000.0f;
+#endif
 }
 
 void UShooterGameUserSettings::ApplySettings(bool bCheckForCommandLineOverrides)
@@ -6,20 +6,135 @@
 
 #define LOCTEXT_NAMESPACE "SoundNodeLocalPlayer"
 
-TMap<uint32, bool> USoundNodeLocalPlayer::LocallyControlledActorCache;
+/**
+ * Fixed size open addressing table of locally controlled actors, written by the game thread and read by the audio thread
+ * without locks. Each slot is one atomic word holding the unique ID and flags, so readers never see half an entry.
+ */
+namespace LocallyControlledTable
+{
+	/** number of slots, power of two, pawns and controllers share it */
+	static constexpr int32 NumSlots = 1024;
 
-USoundNodeLocalPlayer::USoundNodeLocalPlayer(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+	static constexpr uint64 LocallyControlledFlag = 1;
+	static constexpr uint64 OccupiedFlag = 2;
+
+	/** removed entry that may be followed by more of the probe chain */
+	static constexpr uint64 Tombstone = 4;
+
+	static TAtomic<uint64> Slots[NumSlots];
+
+	static int32 GetFirstSlot(uint32 UniqueID)
+	{
+		return (int32)((UniqueID * 2654435761u) & (NumSlots - 1));
+	}
+
+	static bool IsEntryFor(uint64 Entry, uint32 UniqueID)
+	{
+		return (Entry & OccupiedFlag) && (uint32)(Entry >> 32) == UniqueID;
+	}
+}
+
+void USoundNodeLocalPlayer::SetLocallyControlled(uint32 UniqueID, bool bLocallyControlled)
+{
+	using namespace LocallyControlledTable;
+	check(IsInGameThread());
+
+	const uint64 NewEntry = ((uint64)UniqueID << 32) | OccupiedFlag | (bLocallyControlled ? LocallyControlledFlag : 0);
+
+	int32 FreeSlot = INDEX_NONE;
+	for (int32 Probe = 0, Slot = GetFirstSlot(UniqueID); Probe < NumSlots; Probe++, Slot = (Slot + 1) & (NumSlots - 1))
+	{
+		const uint64 Entry = Slots[Slot].Load();
+		if (IsEntryFor(Entry, UniqueID))
+		{
+			if (Entry != NewEntry)
+			{
+				Slots[Slot].Store(NewEntry);
+			}
+			return;
+		}
+
+		if (Entry == 0 || Entry == Tombstone)
+		{
+			FreeSlot = (FreeSlot == INDEX_NONE) ? Slot : FreeSlot;
+			if (Entry == 0)
+			{
+				break;
+			}
+		}
+	}
+
+	if (FreeSlot != INDEX_NONE)
+	{
+		Slots[FreeSlot].Store(NewEntry);
+	}
+	else
+	{
+		UE_LOG(LogShooter, Warning, TEXT("Locally controlled table is full, sounds of actor %u will play as remote"), UniqueID);
+	}
+}
+
+void USoundNodeLocalPlayer::RemoveLocallyControlled(uint32 UniqueID)
 {
+	using namespace LocallyControlledTable;
+	check(IsInGameThread());
+
+	for (int32 Probe = 0, Slot = GetFirstSlot(UniqueID); Probe < NumSlots; Probe++, Slot = (Slot + 1) & (NumSlots - 1))
+	{
+		const uint64 Entry = Slots[Slot].Load();
+		if (Entry == 0)
+		{
+			return;
+		}
+
+		if (IsEntryFor(Entry, UniqueID))
+		{
+			// at the end of the chain, clear it and any tombstones before it so chains don't grow forever
+			if (Slots[(Slot + 1) & (NumSlots - 1)].Load() == 0)
+			{
+				Slots[Slot].Store(0);
+				for (int32 Prev = (Slot - 1) & (NumSlots - 1); Slots[Prev].Load() == Tombstone; Prev = (Prev - 1) & (NumSlots - 1))
+				{
+					Slots[Prev].Store(0);
+				}
+			}
+			else
+			{
+				Slots[Slot].Store(Tombstone);
+			}
+			return;
+		}
+	}
 }
 
-void USoundNodeLocalPlayer::ParseNodes(FAudioDevice* AudioDevice, const UPTRINT NodeWaveInstanceHash, FActiveSound& ActiveSound, const FSoundParseParameters& ParseParams, TArray<FWaveInstance*>& WaveInstances)
+bool USoundNodeLocalPlayer::IsLocallyControlled(uint32 UniqueID)
 {
-	bool bLocallyControlled = false;
-	if (bool* LocallyControlledPtr = LocallyControlledActorCache.Find(ActiveSound.GetOwnerID()))
+	using namespace LocallyControlledTable;
+
+	for (int32 Probe = 0, Slot = GetFirstSlot(UniqueID); Probe < NumSlots; Probe++, Slot = (Slot + 1) & (NumSlots - 1))
 	{
-		bLocallyControlled = *LocallyControlledPtr;
+		const uint64 Entry = Slots[Slot].Load();
+		if (Entry == 0)
+		{
+			break;
+		}
+
+		if (IsEntryFor(Entry, UniqueID))
+		{
+			return (Entry & LocallyControlledFlag) != 0;
+		}
 	}
 
+	return false;
+}
+
+USoundNodeLocalPlayer::USoundNodeLocalPlayer(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+}
+
+void USoundNodeLocalPlayer::ParseNodes(FAudioDevice* AudioDevice, const UPTRINT NodeWaveInstanceHash, FActiveSound& ActiveSound, const FSoundParseParameters& ParseParams, TArray<FWaveInstance*>& WaveInstances)
+{
+	const bool bLocallyControlled = IsLocallyControlled(ActiveSound.GetOwnerID());
 	const int32 PlayIndex = bLocallyControlled ? 0 : 1;
 
 	if (PlayIndex < ChildNodes.Num() && ChildNodes[PlayIndex])
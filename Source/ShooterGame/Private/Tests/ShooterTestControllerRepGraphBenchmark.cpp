@@ -0,0 +1,294 @@
+// Copyright Epic Games, Inc.All Rights Reserved.
+#include "Tests/ShooterTestControllerRepGraphBenchmark.h"
+#include "ShooterGame.h"
+#include "Online/ShooterReplicationGraph.h"
+#include "Weapons/ShooterProjectile.h"
+#include "Weapons/ShooterProjectilePool.h"
+#include "Weapons/ShooterWeapon_Projectile.h"
+#include "Pickups/ShooterPickup_Ammo.h"
+#include "Pickups/ShooterPickup_Health.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/PlayerStart.h"
+#include "EngineUtils.h"
+
+void UShooterTestControllerRepGraphBenchmark::OnInit()
+{
+	Super::OnInit();
+
+	NumConnections = 100;
+	NumPawns = 100;
+	NumProjectiles = 50;
+	NumPickups = 50;
+	WarmupFrames = 60;
+	SampleFrames = 600;
+	CsvFilename = FPaths::ProfilingDir() / TEXT("RepGraphBenchmark.csv");
+
+	FParse::Value(FCommandLine::Get(), TEXT("RepGraphBench.Connections="), NumConnections);
+	FParse::Value(FCommandLine::Get(), TEXT("RepGraphBench.Pawns="), NumPawns);
+	FParse::Value(FCommandLine::Get(), TEXT("RepGraphBench.Projectiles="), NumProjectiles);
+	FParse::Value(FCommandLine::Get(), TEXT("RepGraphBench.Pickups="), NumPickups);
+	FParse::Value(FCommandLine::Get(), TEXT("RepGraphBench.WarmupFrames="), WarmupFrames);
+	FParse::Value(FCommandLine::Get(), TEXT("RepGraphBench.Frames="), SampleFrames);
+	FParse::Value(FCommandLine::Get(), TEXT("RepGraphBench.Csv="), CsvFilename);
+	FParse::Value(FCommandLine::Get(), TEXT("RepGraphBench.ProjectileClass="), ProjectileClassName);
+
+	bIsSetup = false;
+	FrameCount = 0;
+	ProjectileWeapon = nullptr;
+	ProjectileClass = nullptr;
+	LastTotalBytes = 0;
+}
+
+void UShooterTestControllerRepGraphBenchmark::OnPostMapChange(UWorld* World)
+{
+	// Runs on whatever map the server was started with, no match cycling
+}
+
+void UShooterTestControllerRepGraphBenchmark::OnTick(float TimeDelta)
+{
+	if (!bIsSetup)
+	{
+		if (GetReplicationGraph() && SetupBenchmark())
+		{
+			bIsSetup = true;
+		}
+		else if (GetTimeInCurrentState() > 300)
+		{
+			UE_LOG(LogGauntlet, Error, TEXT("Failing replication graph benchmark, no replication graph after 300 secs! It has to run on a dedicated server."));
+			EndTest(-1);
+		}
+		return;
+	}
+
+	UpdateSyntheticActors(TimeDelta);
+
+	// Replication for the previous frame has already run, the graph still holds its state
+	FrameCount++;
+	if (FrameCount == WarmupFrames)
+	{
+		SampleFrame();
+		CsvLines.Reset();
+	}
+	else if (FrameCount > WarmupFrames)
+	{
+		SampleFrame();
+
+		if (FrameCount >= WarmupFrames + SampleFrames)
+		{
+			FinishBenchmark();
+		}
+	}
+}
+
+UShooterReplicationGraph* UShooterTestControllerRepGraphBenchmark::GetReplicationGraph() const
+{
+	UWorld* World = GetWorld();
+	UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+	return NetDriver ? Cast<UShooterReplicationGraph>(NetDriver->GetReplicationDriver()) : nullptr;
+}
+
+bool UShooterTestControllerRepGraphBenchmark::SetupBenchmark()
+{
+	UWorld* World = GetWorld();
+	AGameModeBase* GameMode = World->GetAuthGameMode();
+	if (GameMode == nullptr || !World->HasBegunPlay())
+	{
+		return false;
+	}
+
+	UNetDriver* NetDriver = World->GetNetDriver();
+
+	for (TActorIterator<APlayerStart> It(World); It; ++It)
+	{
+		SpawnLocations.Add(It->GetActorLocation());
+	}
+	if (SpawnLocations.Num() == 0)
+	{
+		SpawnLocations.Add(FVector::ZeroVector);
+	}
+
+	// Simulated connections go through the regular login, so each gets a player controller and a pawn like a real client
+	for (int32 i = 0; i < NumConnections; i++)
+	{
+		USimulatedClientNetConnection* Connection = NewObject<USimulatedClientNetConnection>(NetDriver);
+		Connection->InitConnection(NetDriver, USOCK_Open, World->URL, 1000000);
+		Connection->InitSendBuffer();
+		Connection->SetClientWorldPackageName(World->GetOutermost()->GetFName());
+		NetDriver->AddClientConnection(Connection);
+
+		FString Error;
+		if (World->SpawnPlayActor(Connection, ROLE_AutonomousProxy, World->URL, Connection->PlayerId, Error) == nullptr)
+		{
+			UE_LOG(LogGauntlet, Error, TEXT("Failed to spawn player for simulated connection %d: %s"), i, *Error);
+			EndTest(-1);
+			return false;
+		}
+	}
+
+	// AShooterProjectile is abstract, fire the class from the command line or whatever the players' projectile weapons fire
+	if (!ProjectileClassName.IsEmpty())
+	{
+		ProjectileClass = LoadClass<AShooterProjectile>(nullptr, *ProjectileClassName);
+		if (ProjectileClass == nullptr || ProjectileClass->HasAnyClassFlags(CLASS_Abstract))
+		{
+			UE_LOG(LogGauntlet, Error, TEXT("RepGraphBench.ProjectileClass=%s is not a concrete projectile class."), *ProjectileClassName);
+			EndTest(-1);
+			return false;
+		}
+	}
+
+	for (TActorIterator<AShooterWeapon_Projectile> It(World); It; ++It)
+	{
+		FProjectileWeaponData WeaponData;
+		It->ApplyWeaponConfig(WeaponData);
+		if (ProjectileClass || WeaponData.ProjectileClass)
+		{
+			ProjectileWeapon = *It;
+			ProjectileClass = ProjectileClass ? ProjectileClass : WeaponData.ProjectileClass;
+			break;
+		}
+	}
+
+	if (ProjectileWeapon == nullptr && NumProjectiles > 0)
+	{
+		UE_LOG(LogGauntlet, Warning, TEXT("No projectile weapon in the game, running the replication graph benchmark without projectiles."));
+		NumProjectiles = 0;
+	}
+
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	FRandomStream Random(NumConnections + NumPawns);
+
+	for (int32 i = 0; i < NumPawns; i++)
+	{
+		const FVector Origin = SpawnLocations[i % SpawnLocations.Num()] + FVector(Random.FRandRange(-2000.f, 2000.f), Random.FRandRange(-2000.f, 2000.f), 0.f);
+		if (AActor* Pawn = World->SpawnActor<APawn>(GameMode->DefaultPawnClass, Origin, FRotator::ZeroRotator, SpawnInfo))
+		{
+			Pawns.Add(Pawn);
+			PawnOrigins.Add(Origin);
+		}
+	}
+
+	for (int32 i = 0; i < NumPickups; i++)
+	{
+		const FVector Location = SpawnLocations[i % SpawnLocations.Num()] + FVector(Random.FRandRange(-3000.f, 3000.f), Random.FRandRange(-3000.f, 3000.f), 0.f);
+		UClass* PickupClass = (i % 2) ? AShooterPickup_Ammo::StaticClass() : AShooterPickup_Health::StaticClass();
+		if (AActor* Pickup = World->SpawnActor<AActor>(PickupClass, Location, FRotator::ZeroRotator, SpawnInfo))
+		{
+			Pickups.Add(Pickup);
+		}
+	}
+
+	GetReplicationGraph()->SetGatherProfiling(true);
+
+	UE_LOG(LogGauntlet, Display, TEXT("Replication graph benchmark: %d connections, %d pawns, %d projectiles, %d pickups, %d frames"), NumConnections, Pawns.Num(), NumProjectiles, Pickups.Num(), SampleFrames);
+	return true;
+}
+
+void UShooterTestControllerRepGraphBenchmark::UpdateSyntheticActors(float TimeDelta)
+{
+	UWorld* World = GetWorld();
+	const float TimeSeconds = World->GetTimeSeconds();
+
+	// Circle around, each pawn at its own phase
+	for (int32 i = 0; i < Pawns.Num(); i++)
+	{
+		if (IsValid(Pawns[i]))
+		{
+			const float Angle = TimeSeconds + i * 0.37f;
+			Pawns[i]->SetActorLocation(PawnOrigins[i] + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * 500.f, false, nullptr, ETeleportType::TeleportPhysics);
+		}
+	}
+
+	// Projectiles explode on impact and go back to the pool hidden, firing new ones keeps actors waking up and going dormant
+	Projectiles.RemoveAll([](const TWeakObjectPtr<AActor>& Projectile) { return !Projectile.IsValid() || Projectile->IsPendingKillPending() || Projectile->IsHidden(); });
+
+	UShooterProjectilePool* Pool = UShooterProjectilePool::Get(World);
+	if (Pool == nullptr || !IsValid(ProjectileWeapon))
+	{
+		return;
+	}
+
+	while (Projectiles.Num() < NumProjectiles)
+	{
+		const FVector Location = SpawnLocations[FMath::Rand() % SpawnLocations.Num()] + FVector(0.f, 0.f, 100.f);
+		const FVector Direction = FMath::VRand().GetSafeNormal2D();
+
+		AShooterProjectile* Projectile = Pool->AcquireProjectile(ProjectileClass, FTransform(Direction.Rotation(), Location), ProjectileWeapon, Direction);
+		if (Projectile == nullptr)
+		{
+			break;
+		}
+
+		Projectile->SetLifeSpan(3.0f);
+		Projectiles.Add(Projectile);
+	}
+}
+
+void UShooterTestControllerRepGraphBenchmark::SampleFrame()
+{
+	UShooterReplicationGraph* Graph = GetReplicationGraph();
+	UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	if (Graph == nullptr || NetDriver == nullptr)
+	{
+		return;
+	}
+
+	const FShooterRepGraphGatherProfile& Profile = Graph->GetLastGatherProfile();
+
+	int64 TotalBytes = 0;
+	for (UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		TotalBytes += Connection->OutTotalBytes;
+	}
+	const int64 FrameBytes = TotalBytes - LastTotalBytes;
+	LastTotalBytes = TotalBytes;
+
+	if (NodeColumns.Num() == 0)
+	{
+		Profile.NodeGatherSeconds.GenerateKeyArray(NodeColumns);
+	}
+
+	const int32 ConnectionCount = FMath::Max(1, Profile.NumConnections);
+
+	FString Line = FString::Printf(TEXT("%d,%d,%d,%d,%d,%.4f,%.1f,%.1f"),
+		FrameCount - WarmupFrames,
+		Profile.NumConnections,
+		Pawns.Num(),
+		Projectiles.Num(),
+		Pickups.Num(),
+		Graph->GetLastReplicateActorsSeconds() * 1000.0,
+		(float)Profile.NumActorsGathered / ConnectionCount,
+		(float)FrameBytes / ConnectionCount);
+
+	for (const FName& NodeName : NodeColumns)
+	{
+		const double* Seconds = Profile.NodeGatherSeconds.Find(NodeName);
+		Line += FString::Printf(TEXT(",%.4f"), Seconds ? *Seconds * 1000.0 : 0.0);
+	}
+
+	CsvLines.Add(Line);
+}
+
+void UShooterTestControllerRepGraphBenchmark::FinishBenchmark()
+{
+	FString Header = TEXT("Frame,Connections,Pawns,Projectiles,Pickups,ReplicateMs,ActorsGatheredPerConnection,BytesPerConnection");
+	for (const FName& NodeName : NodeColumns)
+	{
+		Header += FString::Printf(TEXT(",%sGatherMs"), *NodeName.ToString());
+	}
+
+	CsvLines.Insert(Header, 0);
+
+	if (FFileHelper::SaveStringArrayToFile(CsvLines, *CsvFilename))
+	{
+		UE_LOG(LogGauntlet, Display, TEXT("Replication graph benchmark written to %s"), *CsvFilename);
+		EndTest(0);
+	}
+	else
+	{
+		UE_LOG(LogGauntlet, Error, TEXT("Failed to write replication graph benchmark to %s"), *CsvFilename);
+		EndTest(-1);
+	}
+}
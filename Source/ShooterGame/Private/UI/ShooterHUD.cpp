@@ -463,9 +463,7 @@ void AShooterHUD::DrawMatchTimerAndPosition()
 					int32 NumTeams = 0;
 					for (int32 i=0; i < MyGameState->NumTeams; i++)
 					{
-						RankedPlayerMap PlayerStateMap;
-						MyGameState->GetRankedMap(i,PlayerStateMap);
-						if(PlayerStateMap.Num() > 0)
+						if (MyGameState->GetTeamLeaderboard(i).Num() > 0)
 						{
 							NumTeams++;
 						}
@@ -474,11 +472,9 @@ void AShooterHUD::DrawMatchTimerAndPosition()
 				}
 				else // free for all
 				{
-					RankedPlayerMap PlayerStateMap;
-					MyGameState->GetRankedMap(0,PlayerStateMap);
-					const int32* MyRank = PlayerStateMap.FindKey(MyPlayerState);
-					int32 MyPos = MyRank ? *MyRank + 1 : 0;
-					Text = FString::Printf(TEXT("%d/%d"), MyPos, PlayerStateMap.Num());
+					const int32 MyRank = MyGameState->GetLeaderboardRank(MyPlayerState);
+					int32 MyPos = MyRank != INDEX_NONE ? MyRank + 1 : 0;
+					Text = FString::Printf(TEXT("%d/%d"), MyPos, MyGameState->GetTeamLeaderboard(0).Num());
 				}
 				Canvas->StrLen(BigFont, Text, SizeX, SizeY);
 				Canvas->DrawIcon(PlaceIcon,
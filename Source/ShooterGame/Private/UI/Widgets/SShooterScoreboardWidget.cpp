@@ -24,6 +24,7 @@ void SShooterScoreboardWidget::Construct(const FArguments& InArgs)
 	ScoreboardTint = FLinearColor(0.0f,0.0f,0.0f,0.4f);
 	ScoreBoxWidth = 140.0f;
 	ScoreCountUpTime = 2.0f;
+	LastLeaderboardVersion = 0;
 
 	ScoreboardStartTime = FPlatformTime::Seconds();
 	MatchState = InArgs._MatchState.Get();
@@ -281,10 +282,14 @@ void SShooterScoreboardWidget::UpdatePlayerStateMaps()
 	if (PCOwner.IsValid())
 	{
 		AShooterGameState* const GameState = PCOwner->GetWorld()->GetGameState<AShooterGameState>();
-		if (GameState)
+		const int32 NumTeams = GameState ? FMath::Max(GameState->NumTeams, 1) : 0;
+
+		// rankings only change when the game state bumps its leaderboard version
+		if (GameState && (GameState->GetLeaderboardVersion() != LastLeaderboardVersion || PlayerStateMaps.Num() != NumTeams))
 		{
+			LastLeaderboardVersion = GameState->GetLeaderboardVersion();
+
 			bool bRequiresWidgetUpdate = false;
-			const int32 NumTeams = FMath::Max(GameState->NumTeams, 1);
 			LastTeamPlayerCount.Reset();
 			LastTeamPlayerCount.AddZeroed(PlayerStateMaps.Num());
 			for (int32 i = 0; i < PlayerStateMaps.Num(); i++)
@@ -219,12 +219,15 @@ protected:
 	/** the player currently selected in the scoreboard */
 	FTeamPlayer SelectedPlayer;
 
-	/** the Ranked PlayerState map...cleared every frame */
+	/** the Ranked PlayerState map...rebuilt when the leaderboard version changes */
 	TArray<RankedPlayerMap> PlayerStateMaps;
 
 	/** player count in each team in the last tick */
 	TArray<int32> LastTeamPlayerCount;
 
+	/** leaderboard version PlayerStateMaps were built from */
+	uint32 LastLeaderboardVersion;
+
 	/** holds talking player data */
 	TArray<TPair<TSharedRef<const FUniqueNetId>, bool>> PlayersTalkingThisFrame;
 
@@ -0,0 +1,369 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Weapons/ShooterLagCompensation.h"
+
+DECLARE_CYCLE_STAT(TEXT("Lag Compensation Record"), STAT_ShooterLagCompensationRecord, STATGROUP_ShooterGame);
+DECLARE_CYCLE_STAT(TEXT("Lag Compensation Validate"), STAT_ShooterLagCompensationValidate, STATGROUP_ShooterGame);
+DECLARE_MEMORY_STAT(TEXT("Lag Compensation Memory"), STAT_ShooterLagCompensationMemory, STATGROUP_ShooterGame);
+
+static int32 LagCompensationEnable = 1;
+FAutoConsoleVariableRef CVarLagCompensationEnable(
+	TEXT("ShooterGame.LagCompensation"),
+	LagCompensationEnable,
+	TEXT("Validate client hits against rewound target bounds. 0: Disable, 1: Enable"),
+	ECVF_Default);
+
+static int32 LagCompensationHistoryFrames = 64;
+FAutoConsoleVariableRef CVarLagCompensationHistoryFrames(
+	TEXT("ShooterGame.LagCompensation.HistoryFrames"),
+	LagCompensationHistoryFrames,
+	TEXT("Number of frames kept in the history. Applied on world start."),
+	ECVF_Default);
+
+static int32 LagCompensationMaxPawns = 128;
+FAutoConsoleVariableRef CVarLagCompensationMaxPawns(
+	TEXT("ShooterGame.LagCompensation.MaxPawns"),
+	LagCompensationMaxPawns,
+	TEXT("Max number of pawns tracked at once. Applied on world start."),
+	ECVF_Default);
+
+static float LagCompensationSampleInterval = 1.0f / 60.0f;
+FAutoConsoleVariableRef CVarLagCompensationSampleInterval(
+	TEXT("ShooterGame.LagCompensation.SampleInterval"),
+	LagCompensationSampleInterval,
+	TEXT("Min time between recorded frames, in seconds. HistoryFrames * SampleInterval is the covered time."),
+	ECVF_Default);
+
+static float LagCompensationMaxRewindTime = 0.4f;
+FAutoConsoleVariableRef CVarLagCompensationMaxRewindTime(
+	TEXT("ShooterGame.LagCompensation.MaxRewindTime"),
+	LagCompensationMaxRewindTime,
+	TEXT("Max time a hit can be rewound, in seconds. Clients with higher ping are validated at this limit."),
+	ECVF_Default);
+
+UShooterLagCompensation::UShooterLagCompensation(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	MaxFrames = 0;
+	MaxSlots = 0;
+	FrameHead = 0;
+	FrameCount = 0;
+}
+
+UShooterLagCompensation* UShooterLagCompensation::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UShooterLagCompensation>() : nullptr;
+}
+
+bool UShooterLagCompensation::ShouldCreateSubsystem(UObject* Outer) const
+{
+	// only the server validates hits, pure clients would record history nobody queries
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && World->GetNetMode() != NM_Client;
+}
+
+void UShooterLagCompensation::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	AllocateHistory();
+}
+
+void UShooterLagCompensation::Deinitialize()
+{
+	ReleaseHistory();
+
+	Super::Deinitialize();
+}
+
+void UShooterLagCompensation::AllocateHistory()
+{
+	MaxFrames = FMath::Max(2, LagCompensationHistoryFrames);
+	MaxSlots = FMath::Max(1, LagCompensationMaxPawns);
+	FrameHead = 0;
+	FrameCount = 0;
+
+	FrameTimestamps.SetNumZeroed(MaxFrames);
+	BoundsCenters.SetNumZeroed(MaxFrames * MaxSlots);
+	BoundsExtents.SetNumZeroed(MaxFrames * MaxSlots);
+	SlotPawns.SetNum(MaxSlots);
+	SlotRegisterTimes.SetNumZeroed(MaxSlots);
+
+	// hand out low slots first so recording touches the front of each frame
+	FreeSlots.Reset(MaxSlots);
+	for (int32 Slot = MaxSlots - 1; Slot >= 0; Slot--)
+	{
+		FreeSlots.Add(Slot);
+	}
+
+	SlotByActor.Reserve(MaxSlots);
+
+	INC_MEMORY_STAT_BY(STAT_ShooterLagCompensationMemory, FrameTimestamps.GetAllocatedSize() + BoundsCenters.GetAllocatedSize() + BoundsExtents.GetAllocatedSize());
+}
+
+void UShooterLagCompensation::ReleaseHistory()
+{
+	DEC_MEMORY_STAT_BY(STAT_ShooterLagCompensationMemory, FrameTimestamps.GetAllocatedSize() + BoundsCenters.GetAllocatedSize() + BoundsExtents.GetAllocatedSize());
+
+	FrameTimestamps.Empty();
+	BoundsCenters.Empty();
+	BoundsExtents.Empty();
+	SlotPawns.Empty();
+	SlotRegisterTimes.Empty();
+	FreeSlots.Empty();
+	SlotByActor.Empty();
+
+	FrameHead = 0;
+	FrameCount = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Recording
+
+void UShooterLagCompensation::Tick(float DeltaTime)
+{
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+	if (FrameCount > 0)
+	{
+		const int32 LastFrame = (FrameHead - 1 + MaxFrames) % MaxFrames;
+		if (TimeSeconds - FrameTimestamps[LastFrame] < LagCompensationSampleInterval)
+		{
+			return;
+		}
+	}
+
+	RecordFrame(TimeSeconds);
+}
+
+bool UShooterLagCompensation::IsTickable() const
+{
+	// only the server validates hits
+	const UWorld* World = GetWorld();
+	return LagCompensationEnable && World && World->GetNetMode() != NM_Client && SlotByActor.Num() > 0;
+}
+
+TStatId UShooterLagCompensation::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterLagCompensation, STATGROUP_Tickables);
+}
+
+UWorld* UShooterLagCompensation::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+void UShooterLagCompensation::RecordFrame(float TimeSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterLagCompensationRecord);
+
+	const int32 Frame = FrameHead;
+	FrameTimestamps[Frame] = TimeSeconds;
+
+	FVector* const FrameCenters = BoundsCenters.GetData() + Frame * MaxSlots;
+	FVector* const FrameExtents = BoundsExtents.GetData() + Frame * MaxSlots;
+
+	for (int32 Slot = 0; Slot < MaxSlots; Slot++)
+	{
+		APawn* Pawn = SlotPawns[Slot].Get();
+		if (Pawn == nullptr)
+		{
+			continue;
+		}
+
+		GetTrackedBounds(Pawn).GetCenterAndExtents(FrameCenters[Slot], FrameExtents[Slot]);
+	}
+
+	FrameHead = (FrameHead + 1) % MaxFrames;
+	FrameCount = FMath::Min(FrameCount + 1, MaxFrames);
+}
+
+void UShooterLagCompensation::RegisterPawn(APawn* Pawn)
+{
+	if (Pawn == nullptr || SlotByActor.Contains(Pawn))
+	{
+		return;
+	}
+
+	if (FreeSlots.Num() == 0)
+	{
+		UE_LOG(LogShooterWeapon, Warning, TEXT("Lag compensation history full, %s will be validated without rewind"), *GetNameSafe(Pawn));
+		return;
+	}
+
+	const int32 Slot = FreeSlots.Pop(false);
+	SlotPawns[Slot] = Pawn;
+	SlotRegisterTimes[Slot] = GetWorld()->GetTimeSeconds();
+	SlotByActor.Add(Pawn, Slot);
+}
+
+void UShooterLagCompensation::UnregisterPawn(APawn* Pawn)
+{
+	int32 Slot = INDEX_NONE;
+	if (SlotByActor.RemoveAndCopyValue(Pawn, Slot))
+	{
+		SlotPawns[Slot] = nullptr;
+		FreeSlots.Add(Slot);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Queries
+
+float UShooterLagCompensation::GetEstimatedFireTime(const AController* Shooter) const
+{
+	// the client aimed at a view that was half a round trip old, and the hit took another half to arrive
+	const APlayerState* ShooterPlayerState = Shooter ? Shooter->PlayerState : nullptr;
+	const float RewindTime = ShooterPlayerState ? FMath::Clamp(ShooterPlayerState->ExactPing * 0.001f, 0.0f, LagCompensationMaxRewindTime) : 0.0f;
+
+	return GetWorld()->GetTimeSeconds() - RewindTime;
+}
+
+bool UShooterLagCompensation::FindFrames(float Time, FFrameLookup& OutLookup) const
+{
+	if (FrameCount == 0)
+	{
+		return false;
+	}
+
+	// logical index 0 is the oldest frame, FrameCount - 1 the newest
+	const int32 OldestFrame = (FrameHead - FrameCount + MaxFrames) % MaxFrames;
+	auto FrameAt = [this, OldestFrame](int32 LogicalIndex) { return (OldestFrame + LogicalIndex) % MaxFrames; };
+
+	if (Time < FrameTimestamps[OldestFrame])
+	{
+		return false;
+	}
+
+	const int32 NewestFrame = FrameAt(FrameCount - 1);
+	if (Time >= FrameTimestamps[NewestFrame])
+	{
+		OutLookup.OlderFrame = NewestFrame;
+		OutLookup.NewerFrame = NewestFrame;
+		OutLookup.Alpha = 0.0f;
+		OutLookup.OlderTimestamp = FrameTimestamps[NewestFrame];
+		return true;
+	}
+
+	// timestamps are increasing, find the last frame not newer than Time
+	int32 Low = 0;
+	int32 High = FrameCount - 1;
+	while (High - Low > 1)
+	{
+		const int32 Mid = (Low + High) / 2;
+		if (FrameTimestamps[FrameAt(Mid)] <= Time)
+		{
+			Low = Mid;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+
+	OutLookup.OlderFrame = FrameAt(Low);
+	OutLookup.NewerFrame = FrameAt(High);
+	OutLookup.OlderTimestamp = FrameTimestamps[OutLookup.OlderFrame];
+
+	const float FrameDelta = FrameTimestamps[OutLookup.NewerFrame] - OutLookup.OlderTimestamp;
+	OutLookup.Alpha = FrameDelta > KINDA_SMALL_NUMBER ? FMath::Clamp((Time - OutLookup.OlderTimestamp) / FrameDelta, 0.0f, 1.0f) : 0.0f;
+	return true;
+}
+
+bool UShooterLagCompensation::GetSlotBounds(int32 Slot, const FFrameLookup& Lookup, FBox& OutBounds) const
+{
+	// frames recorded before the slot was taken belong to its previous owner
+	if (Lookup.OlderTimestamp < SlotRegisterTimes[Slot])
+	{
+		return false;
+	}
+
+	const int32 OlderIndex = Lookup.OlderFrame * MaxSlots + Slot;
+	const int32 NewerIndex = Lookup.NewerFrame * MaxSlots + Slot;
+
+	const FVector Center = FMath::Lerp(BoundsCenters[OlderIndex], BoundsCenters[NewerIndex], Lookup.Alpha);
+	const FVector Extent = FMath::Lerp(BoundsExtents[OlderIndex], BoundsExtents[NewerIndex], Lookup.Alpha);
+
+	OutBounds = FBox(Center - Extent, Center + Extent);
+	return true;
+}
+
+FBox UShooterLagCompensation::GetTrackedBounds(const APawn* Pawn)
+{
+	// cached component bounds: capsule plus the physics asset driven bounds of the mesh
+	FBox Bounds = Pawn->GetRootComponent()->Bounds.GetBox();
+	const ACharacter* Character = Cast<ACharacter>(Pawn);
+	if (Character && Character->GetMesh() && Character->GetMesh()->IsRegistered())
+	{
+		Bounds += Character->GetMesh()->Bounds.GetBox();
+	}
+
+	return Bounds;
+}
+
+float UShooterLagCompensation::GetMaxRewindTime()
+{
+	return LagCompensationMaxRewindTime;
+}
+
+bool UShooterLagCompensation::GetRewoundBounds(const AActor* Target, float Time, FBox& OutBounds) const
+{
+	const int32* Slot = SlotByActor.Find(Target);
+	FFrameLookup Lookup;
+	return Slot && FindFrames(Time, Lookup) && GetSlotBounds(*Slot, Lookup, OutBounds);
+}
+
+EShooterLagCompensationResult UShooterLagCompensation::ValidateHitWithFrames(const FShooterLagCompensationQuery& Query, const FFrameLookup& Lookup) const
+{
+	const int32* Slot = SlotByActor.Find(Query.Target);
+
+	FBox Bounds;
+	if (Slot == nullptr || !GetSlotBounds(*Slot, Lookup, Bounds))
+	{
+		return EShooterLagCompensationResult::NoHistory;
+	}
+
+	return Bounds.ExpandBy(Query.Leeway).IsInsideOrOn(Query.ImpactLocation) ? EShooterLagCompensationResult::Confirmed : EShooterLagCompensationResult::Rejected;
+}
+
+EShooterLagCompensationResult UShooterLagCompensation::ValidateHit(const FShooterLagCompensationQuery& Query) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterLagCompensationValidate);
+
+	FFrameLookup Lookup;
+	if (!LagCompensationEnable || !FindFrames(Query.FireTime, Lookup))
+	{
+		return EShooterLagCompensationResult::NoHistory;
+	}
+
+	return ValidateHitWithFrames(Query, Lookup);
+}
+
+void UShooterLagCompensation::ValidateHits(TArrayView<const FShooterLagCompensationQuery> Queries, TArray<EShooterLagCompensationResult>& OutResults) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterLagCompensationValidate);
+
+	OutResults.Reset(Queries.Num());
+
+	FFrameLookup Lookup;
+	bool bHasLookup = false;
+	float LookupTime = -1.0f;
+
+	for (const FShooterLagCompensationQuery& Query : Queries)
+	{
+		if (!LagCompensationEnable)
+		{
+			OutResults.Add(EShooterLagCompensationResult::NoHistory);
+			continue;
+		}
+
+		// shots from one shooter share a fire time estimate, so the search usually runs once per shooter
+		if (Query.FireTime != LookupTime)
+		{
+			LookupTime = Query.FireTime;
+			bHasLookup = FindFrames(LookupTime, Lookup);
+		}
+
+		OutResults.Add(bHasLookup ? ValidateHitWithFrames(Query, Lookup) : EShooterLagCompensationResult::NoHistory);
+	}
+}
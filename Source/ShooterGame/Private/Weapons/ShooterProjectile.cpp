@@ -4,6 +4,9 @@
 #include "Weapons/ShooterProjectile.h"
 #include "Particles/ParticleSystemComponent.h"
 #include "Effects/ShooterExplosionEffect.h"
+#include "Effects/ShooterEffectManager.h"
+#include "Weapons/ShooterProjectilePool.h"
+#include "Weapons/ShooterRadialDamage.h"
 
 AShooterProjectile::AShooterProjectile(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
@@ -37,12 +40,23 @@ AShooterProjectile::AShooterProjectile(const FObjectInitializer& ObjectInitializ
 	SetRemoteRoleForBackwardsCompat(ROLE_SimulatedProxy);
 	bReplicates = true;
 	SetReplicatingMovement(true);
+
+	PoolGeneration = 0;
+	bExploded = false;
+	bPooled = false;
 }
 
 void AShooterProjectile::PostInitializeComponents()
 {
 	Super::PostInitializeComponents();
 	MovementComp->OnProjectileStop.AddDynamic(this, &AShooterProjectile::OnImpact);
+
+	InitFromOwner();
+}
+
+void AShooterProjectile::InitFromOwner()
+{
+	CollisionComp->MoveIgnoreActors.Reset();
 	CollisionComp->MoveIgnoreActors.Add(GetInstigator());
 
 	AShooterWeapon_Projectile* OwnerWeapon = Cast<AShooterWeapon_Projectile>(GetOwner());
@@ -55,6 +69,80 @@ void AShooterProjectile::PostInitializeComponents()
 	MyController = GetInstigatorController();
 }
 
+void AShooterProjectile::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (bPooled)
+	{
+		if (UShooterProjectilePool* Pool = UShooterProjectilePool::Get(this))
+		{
+			Pool->NotifyProjectileDestroyed(this);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AShooterProjectile::LifeSpanExpired()
+{
+	UShooterProjectilePool* Pool = bPooled ? UShooterProjectilePool::Get(this) : nullptr;
+	if (Pool)
+	{
+		Pool->ReleaseProjectile(this);
+	}
+	else
+	{
+		Super::LifeSpanExpired();
+	}
+}
+
+void AShooterProjectile::OnAcquiredFromPool(FVector& ShootDirection)
+{
+	SetNetDormancy(DORM_Awake);
+
+	PoolGeneration++;
+	bExploded = false;
+
+	ResetForReuse();
+	InitFromOwner();
+	InitVelocity(ShootDirection);
+}
+
+void AShooterProjectile::OnReleasedToPool()
+{
+	SetLifeSpan(0.0f);
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+	MovementComp->StopMovementImmediately();
+	MovementComp->SetComponentTickEnabled(false);
+	MyController.Reset();
+
+	// clients keep their copy while the channel sleeps, it's reopened on the same actor when fired again
+	SetNetDormancy(DORM_DormantAll);
+}
+
+void AShooterProjectile::ResetForReuse()
+{
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+
+	// stopping on impact detached the movement component
+	MovementComp->SetUpdatedComponent(CollisionComp);
+	MovementComp->SetComponentTickEnabled(true);
+
+	if (ParticleComp)
+	{
+		ParticleComp->Activate(true);
+	}
+
+	UAudioComponent* ProjAudioComp = FindComponentByClass<UAudioComponent>();
+	if (ProjAudioComp)
+	{
+		ProjAudioComp->Play();
+	}
+}
+
 void AShooterProjectile::InitVelocity(FVector& ShootDirection)
 {
 	if (MovementComp)
@@ -84,10 +172,23 @@ void AShooterProjectile::Explode(const FHitResult& Impact)
 
 	if (WeaponConfig.ExplosionDamage > 0 && WeaponConfig.ExplosionRadius > 0 && WeaponConfig.DamageType)
 	{
-		UGameplayStatics::ApplyRadialDamage(this, WeaponConfig.ExplosionDamage, NudgedImpactLocation, WeaponConfig.ExplosionRadius, WeaponConfig.DamageType, TArray<AActor*>(), this, MyController.Get());
+		UShooterRadialDamage* RadialDamage = UShooterRadialDamage::Get(this);
+		if (RadialDamage)
+		{
+			RadialDamage->ApplyRadialDamage(WeaponConfig.ExplosionDamage, NudgedImpactLocation, WeaponConfig.ExplosionRadius, WeaponConfig.DamageType, this, MyController.Get());
+		}
+		else
+		{
+			UGameplayStatics::ApplyRadialDamage(this, WeaponConfig.ExplosionDamage, NudgedImpactLocation, WeaponConfig.ExplosionRadius, WeaponConfig.DamageType, TArray<AActor*>(), this, MyController.Get());
+		}
 	}
 
-	if (ExplosionTemplate)
+	UShooterEffectManager* EffectManager = UShooterEffectManager::Get(this);
+	if (ExplosionTemplate && EffectManager)
+	{
+		EffectManager->PlayExplosionEffect(ExplosionTemplate, Impact, FTransform(Impact.ImpactNormal.Rotation(), NudgedImpactLocation));
+	}
+	else if (ExplosionTemplate && GetNetMode() != NM_DedicatedServer)
 	{
 		FTransform const SpawnTransform(Impact.ImpactNormal.Rotation(), NudgedImpactLocation);
 		AShooterExplosionEffect* const EffectActor = GetWorld()->SpawnActorDeferred<AShooterExplosionEffect>(ExplosionTemplate, SpawnTransform);
@@ -118,6 +219,12 @@ void AShooterProjectile::DisableAndDestroy()
 ///CODE_SNIPPET_START: AActor::GetActorLocation AActor::GetActorRotation
 void AShooterProjectile::OnRep_Exploded()
 {
+	// cleared when the projectile is reused, OnRep_PoolGeneration handles that
+	if (!bExploded)
+	{
+		return;
+	}
+
 	FVector ProjDirection = GetActorForwardVector();
 
 	const FVector StartTrace = GetActorLocation() - ProjDirection * 200;
@@ -135,6 +242,11 @@ void AShooterProjectile::OnRep_Exploded()
 }
 ///CODE_SNIPPET_END
 
+void AShooterProjectile::OnRep_PoolGeneration()
+{
+	ResetForReuse();
+}
+
 void AShooterProjectile::PostNetReceiveVelocity(const FVector& NewVelocity)
 {
 	if (MovementComp)
@@ -147,5 +259,6 @@ void AShooterProjectile::GetLifetimeReplicatedProps( TArray< FLifetimeProperty >
 {
 	Super::GetLifetimeReplicatedProps( OutLifetimeProps );
 	
+	DOREPLIFETIME( AShooterProjectile, PoolGeneration );
 	DOREPLIFETIME( AShooterProjectile, bExploded );
 }
\ No newline at end of file
@@ -0,0 +1,162 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Weapons/ShooterProjectilePool.h"
+#include "Weapons/ShooterProjectile.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Projectiles"), STAT_ShooterPooledProjectiles, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Free Pooled Projectiles"), STAT_ShooterFreePooledProjectiles, STATGROUP_ShooterGame);
+
+static int32 ProjectilePoolEnable = 1;
+FAutoConsoleVariableRef CVarProjectilePoolEnable(
+	TEXT("ShooterGame.ProjectilePool.Enable"),
+	ProjectilePoolEnable,
+	TEXT("Recycle projectiles instead of spawning and destroying one per shot."),
+	ECVF_Default);
+
+static int32 ProjectilePoolMaxFreePerClass = 32;
+FAutoConsoleVariableRef CVarProjectilePoolMaxFreePerClass(
+	TEXT("ShooterGame.ProjectilePool.MaxFreePerClass"),
+	ProjectilePoolMaxFreePerClass,
+	TEXT("Spent projectiles kept per class, any more are destroyed."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorld ProjectilePoolStatsCmd(
+	TEXT("ShooterGame.ProjectilePool.Stats"),
+	TEXT("Log projectile pool hit rate and size."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		if (UShooterProjectilePool* Pool = UShooterProjectilePool::Get(World))
+		{
+			Pool->LogStats();
+		}
+	}));
+
+UShooterProjectilePool::UShooterProjectilePool(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	NumAcquired = 0;
+	NumReused = 0;
+	PeakSize = 0;
+}
+
+UShooterProjectilePool* UShooterProjectilePool::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UShooterProjectilePool>() : nullptr;
+}
+
+bool UShooterProjectilePool::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UShooterProjectilePool::Deinitialize()
+{
+	if (NumAcquired > 0)
+	{
+		LogStats();
+	}
+
+	FreeProjectiles.Empty();
+	PooledProjectiles.Empty();
+
+	Super::Deinitialize();
+}
+
+AShooterProjectile* UShooterProjectilePool::AcquireProjectile(TSubclassOf<AShooterProjectile> ProjectileClass, const FTransform& SpawnTM, AActor* Weapon, FVector ShootDir)
+{
+	if (ProjectileClass == nullptr)
+	{
+		return nullptr;
+	}
+
+	NumAcquired++;
+
+	FShooterFreeProjectiles* FreeEntry = ProjectilePoolEnable ? FreeProjectiles.Find(ProjectileClass) : nullptr;
+	TArray<AShooterProjectile*>* FreeList = FreeEntry ? &FreeEntry->Projectiles : nullptr;
+	while (FreeList && FreeList->Num() > 0)
+	{
+		AShooterProjectile* Projectile = FreeList->Pop(false);
+		DEC_DWORD_STAT(STAT_ShooterFreePooledProjectiles);
+
+		if (!IsValid(Projectile))
+		{
+			continue;
+		}
+
+		Projectile->SetOwner(Weapon);
+		Projectile->SetInstigator(Weapon ? Weapon->GetInstigator() : nullptr);
+		Projectile->SetActorTransform(SpawnTM, false, nullptr, ETeleportType::ResetPhysics);
+		Projectile->OnAcquiredFromPool(ShootDir);
+
+		NumReused++;
+		return Projectile;
+	}
+
+	AShooterProjectile* Projectile = Cast<AShooterProjectile>(UGameplayStatics::BeginDeferredActorSpawnFromClass(this, ProjectileClass, SpawnTM));
+	if (Projectile)
+	{
+		Projectile->SetInstigator(Weapon ? Weapon->GetInstigator() : nullptr);
+		Projectile->SetOwner(Weapon);
+		Projectile->InitVelocity(ShootDir);
+
+		if (ProjectilePoolEnable)
+		{
+			Projectile->SetPooled();
+			PooledProjectiles.Add(Projectile);
+			PeakSize = FMath::Max(PeakSize, PooledProjectiles.Num());
+			INC_DWORD_STAT(STAT_ShooterPooledProjectiles);
+		}
+
+		UGameplayStatics::FinishSpawningActor(Projectile, SpawnTM);
+	}
+
+	return Projectile;
+}
+
+void UShooterProjectilePool::ReleaseProjectile(AShooterProjectile* Projectile)
+{
+	if (!IsValid(Projectile))
+	{
+		return;
+	}
+
+	TArray<AShooterProjectile*>& FreeList = FreeProjectiles.FindOrAdd(Projectile->GetClass()).Projectiles;
+	if (!ProjectilePoolEnable || FreeList.Num() >= ProjectilePoolMaxFreePerClass || !PooledProjectiles.Contains(Projectile))
+	{
+		Projectile->Destroy();
+		return;
+	}
+
+	Projectile->OnReleasedToPool();
+	FreeList.Add(Projectile);
+	INC_DWORD_STAT(STAT_ShooterFreePooledProjectiles);
+}
+
+void UShooterProjectilePool::NotifyProjectileDestroyed(AShooterProjectile* Projectile)
+{
+	if (PooledProjectiles.Remove(Projectile) > 0)
+	{
+		DEC_DWORD_STAT(STAT_ShooterPooledProjectiles);
+
+		FShooterFreeProjectiles* FreeEntry = FreeProjectiles.Find(Projectile->GetClass());
+		if (FreeEntry && FreeEntry->Projectiles.RemoveSingleSwap(Projectile, false) > 0)
+		{
+			DEC_DWORD_STAT(STAT_ShooterFreePooledProjectiles);
+		}
+	}
+}
+
+void UShooterProjectilePool::LogStats() const
+{
+	int32 NumFree = 0;
+	for (const TPair<UClass*, FShooterFreeProjectiles>& Pair : FreeProjectiles)
+	{
+		NumFree += Pair.Value.Projectiles.Num();
+	}
+
+	const float HitRate = NumAcquired > 0 ? (100.0f * NumReused) / NumAcquired : 0.0f;
+	UE_LOG(LogShooterWeapon, Log, TEXT("Projectile pool: %d requests, %.1f%% reused, %d owned (%d free), peak %d"),
+		NumAcquired, HitRate, PooledProjectiles.Num(), NumFree, PeakSize);
+}
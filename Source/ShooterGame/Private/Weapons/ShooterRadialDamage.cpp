@@ -0,0 +1,340 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ShooterGame.h"
+#include "Weapons/ShooterRadialDamage.h"
+#include "Player/ShooterPawnSpatialIndex.h"
+
+DECLARE_CYCLE_STAT(TEXT("Radial Damage"), STAT_ShooterRadialDamage, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Radial Damage Candidates"), STAT_ShooterRadialDamageCandidates, STATGROUP_ShooterGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Radial Damage Traces"), STAT_ShooterRadialDamageTraces, STATGROUP_ShooterGame);
+
+static float RadialDamageQueryPadding = 200.0f;
+FAutoConsoleVariableRef CVarRadialDamageQueryPadding(
+	TEXT("ShooterGame.RadialDamage.QueryPadding"),
+	RadialDamageQueryPadding,
+	TEXT("Added to the explosion radius when querying the pawn index, covers pawn size and movement since the index was built, in uu."),
+	ECVF_Default);
+
+static int32 RadialDamageOtherActors = 1;
+FAutoConsoleVariableRef CVarRadialDamageOtherActors(
+	TEXT("ShooterGame.RadialDamage.OtherActors"),
+	RadialDamageOtherActors,
+	TEXT("Also damage other dynamic actors in range (movers, physics bodies, destructibles), found with an overlap query. Shooter characters always come from the pawn index."),
+	ECVF_Default);
+
+static int32 RadialDamageAsyncTraces = 1;
+FAutoConsoleVariableRef CVarRadialDamageAsyncTraces(
+	TEXT("ShooterGame.RadialDamage.AsyncTraces"),
+	RadialDamageAsyncTraces,
+	TEXT("Run occlusion traces async and apply damage on the next tick. 0 traces and applies damage in the frame of the explosion."),
+	ECVF_Default);
+
+UShooterRadialDamage::UShooterRadialDamage(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	TraceDelegate.BindUObject(this, &UShooterRadialDamage::OnTraceCompleted);
+}
+
+UShooterRadialDamage* UShooterRadialDamage::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UShooterRadialDamage>() : nullptr;
+}
+
+bool UShooterRadialDamage::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UShooterRadialDamage::Deinitialize()
+{
+	PendingExplosions.Empty();
+	TracedExplosions.Empty();
+	Candidates.Empty();
+	CandidateX.Empty();
+	CandidateY.Empty();
+	CandidateZ.Empty();
+	CandidateRadius.Empty();
+	CandidateScale.Empty();
+	CandidateHits.Empty();
+	CandidateTraced.Empty();
+
+	Super::Deinitialize();
+}
+
+void UShooterRadialDamage::ApplyRadialDamage(float BaseDamage, const FVector& Origin, float Radius, TSubclassOf<UDamageType> DamageTypeClass, AActor* DamageCauser, AController* InstigatedBy)
+{
+	// clients replay explosions for effects only
+	if (GetWorld()->GetNetMode() == NM_Client || BaseDamage <= 0.0f || Radius <= 0.0f)
+	{
+		return;
+	}
+
+	FPendingExplosion& Explosion = PendingExplosions.AddDefaulted_GetRef();
+	Explosion.BaseDamage = BaseDamage;
+	Explosion.Origin = Origin;
+	Explosion.Radius = Radius;
+	Explosion.DamageTypeClass = DamageTypeClass ? DamageTypeClass : TSubclassOf<UDamageType>(UDamageType::StaticClass());
+	Explosion.DamageCauser = DamageCauser;
+	Explosion.InstigatedBy = InstigatedBy;
+	Explosion.FirstCandidate = 0;
+	Explosion.NumCandidates = 0;
+}
+
+void UShooterRadialDamage::AddCandidate(AActor* Actor, UPrimitiveComponent* Component)
+{
+	Candidates.Add({ Actor, Component });
+	CandidateX.Add(Component->Bounds.Origin.X);
+	CandidateY.Add(Component->Bounds.Origin.Y);
+	CandidateZ.Add(Component->Bounds.Origin.Z);
+	CandidateRadius.Add(Component->Bounds.SphereRadius);
+}
+
+void UShooterRadialDamage::GatherCandidates(FPendingExplosion& Explosion)
+{
+	Explosion.FirstCandidate = Candidates.Num();
+
+	UShooterPawnSpatialIndex* PawnIndex = UShooterPawnSpatialIndex::Get(this);
+	if (PawnIndex)
+	{
+		FShooterPawnQueryResults Pawns;
+		PawnIndex->FindPawnsInRadius(Explosion.Origin, Explosion.Radius + RadialDamageQueryPadding, Pawns);
+
+		for (const FShooterPawnQueryResult& Result : Pawns)
+		{
+			AShooterCharacter* Pawn = Result.Pawn;
+			if (Pawn && !Pawn->IsPendingKill() && Pawn->CanBeDamaged() && Pawn->GetCapsuleComponent())
+			{
+				AddCandidate(Pawn, Pawn->GetCapsuleComponent());
+			}
+		}
+	}
+
+	if (RadialDamageOtherActors)
+	{
+		// same object types the engine's radial damage overlaps, characters among them already came from the pawn index
+		const FCollisionObjectQueryParams ObjectParams(FCollisionObjectQueryParams::InitType::AllDynamicObjects);
+
+		TArray<FOverlapResult, TInlineAllocator<16>> Overlaps;
+		GetWorld()->OverlapMultiByObjectType(Overlaps, Explosion.Origin, FQuat::Identity, ObjectParams, FCollisionShape::MakeSphere(Explosion.Radius), FCollisionQueryParams(SCENE_QUERY_STAT(ShooterRadialDamage), false, Explosion.DamageCauser.Get()));
+
+		// components of an actor must be next to each other, see Flush
+		Overlaps.Sort([](const FOverlapResult& A, const FOverlapResult& B) { return A.GetActor() < B.GetActor(); });
+
+		for (const FOverlapResult& Overlap : Overlaps)
+		{
+			AActor* Actor = Overlap.GetActor();
+			UPrimitiveComponent* Component = Overlap.GetComponent();
+			if (Actor && Component && Actor->CanBeDamaged() && !Actor->IsA<AShooterCharacter>())
+			{
+				AddCandidate(Actor, Component);
+			}
+		}
+	}
+
+	Explosion.NumCandidates = Candidates.Num() - Explosion.FirstCandidate;
+}
+
+void UShooterRadialDamage::Flush()
+{
+	if (PendingExplosions.Num() == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterRadialDamage);
+
+	// the candidate arrays are reused, the previous batch must have been applied
+	check(TracedExplosions.Num() == 0);
+
+	TArray<FPendingExplosion> Explosions = MoveTemp(PendingExplosions);
+	PendingExplosions.Reset();
+
+	Candidates.Reset();
+	CandidateX.Reset();
+	CandidateY.Reset();
+	CandidateZ.Reset();
+	CandidateRadius.Reset();
+
+	for (FPendingExplosion& Explosion : Explosions)
+	{
+		GatherCandidates(Explosion);
+	}
+
+	INC_DWORD_STAT_BY(STAT_ShooterRadialDamageCandidates, Candidates.Num());
+
+	CandidateScale.SetNumUninitialized(Candidates.Num());
+	CandidateHits.SetNum(Candidates.Num());
+
+	// same linear falloff as UGameplayStatics::ApplyRadialDamage, from the closest point of the bounds
+	for (const FPendingExplosion& Explosion : Explosions)
+	{
+		const float OriginX = Explosion.Origin.X;
+		const float OriginY = Explosion.Origin.Y;
+		const float OriginZ = Explosion.Origin.Z;
+		const float InvRadius = 1.0f / Explosion.Radius;
+
+		const float* RESTRICT X = CandidateX.GetData();
+		const float* RESTRICT Y = CandidateY.GetData();
+		const float* RESTRICT Z = CandidateZ.GetData();
+		const float* RESTRICT R = CandidateRadius.GetData();
+		float* RESTRICT Scale = CandidateScale.GetData();
+
+		const int32 EndCandidate = Explosion.FirstCandidate + Explosion.NumCandidates;
+		for (int32 i = Explosion.FirstCandidate; i < EndCandidate; i++)
+		{
+			const float DX = X[i] - OriginX;
+			const float DY = Y[i] - OriginY;
+			const float DZ = Z[i] - OriginZ;
+			const float Dist = FMath::Sqrt(DX * DX + DY * DY + DZ * DZ) - R[i];
+			Scale[i] = FMath::Clamp(1.0f - Dist * InvRadius, 0.0f, 1.0f);
+		}
+	}
+
+	// occlusion traces of every explosion in one batch, see UGameplayStatics' ComponentIsDamageableFrom
+	UWorld* World = GetWorld();
+	const bool bAsyncTraces = RadialDamageAsyncTraces != 0;
+	CandidateTraced.Init(false, Candidates.Num());
+
+	for (const FPendingExplosion& Explosion : Explosions)
+	{
+		const FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(ShooterRadialDamage), true, Explosion.DamageCauser.Get());
+
+		const int32 EndCandidate = Explosion.FirstCandidate + Explosion.NumCandidates;
+		for (int32 i = Explosion.FirstCandidate; i < EndCandidate; i++)
+		{
+			if (CandidateScale[i] <= 0.0f)
+			{
+				continue;
+			}
+
+			FVector TraceEnd = Candidates[i].Component->Bounds.Origin;
+			if (TraceEnd == Explosion.Origin)
+			{
+				TraceEnd.Z += 0.01f;
+			}
+
+			INC_DWORD_STAT(STAT_ShooterRadialDamageTraces);
+
+			// the fake hit stands when nothing is in the way
+			const FVector FakeHitNormal = (Explosion.Origin - TraceEnd).GetSafeNormal();
+			CandidateHits[i] = FHitResult(Candidates[i].Actor.Get(), Candidates[i].Component.Get(), TraceEnd, FakeHitNormal);
+
+			if (bAsyncTraces)
+			{
+				World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Explosion.Origin, TraceEnd, ECC_Visibility, TraceParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, i);
+			}
+			else
+			{
+				FHitResult Hit;
+				const bool bHit = World->LineTraceSingleByChannel(Hit, Explosion.Origin, TraceEnd, ECC_Visibility, TraceParams);
+				SetTraceResult(i, bHit ? &Hit : nullptr);
+			}
+		}
+	}
+
+	TracedExplosions = MoveTemp(Explosions);
+
+	if (!bAsyncTraces)
+	{
+		ApplyTracedDamage();
+	}
+}
+
+void UShooterRadialDamage::OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	const int32 CandidateIndex = (int32)Datum.UserData;
+	if (CandidateTraced.IsValidIndex(CandidateIndex) && !CandidateTraced[CandidateIndex])
+	{
+		SetTraceResult(CandidateIndex, Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit ? &Datum.OutHits[0] : nullptr);
+	}
+}
+
+void UShooterRadialDamage::SetTraceResult(int32 CandidateIndex, const FHitResult* Hit)
+{
+	CandidateTraced[CandidateIndex] = true;
+
+	if (Hit)
+	{
+		// pawn capsules ignore visibility, so the trace stops at the mesh of the same actor
+		if (Hit->GetActor() == Candidates[CandidateIndex].Actor.Get())
+		{
+			CandidateHits[CandidateIndex] = *Hit;
+		}
+		else
+		{
+			// something in the way
+			CandidateScale[CandidateIndex] = 0.0f;
+		}
+	}
+}
+
+void UShooterRadialDamage::ApplyTracedDamage()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterRadialDamage);
+
+	// damage below can queue more explosions, they go out with the next flush
+	TArray<FPendingExplosion> Explosions = MoveTemp(TracedExplosions);
+	TracedExplosions.Reset();
+
+	for (const FPendingExplosion& Explosion : Explosions)
+	{
+		FRadialDamageEvent DamageEvent;
+		DamageEvent.DamageTypeClass = Explosion.DamageTypeClass;
+		DamageEvent.Origin = Explosion.Origin;
+		DamageEvent.Params = FRadialDamageParams(Explosion.BaseDamage, 0.0f, 0.0f, Explosion.Radius, 1.0f);
+
+		AController* InstigatedBy = Explosion.InstigatedBy.Get();
+		AActor* DamageCauser = Explosion.DamageCauser.Get();
+
+		// one event per actor with all of its visible components, candidates of an actor are next to each other
+		const int32 EndCandidate = Explosion.FirstCandidate + Explosion.NumCandidates;
+		for (int32 i = Explosion.FirstCandidate; i < EndCandidate; )
+		{
+			const TWeakObjectPtr<AActor> Victim = Candidates[i].Actor;
+
+			DamageEvent.ComponentHits.Reset();
+			for (; i < EndCandidate && Candidates[i].Actor == Victim; i++)
+			{
+				// a trace that never came back counts as blocked
+				if (CandidateScale[i] > 0.0f && CandidateTraced[i])
+				{
+					DamageEvent.ComponentHits.Add(CandidateHits[i]);
+				}
+			}
+
+			// it may have been destroyed while its trace was in flight, or by earlier damage
+			AActor* VictimActor = Victim.Get();
+			if (DamageEvent.ComponentHits.Num() > 0 && IsValid(VictimActor))
+			{
+				VictimActor->TakeDamage(Explosion.BaseDamage, DamageEvent, InstigatedBy, DamageCauser);
+			}
+		}
+	}
+}
+
+void UShooterRadialDamage::Tick(float DeltaTime)
+{
+	// last frame's traces were delivered at the start of this one
+	if (TracedExplosions.Num() > 0)
+	{
+		ApplyTracedDamage();
+	}
+
+	Flush();
+}
+
+bool UShooterRadialDamage::IsTickable() const
+{
+	return PendingExplosions.Num() > 0 || TracedExplosions.Num() > 0;
+}
+
+TStatId UShooterRadialDamage::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterRadialDamage, STATGROUP_Tickables);
+}
+
+UWorld* UShooterRadialDamage::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
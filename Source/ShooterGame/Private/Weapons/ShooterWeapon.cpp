@@ -9,6 +9,27 @@
 #include "UI/ShooterHUD.h"
 #include "MatineeCameraShake.h"
 
+static float FireClockSyncInterval = 0.25f;
+FAutoConsoleVariableRef CVarFireClockSyncInterval(
+	TEXT("ShooterGame.FireClock.SyncInterval"),
+	FireClockSyncInterval,
+	TEXT("Seconds between shot count updates sent to the server during sustained fire, 0 to only send it when fire stops."),
+	ECVF_Default);
+
+static float FireClockTimeTolerance = 0.25f;
+FAutoConsoleVariableRef CVarFireClockTimeTolerance(
+	TEXT("ShooterGame.FireClock.TimeTolerance"),
+	FireClockTimeTolerance,
+	TEXT("Seconds a client's fire duration may exceed the one measured by the server."),
+	ECVF_Default);
+
+static int32 FireClockMaxCatchupShots = 3;
+FAutoConsoleVariableRef CVarFireClockMaxCatchupShots(
+	TEXT("ShooterGame.FireClock.MaxCatchupShots"),
+	FireClockMaxCatchupShots,
+	TEXT("Shots the server fire clock fires in one update when it falls behind."),
+	ECVF_Default);
+
 AShooterWeapon::AShooterWeapon(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
 	Mesh1P = ObjectInitializer.CreateDefaultSubobject<USkeletalMeshComponent>(this, TEXT("WeaponMesh1P"));
@@ -46,6 +67,16 @@ AShooterWeapon::AShooterWeapon(const FObjectInitializer& ObjectInitializer) : Su
 	BurstCounter = 0;
 	LastFireTime = 0.0f;
 
+	ClientShotsFired = 0;
+	ClientFireStartTime = 0.0f;
+	LastFireSyncTime = 0.0f;
+	ServerFireStartClientTime = 0.0f;
+	ServerFireStartTime = 0.0f;
+	ServerShotsFired = 0;
+	ServerConfirmedShots = 0;
+	ServerBurstStartTime = 0.0f;
+	ServerBurstShots = 0;
+
 	PrimaryActorTick.bCanEverTick = true;
 	PrimaryActorTick.TickGroup = TG_PrePhysics;
 	SetRemoteRoleForBackwardsCompat(ROLE_SimulatedProxy);
@@ -180,6 +211,18 @@ void AShooterWeapon::OnLeaveInventory()
 	}
 }
 
+void AShooterWeapon::ResetForReuse()
+{
+	CurrentAmmoInClip = 0;
+	CurrentAmmo = 0;
+
+	if (WeaponConfig.InitialClips > 0)
+	{
+		CurrentAmmoInClip = WeaponConfig.AmmoPerClip;
+		CurrentAmmo = WeaponConfig.AmmoPerClip * WeaponConfig.InitialClips;
+	}
+}
+
 void AShooterWeapon::AttachMeshToPawn()
 {
 	if (MyPawn)
@@ -225,7 +268,14 @@ void AShooterWeapon::StartFire()
 {
 	if (GetLocalRole() < ROLE_Authority)
 	{
-		ServerStartFire();
+		if (!bWantsToFire)
+		{
+			ClientShotsFired = 0;
+			ClientFireStartTime = GetWorld()->GetTimeSeconds();
+			LastFireSyncTime = ClientFireStartTime;
+		}
+
+		ServerStartFire(ClientFireStartTime);
 	}
 
 	if (!bWantsToFire)
@@ -239,7 +289,7 @@ void AShooterWeapon::StopFire()
 {
 	if ((GetLocalRole() < ROLE_Authority) && MyPawn && MyPawn->IsLocallyControlled())
 	{
-		ServerStopFire();
+		ServerStopFire(GetWorld()->GetTimeSeconds(), ClientShotsFired);
 	}
 
 	if (bWantsToFire)
@@ -290,26 +340,53 @@ void AShooterWeapon::StopReload()
 	}
 }
 
-bool AShooterWeapon::ServerStartFire_Validate()
+bool AShooterWeapon::ServerStartFire_Validate(float ClientTime)
 {
 	return true;
 }
 
-void AShooterWeapon::ServerStartFire_Implementation()
+void AShooterWeapon::ServerStartFire_Implementation(float ClientTime)
 {
+	if (!bWantsToFire)
+	{
+		ServerFireStartClientTime = ClientTime;
+		ServerFireStartTime = GetWorld()->GetTimeSeconds();
+		ServerShotsFired = 0;
+		ServerConfirmedShots = 0;
+	}
+
 	StartFire();
 }
 
-bool AShooterWeapon::ServerStopFire_Validate()
+bool AShooterWeapon::ServerStopFire_Validate(float ClientTime, int32 ShotsFired)
 {
-	return true;
+	return ShotsFired >= 0;
 }
 
-void AShooterWeapon::ServerStopFire_Implementation()
+void AShooterWeapon::ServerStopFire_Implementation(float ClientTime, int32 ShotsFired)
 {
+	if (bWantsToFire)
+	{
+		ReconcileServerShots(ClientTime, ShotsFired, true);
+	}
+
 	StopFire();
 }
 
+bool AShooterWeapon::ServerSyncFire_Validate(float ClientTime, int32 ShotsFired)
+{
+	return ShotsFired >= 0;
+}
+
+void AShooterWeapon::ServerSyncFire_Implementation(float ClientTime, int32 ShotsFired)
+{
+	// may arrive after the reliable stop
+	if (bWantsToFire)
+	{
+		ReconcileServerShots(ClientTime, ShotsFired, false);
+	}
+}
+
 bool AShooterWeapon::ServerStartReload_Validate()
 {
 	return true;
@@ -446,6 +523,8 @@ void AShooterWeapon::HandleFiring()
 			
 			// update firing FX on remote clients if function was called on server
 			BurstCounter++;
+
+			ClientShotsFired++;
 		}
 	}
 	else if (CanReload())
@@ -478,10 +557,11 @@ void AShooterWeapon::HandleFiring()
 
 	if (MyPawn && MyPawn->IsLocallyControlled())
 	{
-		// local client will notify server
-		if (GetLocalRole() < ROLE_Authority)
+		// the server simulates the burst on its own, only correct it now and then
+		if (GetLocalRole() < ROLE_Authority && FireClockSyncInterval > 0.0f && GetWorld()->GetTimeSeconds() - LastFireSyncTime >= FireClockSyncInterval)
 		{
-			ServerHandleFiring();
+			LastFireSyncTime = GetWorld()->GetTimeSeconds();
+			ServerSyncFire(LastFireSyncTime, ClientShotsFired);
 		}
 
 		// reload after firing last round
@@ -502,24 +582,134 @@ void AShooterWeapon::HandleFiring()
 	LastFireTime = GetWorld()->GetTimeSeconds();
 }
 
-bool AShooterWeapon::ServerHandleFiring_Validate()
+bool AShooterWeapon::UsesServerFireClock() const
 {
-	return true;
+	return GetLocalRole() == ROLE_Authority && MyPawn && !MyPawn->IsLocallyControlled();
 }
 
-void AShooterWeapon::ServerHandleFiring_Implementation()
+void AShooterWeapon::HandleServerFireClock()
 {
-	const bool bShouldUpdateAmmo = (CurrentAmmoInClip > 0 && CanFire());
+	const float GameTime = GetWorld()->GetTimeSeconds();
 
-	HandleFiring();
+	int32 NumShots = 1;
+	if (bAllowAutomaticWeaponCatchup && WeaponConfig.TimeBetweenShots > 0.0f)
+	{
+		// shots due since the burst started, whether or not the timer kept up
+		const int32 ShotsDue = FMath::FloorToInt((GameTime - ServerBurstStartTime) / WeaponConfig.TimeBetweenShots) + 1;
+		NumShots = FMath::Clamp(ShotsDue - ServerBurstShots, 0, FMath::Max(1, FireClockMaxCatchupShots));
+	}
 
-	if (bShouldUpdateAmmo)
+	for (int32 i = 0; i < NumShots; i++)
 	{
-		// update ammo
+		if (!FireServerShot())
+		{
+			return;
+		}
+	}
+
+	if (CurrentState == EWeaponState::Firing && WeaponConfig.TimeBetweenShots > 0.0f)
+	{
+		const float NextShotTime = bAllowAutomaticWeaponCatchup ? ServerBurstStartTime + ServerBurstShots * WeaponConfig.TimeBetweenShots : GameTime + WeaponConfig.TimeBetweenShots;
+		GetWorldTimerManager().SetTimer(TimerHandle_HandleFiring, this, &AShooterWeapon::HandleServerFireClock, FMath::Max<float>(NextShotTime - GameTime, SMALL_NUMBER), false);
+	}
+}
+
+bool AShooterWeapon::FireServerShot()
+{
+	if ((CurrentAmmoInClip > 0 || HasInfiniteClip() || HasInfiniteAmmo()) && CanFire())
+	{
+		if (GetNetMode() != NM_DedicatedServer)
+		{
+			SimulateWeaponFire();
+		}
+
 		UseAmmo();
 
 		// update firing FX on remote clients
 		BurstCounter++;
+
+		ServerBurstShots++;
+		ServerShotsFired++;
+		LastFireTime = GetWorld()->GetTimeSeconds();
+
+		// reload after firing last round, like the client does
+		if (CurrentAmmoInClip <= 0 && CanReload())
+		{
+			StartReload();
+			return false;
+		}
+
+		return true;
+	}
+
+	if (CanReload())
+	{
+		StartReload();
+	}
+	else if (BurstCounter > 0)
+	{
+		// stop weapon fire FX, but stay in Firing state
+		OnBurstFinished();
+	}
+
+	return false;
+}
+
+void AShooterWeapon::ReconcileServerShots(float ClientTime, int32 ClientShots, bool bFireStopped)
+{
+	if (!UsesServerFireClock())
+	{
+		return;
+	}
+
+	// the client can't have been firing for much longer than the server saw
+	const float ServerElapsed = GetWorld()->GetTimeSeconds() - ServerFireStartTime;
+	const float ClientElapsed = FMath::Clamp(ClientTime - ServerFireStartClientTime, 0.0f, ServerElapsed + FireClockTimeTolerance);
+	const int32 MaxShots = WeaponConfig.TimeBetweenShots > 0.0f ? FMath::FloorToInt(ClientElapsed / WeaponConfig.TimeBetweenShots) + 1 : 1;
+	const int32 TargetShots = FMath::Min(ClientShots, MaxShots);
+
+	// behind the client, e.g. the start was delayed more than the stop
+	while (ServerShotsFired < TargetShots && CurrentState == EWeaponState::Firing)
+	{
+		if (!FireServerShot())
+		{
+			break;
+		}
+	}
+
+	if (!bFireStopped)
+	{
+		ServerConfirmedShots = FMath::Max(ServerConfirmedShots, FMath::Min(ServerShotsFired, TargetShots));
+		return;
+	}
+
+	// ahead of the client, the stop took longer to arrive than the start. The count comes from the client, so only shots it hasn't
+	// confirmed yet and that fit in the time the stop could have been on its way are given back.
+	if (ServerShotsFired > TargetShots)
+	{
+		const APlayerState* PlayerState = MyPawn ? MyPawn->GetPlayerState() : nullptr;
+		const float StopDelay = (PlayerState ? PlayerState->ExactPing * 0.0005f : 0.0f) + FireClockTimeTolerance;
+		const int32 MaxInFlightShots = WeaponConfig.TimeBetweenShots > 0.0f ? FMath::FloorToInt(StopDelay / WeaponConfig.TimeBetweenShots) + 1 : 1;
+
+		const int32 NumRefunded = FMath::Min3(ServerShotsFired - TargetShots, ServerShotsFired - ServerConfirmedShots, MaxInFlightShots);
+		if (NumRefunded > 0)
+		{
+			RefundAmmo(NumRefunded);
+			ServerShotsFired -= NumRefunded;
+		}
+	}
+}
+
+void AShooterWeapon::RefundAmmo(int32 Amount)
+{
+	if (!HasInfiniteAmmo())
+	{
+		CurrentAmmoInClip = FMath::Min(CurrentAmmoInClip + Amount, WeaponConfig.AmmoPerClip);
+	}
+
+	if (!HasInfiniteAmmo() && !HasInfiniteClip())
+	{
+		CurrentAmmo = FMath::Min(CurrentAmmo + Amount, WeaponConfig.MaxAmmo);
 	}
 }
 
@@ -594,6 +784,26 @@ void AShooterWeapon::OnBurstStarted()
 {
 	// start firing, can be delayed to satisfy TimeBetweenShots
 	const float GameTime = GetWorld()->GetTimeSeconds();
+
+	// remote clients only tell the server when they start and stop, it times the shots itself
+	if (UsesServerFireClock())
+	{
+		ServerBurstStartTime = GameTime;
+		ServerBurstShots = 0;
+
+		if (LastFireTime > 0 && WeaponConfig.TimeBetweenShots > 0.0f &&
+			LastFireTime + WeaponConfig.TimeBetweenShots > GameTime)
+		{
+			ServerBurstStartTime = LastFireTime + WeaponConfig.TimeBetweenShots;
+			GetWorldTimerManager().SetTimer(TimerHandle_HandleFiring, this, &AShooterWeapon::HandleServerFireClock, ServerBurstStartTime - GameTime, false);
+		}
+		else
+		{
+			HandleServerFireClock();
+		}
+		return;
+	}
+
 	if (LastFireTime > 0 && WeaponConfig.TimeBetweenShots > 0.0f &&
 		LastFireTime + WeaponConfig.TimeBetweenShots > GameTime)
 	{
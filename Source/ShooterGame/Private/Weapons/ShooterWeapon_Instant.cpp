@@ -4,10 +4,98 @@
 #include "Weapons/ShooterWeapon_Instant.h"
 #include "Particles/ParticleSystemComponent.h"
 #include "Effects/ShooterImpactEffect.h"
+#include "Effects/ShooterEffectManager.h"
+#include "Effects/ShooterTracerManager.h"
+#include "Weapons/ShooterLagCompensation.h"
+
+static float HitReportsBatchInterval = 0.03f;
+FAutoConsoleVariableRef CVarHitReportsBatchInterval(
+	TEXT("ShooterGame.HitReports.BatchInterval"),
+	HitReportsBatchInterval,
+	TEXT("Seconds client hit reports are collected before being sent to the server as one batch."),
+	ECVF_Default);
+
+static int32 HitReportsMaxPerBatch = 8;
+FAutoConsoleVariableRef CVarHitReportsMaxPerBatch(
+	TEXT("ShooterGame.HitReports.MaxPerBatch"),
+	HitReportsMaxPerBatch,
+	TEXT("Hit reports per batch, a full batch is sent right away. Clamped to HitReportsBatchLimit."),
+	ECVF_Default);
+
+/** most reports a valid batch can hold, larger batches disconnect the client */
+static const int32 HitReportsBatchLimit = 32;
+
+static float HitReportsResendInterval = 0.1f;
+FAutoConsoleVariableRef CVarHitReportsResendInterval(
+	TEXT("ShooterGame.HitReports.ResendInterval"),
+	HitReportsResendInterval,
+	TEXT("Seconds before an unacknowledged hit report batch is sent again."),
+	ECVF_Default);
+
+static float HitReportsAgeTolerance = 0.05f;
+FAutoConsoleVariableRef CVarHitReportsAgeTolerance(
+	TEXT("ShooterGame.HitReports.AgeTolerance"),
+	HitReportsAgeTolerance,
+	TEXT("Network jitter allowed on the age of a hit report over what the server measured between batches. Older reports are rejected."),
+	ECVF_Default);
+
+static float HitReportsMaxAge = 0.5f;
+FAutoConsoleVariableRef CVarHitReportsMaxAge(
+	TEXT("ShooterGame.HitReports.MaxAge"),
+	HitReportsMaxAge,
+	TEXT("Hit reports not acknowledged this many seconds after the shot are dropped."),
+	ECVF_Default);
+
+bool FShooterHitReport::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	uint8 Flags = bHasTarget ? 1 : 0;
+	Ar.SerializeBits(&Flags, 1);
+	bHasTarget = (Flags & 1) != 0;
+
+	bOutSuccess = true;
+
+	if (bHasTarget)
+	{
+		UObject* TargetObject = Target.Get();
+		bOutSuccess &= Map && Map->SerializeObject(Ar, AActor::StaticClass(), TargetObject);
+		if (Ar.IsLoading())
+		{
+			Target = Cast<AActor>(TargetObject);
+		}
+	}
+	else if (Ar.IsLoading())
+	{
+		Target = nullptr;
+	}
+
+	// world space, an offset from the target would only be checked against itself
+	bOutSuccess &= SerializePackedVector<10, 24>(ImpactPoint, Ar);
+
+	// only used for effects
+	bOutSuccess &= SerializeFixedVector<1, 8>(ImpactNormal, Ar);
+
+	uint32 PackedHitZone = HitZone;
+	Ar.SerializeIntPacked(PackedHitZone);
+	HitZone = (uint16)PackedHitZone;
+
+	Ar << RandomSeed;
+	Ar << ReticleSpread;
+	Ar << Age;
+
+	return true;
+}
 
 AShooterWeapon_Instant::AShooterWeapon_Instant(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
 	CurrentFiringSpread = 0.0f;
+	TracerMesh = nullptr;
+	TracerMaterial = nullptr;
+
+	NextHitReportSequence = 0;
+	LastReceivedHitSequence = 0;
+	ReceivedHitSequenceMask = 0;
+	bReceivedHitReports = false;
+	LastHitBatchReceiveTime = 0.0f;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -31,12 +119,158 @@ void AShooterWeapon_Instant::FireWeapon()
 	CurrentFiringSpread = FMath::Min(InstantConfig.FiringSpreadMax, CurrentFiringSpread + InstantConfig.FiringSpreadIncrement);
 }
 
-bool AShooterWeapon_Instant::ServerNotifyHit_Validate(const FHitResult& Impact, FVector_NetQuantizeNormal ShootDir, int32 RandomSeed, float ReticleSpread)
+bool AShooterWeapon_Instant::ServerNotifyHit_Validate(const FShooterHitReportBatch& Batch)
+{
+	return Batch.Reports.Num() <= HitReportsBatchLimit;
+}
+
+void AShooterWeapon_Instant::ServerNotifyHit_Implementation(const FShooterHitReportBatch& Batch)
+{
+	// duplicates are acknowledged too, the previous ack may have been lost
+	ClientAckHitReports(Batch.Sequence);
+
+	// measured before the batch is recorded, it's the gap to the previous one
+	const float MaxReportAge = GetMaxHitReportAge();
+
+	if (!MarkHitReportsReceived(Batch.Sequence))
+	{
+		return;
+	}
+
+	LastHitBatchReceiveTime = GetWorld()->GetTimeSeconds();
+
+	UShooterLagCompensation* LagCompensation = UShooterLagCompensation::Get(this);
+	const float EstimatedSendTime = LagCompensation ? LagCompensation->GetEstimatedFireTime(GetInstigatorController()) : 0.0f;
+
+	// anything past the batch size is dropped
+	const int32 NumReports = FMath::Min(Batch.Reports.Num(), FMath::Clamp(HitReportsMaxPerBatch, 1, HitReportsBatchLimit));
+	const float MaxRewindTime = UShooterLagCompensation::GetMaxRewindTime();
+
+	TArray<FShooterLagCompensationQuery, TInlineAllocator<8>> Queries;
+	for (int32 i = 0; i < NumReports; i++)
+	{
+		const FShooterHitReport& Report = Batch.Reports[i];
+
+		FShooterLagCompensationQuery& Query = Queries.AddDefaulted_GetRef();
+		Query.Target = Report.Target.Get();
+		Query.ImpactLocation = Report.ImpactPoint;
+		Query.FireTime = EstimatedSendTime - FMath::Min(Report.GetAgeSeconds(), MaxRewindTime);
+		Query.Leeway = InstantConfig.LagCompensationLeeway;
+	}
+
+	// all hits of the batch in one pass
+	TArray<EShooterLagCompensationResult> Results;
+	if (LagCompensation)
+	{
+		LagCompensation->ValidateHits(Queries, Results);
+	}
+	else
+	{
+		Results.Init(EShooterLagCompensationResult::NoHistory, Queries.Num());
+	}
+
+	for (int32 i = 0; i < NumReports; i++)
+	{
+		const FShooterHitReport& Report = Batch.Reports[i];
+
+		// target went away before the report arrived
+		if (Report.bHasTarget && !Report.Target.IsValid())
+		{
+			continue;
+		}
+
+		// an inflated age would rewind the target further back than the shot could have been
+		if (Report.GetAgeSeconds() > MaxReportAge)
+		{
+			UE_LOG(LogShooterWeapon, Log, TEXT("%s Rejected client side hit of %s (claimed age %.3f over %.3f)"), *GetNameSafe(this), *GetNameSafe(Report.Target.Get()), Report.GetAgeSeconds(), MaxReportAge);
+			continue;
+		}
+
+		ValidateClientHit(DecodeHitReport(Report), Report.RandomSeed, Report.GetReticleSpread(), Results[i]);
+	}
+}
+
+void AShooterWeapon_Instant::ClientAckHitReports_Implementation(uint16 Sequence)
+{
+	PendingHitBatches.RemoveAll([Sequence](const FPendingHitBatch& Pending) { return Pending.Batch.Sequence == Sequence; });
+}
+
+bool AShooterWeapon_Instant::MarkHitReportsReceived(uint16 Sequence)
 {
+	if (!bReceivedHitReports)
+	{
+		bReceivedHitReports = true;
+		LastReceivedHitSequence = Sequence;
+		ReceivedHitSequenceMask = 0;
+		return true;
+	}
+
+	const int32 Delta = (int16)(Sequence - LastReceivedHitSequence);
+	if (Delta > 0)
+	{
+		// bit N stands for LastReceivedHitSequence - N - 1
+		ReceivedHitSequenceMask = (Delta < 32 ? ReceivedHitSequenceMask << Delta : 0) | (Delta <= 32 ? 1u << (Delta - 1) : 0);
+		LastReceivedHitSequence = Sequence;
+		return true;
+	}
+
+	const int32 Back = -Delta;
+	if (Back == 0 || Back > 32)
+	{
+		return false;
+	}
+
+	const uint32 Bit = 1u << (Back - 1);
+	if (ReceivedHitSequenceMask & Bit)
+	{
+		return false;
+	}
+
+	ReceivedHitSequenceMask |= Bit;
 	return true;
 }
 
-void AShooterWeapon_Instant::ServerNotifyHit_Implementation(const FHitResult& Impact, FVector_NetQuantizeNormal ShootDir, int32 RandomSeed, float ReticleSpread)
+float AShooterWeapon_Instant::GetMaxHitReportAge() const
+{
+	// Every shot of a batch was fired after the previous batch was flushed, so it can't be older than the time between the two
+	// arriving, plus the batch interval in case the previous one only got through on a resend. Reports of the first batch can only
+	// have waited for its flush, and after a pause no more than the resend window is allowed.
+	const float BatchGap = bReceivedHitReports ? GetWorld()->GetTimeSeconds() - LastHitBatchReceiveTime : 0.0f;
+	return FMath::Max(0.0f, HitReportsBatchInterval) + FMath::Min(BatchGap, HitReportsMaxAge) + HitReportsAgeTolerance;
+}
+
+FHitResult AShooterWeapon_Instant::DecodeHitReport(const FShooterHitReport& Report) const
+{
+	AActor* Target = Report.Target.Get();
+
+	FHitResult Impact;
+	Impact.bBlockingHit = true;
+	Impact.Actor = Target;
+	Impact.ImpactPoint = Report.ImpactPoint;
+	Impact.ImpactNormal = Report.ImpactNormal;
+	Impact.Normal = Report.ImpactNormal;
+	Impact.Location = Impact.ImpactPoint;
+
+	const ACharacter* TargetCharacter = Cast<ACharacter>(Target);
+	if (TargetCharacter && TargetCharacter->GetMesh())
+	{
+		Impact.Component = TargetCharacter->GetMesh();
+		if (Report.HitZone > 0)
+		{
+			Impact.BoneName = TargetCharacter->GetMesh()->GetBoneName(Report.HitZone - 1);
+		}
+	}
+	else if (Target)
+	{
+		Impact.Component = Cast<UPrimitiveComponent>(Target->GetRootComponent());
+	}
+
+	Impact.TraceStart = GetMuzzleLocation();
+	Impact.TraceEnd = Impact.ImpactPoint;
+	return Impact;
+}
+
+void AShooterWeapon_Instant::ValidateClientHit(const FHitResult& Impact, int32 RandomSeed, float ReticleSpread, EShooterLagCompensationResult LagCompensationResult)
 {
 	const float WeaponAngleDot = FMath::Abs(FMath::Sin(ReticleSpread * PI / 180.f));
 
@@ -50,44 +284,34 @@ void AShooterWeapon_Instant::ServerNotifyHit_Implementation(const FHitResult& Im
 		const float ViewDotHitDir = FVector::DotProduct(GetInstigator()->GetViewRotation().Vector(), ViewDir);
 		if (ViewDotHitDir > InstantConfig.AllowedViewDotHitDir - WeaponAngleDot)
 		{
-			if (CurrentState != EWeaponState::Idle)
+			// reports are batched, so the last ones can arrive after the server saw fire stop
+			if (CurrentState != EWeaponState::Idle || GetWorld()->GetTimeSeconds() - LastFireTime < HitReportsMaxAge)
 			{
 				if (Impact.GetActor() == NULL)
 				{
 					if (Impact.bBlockingHit)
 					{
-						ProcessInstantHit_Confirmed(Impact, Origin, ShootDir, RandomSeed, ReticleSpread);
+						ProcessInstantHit_Confirmed(Impact, Origin, ViewDir, RandomSeed, ReticleSpread);
 					}
 				}
 				// assume it told the truth about static things because the don't move and the hit 
 				// usually doesn't have significant gameplay implications
 				else if (Impact.GetActor()->IsRootComponentStatic() || Impact.GetActor()->IsRootComponentStationary())
 				{
-					ProcessInstantHit_Confirmed(Impact, Origin, ShootDir, RandomSeed, ReticleSpread);
+					ProcessInstantHit_Confirmed(Impact, Origin, ViewDir, RandomSeed, ReticleSpread);
 				}
 				else
 				{
-					// Get the component bounding box
-					const FBox HitBox = Impact.GetActor()->GetComponentsBoundingBox();
-
-					// calculate the box extent, and increase by a leeway
-					FVector BoxExtent = 0.5 * (HitBox.Max - HitBox.Min);
-					BoxExtent *= InstantConfig.ClientSideHitLeeway;
-
-					// avoid precision errors with really thin objects
-					BoxExtent.X = FMath::Max(20.0f, BoxExtent.X);
-					BoxExtent.Y = FMath::Max(20.0f, BoxExtent.Y);
-					BoxExtent.Z = FMath::Max(20.0f, BoxExtent.Z);
-
-					// Get the box center
-					const FVector BoxCenter = (HitBox.Min + HitBox.Max) * 0.5;
+					// checked against where the target was when the client fired
+					EShooterLagCompensationResult Result = LagCompensationResult;
+					if (Result == EShooterLagCompensationResult::NoHistory)
+					{
+						Result = IsWithinClientSideHitLeeway(Impact) ? EShooterLagCompensationResult::Confirmed : EShooterLagCompensationResult::Rejected;
+					}
 
-					// if we are within client tolerance
-					if (FMath::Abs(Impact.Location.Z - BoxCenter.Z) < BoxExtent.Z &&
-						FMath::Abs(Impact.Location.X - BoxCenter.X) < BoxExtent.X &&
-						FMath::Abs(Impact.Location.Y - BoxCenter.Y) < BoxExtent.Y)
+					if (Result == EShooterLagCompensationResult::Confirmed)
 					{
-						ProcessInstantHit_Confirmed(Impact, Origin, ShootDir, RandomSeed, ReticleSpread);
+						ProcessInstantHit_Confirmed(Impact, Origin, ViewDir, RandomSeed, ReticleSpread);
 					}
 					else
 					{
@@ -107,6 +331,29 @@ void AShooterWeapon_Instant::ServerNotifyHit_Implementation(const FHitResult& Im
 	}
 }
 
+bool AShooterWeapon_Instant::IsWithinClientSideHitLeeway(const FHitResult& Impact) const
+{
+	// Get the component bounding box
+	const FBox HitBox = Impact.GetActor()->GetComponentsBoundingBox();
+
+	// calculate the box extent, and increase by a leeway
+	FVector BoxExtent = 0.5 * (HitBox.Max - HitBox.Min);
+	BoxExtent *= InstantConfig.ClientSideHitLeeway;
+
+	// avoid precision errors with really thin objects
+	BoxExtent.X = FMath::Max(20.0f, BoxExtent.X);
+	BoxExtent.Y = FMath::Max(20.0f, BoxExtent.Y);
+	BoxExtent.Z = FMath::Max(20.0f, BoxExtent.Z);
+
+	// Get the box center
+	const FVector BoxCenter = (HitBox.Min + HitBox.Max) * 0.5;
+
+	// if we are within client tolerance
+	return FMath::Abs(Impact.Location.Z - BoxCenter.Z) < BoxExtent.Z &&
+		FMath::Abs(Impact.Location.X - BoxCenter.X) < BoxExtent.X &&
+		FMath::Abs(Impact.Location.Y - BoxCenter.Y) < BoxExtent.Y;
+}
+
 bool AShooterWeapon_Instant::ServerNotifyMiss_Validate(FVector_NetQuantizeNormal ShootDir, int32 RandomSeed, float ReticleSpread)
 {
 	return true;
@@ -137,14 +384,14 @@ void AShooterWeapon_Instant::ProcessInstantHit(const FHitResult& Impact, const F
 		if (Impact.GetActor() && Impact.GetActor()->GetRemoteRole() == ROLE_Authority)
 		{
 			// notify the server of the hit
-			ServerNotifyHit(Impact, ShootDir, RandomSeed, ReticleSpread);
+			QueueHitReport(Impact, RandomSeed, ReticleSpread);
 		}
 		else if (Impact.GetActor() == NULL)
 		{
 			if (Impact.bBlockingHit)
 			{
 				// notify the server of the hit
-				ServerNotifyHit(Impact, ShootDir, RandomSeed, ReticleSpread);
+				QueueHitReport(Impact, RandomSeed, ReticleSpread);
 			}
 			else
 			{
@@ -158,6 +405,88 @@ void AShooterWeapon_Instant::ProcessInstantHit(const FHitResult& Impact, const F
 	ProcessInstantHit_Confirmed(Impact, Origin, ShootDir, RandomSeed, ReticleSpread);
 }
 
+void AShooterWeapon_Instant::QueueHitReport(const FHitResult& Impact, int32 RandomSeed, float ReticleSpread)
+{
+	FShooterHitReport& Report = QueuedHitReports.AddDefaulted_GetRef();
+	QueuedHitTimes.Add(GetWorld()->GetTimeSeconds());
+
+	Report.Target = Impact.GetActor();
+	Report.bHasTarget = Impact.GetActor() != nullptr;
+	Report.ImpactPoint = Impact.ImpactPoint;
+	Report.ImpactNormal = Impact.ImpactNormal;
+	Report.RandomSeed = RandomSeed;
+	Report.ReticleSpread = (uint8)FMath::Clamp(FMath::RoundToInt(ReticleSpread * 10.0f), 0, 255);
+
+	const ACharacter* TargetCharacter = Cast<ACharacter>(Impact.GetActor());
+	if (TargetCharacter && TargetCharacter->GetMesh())
+	{
+		const int32 BoneIndex = TargetCharacter->GetMesh()->GetBoneIndex(Impact.BoneName);
+		Report.HitZone = (uint16)(BoneIndex + 1);
+	}
+
+	if (QueuedHitReports.Num() >= FMath::Clamp(HitReportsMaxPerBatch, 1, HitReportsBatchLimit))
+	{
+		FlushHitReports();
+	}
+	else if (!GetWorldTimerManager().IsTimerActive(TimerHandle_FlushHitReports))
+	{
+		GetWorldTimerManager().SetTimer(TimerHandle_FlushHitReports, this, &AShooterWeapon_Instant::FlushHitReports, FMath::Max(0.001f, HitReportsBatchInterval), true);
+	}
+}
+
+void AShooterWeapon_Instant::FlushHitReports()
+{
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+
+	if (QueuedHitReports.Num() > 0)
+	{
+		FPendingHitBatch& Pending = PendingHitBatches.AddDefaulted_GetRef();
+		Pending.Batch.Sequence = NextHitReportSequence++;
+		Pending.Batch.Reports = MoveTemp(QueuedHitReports);
+		Pending.ShotTimes = MoveTemp(QueuedHitTimes);
+		Pending.LastSendTime = -MAX_FLT;
+
+		QueuedHitReports.Reset();
+		QueuedHitTimes.Reset();
+	}
+
+	for (int32 i = PendingHitBatches.Num() - 1; i >= 0; i--)
+	{
+		FPendingHitBatch& Pending = PendingHitBatches[i];
+
+		// the server can't check shots this old against its history anyway
+		if (TimeSeconds - Pending.ShotTimes[0] > HitReportsMaxAge)
+		{
+			UE_LOG(LogShooterWeapon, Verbose, TEXT("%s Dropped %d unacknowledged hit reports"), *GetNameSafe(this), Pending.Batch.Reports.Num());
+			PendingHitBatches.RemoveAt(i);
+			continue;
+		}
+
+		if (TimeSeconds - Pending.LastSendTime < HitReportsResendInterval)
+		{
+			continue;
+		}
+
+		for (int32 ReportIdx = 0; ReportIdx < Pending.Batch.Reports.Num(); ReportIdx++)
+		{
+			const float Age = TimeSeconds - Pending.ShotTimes[ReportIdx];
+			Pending.Batch.Reports[ReportIdx].Age = (uint8)FMath::Clamp(FMath::RoundToInt(Age / 0.004f), 0, 255);
+		}
+
+		Pending.LastSendTime = TimeSeconds;
+		ServerNotifyHit(Pending.Batch);
+	}
+
+	if (PendingHitBatches.Num() == 0)
+	{
+		GetWorldTimerManager().ClearTimer(TimerHandle_FlushHitReports);
+	}
+	else if (!GetWorldTimerManager().IsTimerActive(TimerHandle_FlushHitReports))
+	{
+		GetWorldTimerManager().SetTimer(TimerHandle_FlushHitReports, this, &AShooterWeapon_Instant::FlushHitReports, FMath::Max(0.001f, HitReportsBatchInterval), true);
+	}
+}
+
 void AShooterWeapon_Instant::ProcessInstantHit_Confirmed(const FHitResult& Impact, const FVector& Origin, const FVector& ShootDir, int32 RandomSeed, float ReticleSpread)
 {
 	// handle damage
@@ -280,6 +609,15 @@ void AShooterWeapon_Instant::SpawnImpactEffects(const FHitResult& Impact)
 			UseImpact = Hit;
 		}
 
+		UShooterEffectManager* EffectManager = UShooterEffectManager::Get(this);
+		if (EffectManager)
+		{
+			UseImpact.ImpactPoint = Impact.ImpactPoint;
+			UseImpact.ImpactNormal = Impact.ImpactNormal;
+			EffectManager->PlayImpactEffect(ImpactTemplate, UseImpact);
+			return;
+		}
+
 		FTransform const SpawnTransform(Impact.ImpactNormal.Rotation(), Impact.ImpactPoint);
 		AShooterImpactEffect* EffectActor = GetWorld()->SpawnActorDeferred<AShooterImpactEffect>(ImpactTemplate, SpawnTransform);
 		if (EffectActor)
@@ -292,7 +630,13 @@ void AShooterWeapon_Instant::SpawnImpactEffects(const FHitResult& Impact)
 
 void AShooterWeapon_Instant::SpawnTrailEffect(const FVector& EndPoint)
 {
-	if (TrailFX)
+	UShooterTracerManager* TracerManager = TracerMesh ? UShooterTracerManager::Get(this) : nullptr;
+	if (TracerManager)
+	{
+		const bool bLocalShot = MyPawn && MyPawn->IsLocallyControlled();
+		TracerManager->AddTracer(TracerMesh, TracerMaterial, GetMuzzleLocation(), EndPoint, bLocalShot);
+	}
+	else if (TrailFX)
 	{
 		const FVector Origin = GetMuzzleLocation();
 
@@ -0,0 +1,154 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+#include "ShooterBotLOSScheduler.generated.h"
+
+/** line of sight trace requested by a bot */
+struct FShooterBotLOSRequest
+{
+	/** controller asking, results are cached per requester */
+	const AController* Requester;
+
+	/** actor being looked at, null when tracing to a location */
+	AActor* Target;
+
+	/** trace start and end */
+	FVector Start;
+	FVector End;
+
+	/** actor ignored by the trace, usually the requester's pawn */
+	AActor* IgnoredActor;
+
+	/** identifies the kind of check, requests with different tags never share results */
+	FName Tag;
+
+	FShooterBotLOSRequest()
+		: Requester(nullptr)
+		, Target(nullptr)
+		, Start(ForceInitToZero)
+		, End(ForceInitToZero)
+		, IgnoredActor(nullptr)
+	{
+	}
+};
+
+/** what the trace hit, callers apply their own line of sight rules to it */
+struct FShooterBotLOSResult
+{
+	bool bBlockingHit;
+
+	TWeakObjectPtr<AActor> HitActor;
+
+	FVector ImpactPoint;
+
+	FShooterBotLOSResult()
+		: bBlockingHit(false)
+		, ImpactPoint(ForceInitToZero)
+	{
+	}
+};
+
+/**
+ * [server] Collects bot line of sight traces during the frame and submits them as one batch of async traces.
+ *
+ * Results come back next frame and are cached per (requester, target, tag) until older than ShooterGame.BotLOS.MaxAge.
+ * Older results keep being served while a refresh is in flight, up to ShooterGame.BotLOS.MaxStaleAge.
+ */
+UCLASS()
+class UShooterBotLOSScheduler : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+
+	/** returns the subsystem for the world of the given object, if any */
+	static UShooterBotLOSScheduler* Get(const UObject* WorldContextObject);
+
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	/** TickableObject Functions */
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+	/**
+	 * Get the latest usable result for the request, scheduling a refresh when it's missing or too old.
+	 *
+	 * @returns false if there is no result young enough yet, callers should treat it as no line of sight
+	 */
+	bool GetLOSResult(const FShooterBotLOSRequest& Request, FShooterBotLOSResult& OutResult);
+
+private:
+
+	struct FLOSKey
+	{
+		TObjectKey<AController> Requester;
+		TObjectKey<AActor> Target;
+
+		/** quantized end location, only used when tracing to a location */
+		FIntVector EndCell;
+
+		FName Tag;
+
+		bool operator==(const FLOSKey& Other) const
+		{
+			return Requester == Other.Requester && Target == Other.Target && EndCell == Other.EndCell && Tag == Other.Tag;
+		}
+
+		friend uint32 GetTypeHash(const FLOSKey& Key)
+		{
+			return HashCombine(HashCombine(GetTypeHash(Key.Requester), GetTypeHash(Key.Target)), HashCombine(GetTypeHash(Key.EndCell), GetTypeHash(Key.Tag)));
+		}
+	};
+
+	struct FLOSEntry
+	{
+		FShooterBotLOSResult Result;
+
+		/** time the result was traced, negative until the first one arrives */
+		float ResultTime;
+
+		/** time the entry was last asked for, unused entries are evicted */
+		float LastRequestTime;
+
+		/** latest trace parameters, used when the batch is submitted */
+		FVector Start;
+		FVector End;
+		TWeakObjectPtr<AActor> IgnoredActor;
+
+		/** queued for the next batch or waiting on the async result */
+		bool bPending;
+	};
+
+	/** async trace completion, routes the result back to its entry */
+	void OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	/** synchronous path used when async traces are disabled */
+	void TraceNow(FLOSEntry& Entry, float TimeSeconds) const;
+
+	/** cached results */
+	TMap<FLOSKey, FLOSEntry> Entries;
+
+	/** entries to submit with this frame's batch */
+	TArray<FLOSKey> PendingKeys;
+
+	/** in flight traces, by the id passed as trace user data */
+	TMap<uint32, FLOSKey> InFlightKeys;
+
+	/** next trace id */
+	uint32 NextTraceId;
+
+	/** bound once, reused for all traces */
+	FTraceDelegate TraceDelegate;
+
+	/** time of the last eviction pass */
+	float LastEvictTime;
+};
@@ -0,0 +1,117 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "ShooterTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterDecalManager.generated.h"
+
+/**
+ * [client] Owns every impact and explosion decal, up to a global budget from UShooterGameUserSettings.
+ *
+ * Decal components are recycled least recently used first once the budget is reached, instead of piling up until their
+ * life span ends. Decals far from every local view are not spawned and small ones fade by screen size. Repeated hits with
+ * the same material on the same spot refresh and grow the decal that is already there instead of adding another one.
+ */
+UCLASS()
+class UShooterDecalManager : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+
+	/** returns the subsystem for the world of the given object, if any */
+	static UShooterDecalManager* Get(const UObject* WorldContextObject);
+
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	/** TickableObject Functions */
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+	/**
+	 * Place a decal on the surface that was hit, with a random roll around the impact normal.
+	 *
+	 * @param Decal			Material and life span.
+	 * @param DecalExtent	Decal component size.
+	 * @param Impact		Surface hit, decals on movable components follow them.
+	 */
+	void SpawnDecal(const FDecalData& Decal, const FVector& DecalExtent, const FHitResult& Impact);
+
+	/** number of decals currently shown */
+	int32 GetNumLiveDecals() const { return NumLive; }
+
+private:
+
+	/** one decal component, live or free */
+	struct FDecalSlot
+	{
+		UDecalComponent* Decal;
+
+		/** surface the decal is attached to, null for static surfaces */
+		TWeakObjectPtr<USceneComponent> AttachParent;
+
+		float ExpireTime;
+		float LifeSpan;
+
+		/** key in MergeSlots, 0 when not mergeable */
+		uint32 MergeKey;
+
+		/** extent the decal was spawned with and how many hits merged into it */
+		FVector BaseExtent;
+		int32 NumMerged;
+
+		/** LRU links between live slots, INDEX_NONE at the ends */
+		int32 Prev;
+		int32 Next;
+
+		bool bLive;
+	};
+
+	/** current budget, from the user settings unless overridden */
+	int32 GetBudget() const;
+
+	/** true if the location is close enough to a local view */
+	bool IsInRange(const FVector& Location) const;
+
+	/** try to add the hit to a live decal nearby, returns true when merged */
+	bool MergeDecal(uint32 MergeKey);
+
+	/** slot for a new decal, recycling the least recently used one when over budget */
+	int32 AllocateSlot();
+
+	/** hide the decal and put the slot back on the free list */
+	void ReleaseSlot(int32 SlotIndex);
+
+	/** show the decal, restart its life span and make it the most recently used */
+	void ActivateSlot(int32 SlotIndex);
+
+	/** LRU list maintenance */
+	void LinkNewest(int32 SlotIndex);
+	void Unlink(int32 SlotIndex);
+
+	/** every decal component owned by the manager */
+	UPROPERTY()
+	TArray<UDecalComponent*> DecalComponents;
+
+	TArray<FDecalSlot> Slots;
+	TArray<int32> FreeSlots;
+
+	/** live mergeable decals by material + surface + spot */
+	TMap<uint32, int32> MergeSlots;
+
+	/** least and most recently used live slots */
+	int32 OldestSlot;
+	int32 NewestSlot;
+
+	int32 NumLive;
+
+	/** time until live decals are next checked for expiry */
+	float ExpiryCheckCountdown;
+};
@@ -0,0 +1,129 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterEffectManager.generated.h"
+
+class AShooterImpactEffect;
+class AShooterExplosionEffect;
+
+/**
+ * [client] Plays impact and explosion effects from pooled components instead of spawning an effect actor per hit.
+ *
+ * AShooterImpactEffect and AShooterExplosionEffect blueprints are only read as templates. Emitters are pooled per particle
+ * system, so per surface type, and sounds per sound. Impacts are budgeted per frame and per area, duplicates in the same
+ * spot within a frame are collapsed, and visuals are culled when no local view can see them.
+ */
+UCLASS()
+class UShooterEffectManager : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+
+	/** returns the subsystem for the world of the given object, if any */
+	static UShooterEffectManager* Get(const UObject* WorldContextObject);
+
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	/** TickableObject Functions */
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+	/** play the effects of the impact template for the surface that was hit */
+	void PlayImpactEffect(TSubclassOf<AShooterImpactEffect> ImpactTemplate, const FHitResult& Impact);
+
+	/** play the effects of the explosion template, the light fades out over the template's ExplosionLightFadeOut */
+	void PlayExplosionEffect(TSubclassOf<AShooterExplosionEffect> ExplosionTemplate, const FHitResult& Impact, const FTransform& EffectTM);
+
+protected:
+
+	/** emitter played its last particle, back to the pool */
+	UFUNCTION()
+	void OnEmitterFinished(UParticleSystemComponent* Emitter);
+
+	/** sound done, back to the pool */
+	void OnSoundFinished(UAudioComponent* Sound);
+
+private:
+
+	/** local views effects are culled against, gathered once per frame */
+	struct FEffectView
+	{
+		FVector Location;
+		FVector Direction;
+
+		/** cosine of the half angle of the view cone, padded so effects at the screen edges still play */
+		float CosHalfFOV;
+	};
+
+	/** explosion light being faded out */
+	struct FActiveLight
+	{
+		UPointLightComponent* Light;
+		float StartTime;
+		float FadeOut;
+		float Intensity;
+	};
+
+	/** reset the frame budgets and gather the views, once per frame */
+	void UpdateFrame();
+
+	/** true if the location is within CullDistance of a local view */
+	bool IsInRange(const FVector& Location, float CullDistance) const;
+
+	/** true if the location is inside a local view cone */
+	bool IsInView(const FVector& Location) const;
+
+	/** area budget cell containing the location */
+	FIntVector GetAreaCell(const FVector& Location) const;
+
+	/** start a pooled emitter, returns false when the area budget is used up */
+	bool PlayEmitter(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation, bool bCheckAreaBudget);
+
+	/** start a pooled sound */
+	void PlaySound(USoundBase* Sound, const FVector& Location);
+
+	/** fade-out light for an explosion */
+	void PlayLight(const AShooterExplosionEffect* Template, const FVector& Location);
+
+	/** every component owned by the manager, free or playing */
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> AllEmitters;
+
+	UPROPERTY()
+	TArray<UAudioComponent*> AllSounds;
+
+	UPROPERTY()
+	TArray<UPointLightComponent*> AllLights;
+
+	/** free components per template */
+	TMap<UParticleSystem*, TArray<UParticleSystemComponent*>> FreeEmitters;
+	TMap<USoundBase*, TArray<UAudioComponent*>> FreeSounds;
+	TArray<UPointLightComponent*> FreeLights;
+
+	/** area cell of each playing emitter */
+	TMap<UParticleSystemComponent*, FIntVector> PlayingEmitterCells;
+
+	/** playing emitters per area cell */
+	TMap<FIntVector, int32> AreaCellCounts;
+
+	TArray<FActiveLight> ActiveLights;
+
+	/** views for the current frame */
+	TArray<FEffectView, TInlineAllocator<4>> Views;
+
+	/** impacts played this frame, and hashes of template + spot for collapsing duplicates */
+	int32 NumImpactsThisFrame;
+	TSet<uint32> ImpactsThisFrame;
+
+	/** frame the budgets and views belong to */
+	uint64 LastUpdateFrame;
+};
@@ -0,0 +1,89 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterTracerManager.generated.h"
+
+/**
+ * [client] Draws every active bullet tracer as an instance of one instanced static mesh component per tracer mesh and
+ * material, instead of spawning a particle system component per shot.
+ *
+ * Tracer meshes are expected to be 100 uu long along X and centered, like the engine basic shapes. Each tracer is a
+ * segment travelling from the muzzle to the end point. Tracers far from every local view are thinned out or dropped,
+ * and the number of live tracers is capped, with remote shots dropped first.
+ */
+UCLASS()
+class UShooterTracerManager : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+
+	/** returns the subsystem for the world of the given object, if any */
+	static UShooterTracerManager* Get(const UObject* WorldContextObject);
+
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	/** TickableObject Functions */
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+	/**
+	 * Start a tracer.
+	 *
+	 * @param Mesh			Tracer mesh, see class comment.
+	 * @param Material		Material override, null for the mesh's own.
+	 * @param Origin		Muzzle location.
+	 * @param EndPoint		Impact or end of the weapon range.
+	 * @param bLocalShot	Fired by a local player, never thinned out and may replace older tracers when over budget.
+	 * @return false if the tracer was culled or dropped
+	 */
+	bool AddTracer(UStaticMesh* Mesh, UMaterialInterface* Material, const FVector& Origin, const FVector& EndPoint, bool bLocalShot);
+
+private:
+
+	/** tracers sharing mesh and material, drawn by one component */
+	struct FTracerBatch
+	{
+		UStaticMesh* Mesh;
+		UMaterialInterface* Material;
+		UInstancedStaticMeshComponent* Component;
+
+		/** instance transforms, rebuilt every tick */
+		TArray<FTransform> InstanceTransforms;
+	};
+
+	struct FTracer
+	{
+		FVector Origin;
+		FVector Direction;
+		float Length;
+		float StartTime;
+		int32 BatchIndex;
+	};
+
+	/** batch for the mesh and material, created on first use */
+	int32 FindOrAddBatch(UStaticMesh* Mesh, UMaterialInterface* Material);
+
+	/** squared distance from the segment to the closest local view */
+	float GetViewDistSquared(const FVector& Start, const FVector& End) const;
+
+	/** components of all batches, referenced for GC */
+	UPROPERTY()
+	TArray<UInstancedStaticMeshComponent*> BatchComponents;
+
+	TArray<FTracerBatch> Batches;
+
+	/** live tracers, oldest first */
+	TArray<FTracer> Tracers;
+
+	/** remote tracers in the thinned out distance band so far, every Nth is kept */
+	int32 NumFarTracers;
+};
@@ -4,6 +4,7 @@
 
 #include "OnlineIdentityInterface.h"
 #include "ShooterPlayerController.h"
+#include "Pickups/ShooterPickupRegistry.h"
 #include "ShooterGameMode.generated.h"
 
 class AShooterAIController;
@@ -46,6 +47,9 @@ class AShooterGameMode : public AGameMode
 	/** returns default pawn class for given controller */
 	virtual UClass* GetDefaultPawnClassForController_Implementation(AController* InController) override;
 
+	/** reuses a dead pawn from the respawn pool when there is one */
+	virtual APawn* SpawnDefaultPawnAtTransform_Implementation(AController* NewPlayer, const FTransform& SpawnTransform) override;
+
 	/** prevents friendly fire */
 	virtual float ModifyDamage(float Damage, AActor* DamagedActor, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) const;
 
@@ -143,6 +147,50 @@ protected:
 	/** Returns game session class to use */
 	virtual TSubclassOf<AGameSession> GetGameSessionClass() const override;	
 
+	/** spawn point cached for the map, starts are weak so a level streamed out from under the table is caught by PrepareSpawnWave */
+	struct FSpawnPointEntry
+	{
+		TWeakObjectPtr<APlayerStart> Start;
+		FVector Location;
+
+		/** overlapped a pawn when this frame's wave started */
+		bool bOccupied;
+
+		/** handed out earlier in this frame's wave, its pawn isn't in the occupancy snapshot yet */
+		bool bClaimed;
+	};
+
+	/** all spawn points of the map, built on first use */
+	TArray<FSpawnPointEntry> SpawnPoints;
+
+	/** spawn point to index in SpawnPoints */
+	TMap<TWeakObjectPtr<APlayerStart>, int32> SpawnPointIndices;
+
+	/** "Play from Here" start, always used when present */
+	TWeakObjectPtr<APlayerStart> PIESpawnPoint;
+
+	/** largest capsule of the player and bot pawn classes, used for occupancy tests */
+	float SpawnCapsuleRadius;
+	float SpawnCapsuleHalfHeight;
+
+	/** frame the cached occupancy belongs to, every spawn during that frame is served from it */
+	uint64 SpawnWaveFrame;
+
+	/** per spawn point squared distance to the nearest enemy, by team of the spawning player, for the current wave */
+	TMap<int32, TArray<float>> SpawnEnemyDistSq;
+
+	/** build the spawn point table, once per map unless spawn points go away */
+	void CacheSpawnPoints();
+
+	/** refresh occupancy for a new frame, spawns in the same frame share it */
+	void PrepareSpawnWave();
+
+	/** check the pawn occupancy grid around a spawn location */
+	bool IsSpawnLocationOccupied(const FVector& SpawnLocation) const;
+
+	/** nearest enemy distances for the player's team, computed once per wave */
+	const TArray<float>& GetSpawnEnemyDistSq(AController* Player);
+
 public:	
 
 	/** finish current match and lock players */
@@ -159,4 +207,12 @@ public:
 	UPROPERTY()
 	TArray<AShooterPickup*> LevelPickups;
 
+	/** [server] typed index of LevelPickups, for nearest available pickup queries */
+	FShooterPickupRegistry& GetPickupRegistry() { return PickupRegistry; }
+
+protected:
+
+	/** active pickups grouped by type, kept in sync by the pickups themselves */
+	FShooterPickupRegistry PickupRegistry;
+
 };
@@ -8,6 +8,9 @@
 /** ranked PlayerState map, created from the GameState */
 typedef TMap<int32, TWeakObjectPtr<AShooterPlayerState> > RankedPlayerMap; 
 
+/** PlayerStates of one team, highest score first */
+typedef TArray<TWeakObjectPtr<AShooterPlayerState> > TeamLeaderboard;
+
 UCLASS()
 class AShooterGameState : public AGameState
 {
@@ -34,6 +37,26 @@ public:
 	/** gets ranked PlayerState map for specific team */
 	void GetRankedMap(int32 TeamIndex, RankedPlayerMap& OutRankedMap) const;	
 
+	/** gets sorted PlayerStates for specific team, empty if the team has no players */
+	const TeamLeaderboard& GetTeamLeaderboard(int32 TeamIndex) const;
+
+	/** gets rank of player within its team, 0 is best, INDEX_NONE if not ranked */
+	int32 GetLeaderboardRank(const AShooterPlayerState* PlayerState) const;
+
+	/** bumped whenever the ranking or the ranked players change, compare to skip rebuilding rows */
+	uint32 GetLeaderboardVersion() const { return LeaderboardVersion; }
+
+	/** move player to its new position after a score change */
+	void NotifyPlayerScoreChanged(AShooterPlayerState* PlayerState);
+
+	/** move player to the leaderboard of its new team */
+	void NotifyPlayerTeamChanged(AShooterPlayerState* PlayerState);
+
+	// Begin AGameStateBase interface
+	virtual void AddPlayerState(APlayerState* PlayerState) override;
+	virtual void RemovePlayerState(APlayerState* PlayerState) override;
+	// End AGameStateBase interface
+
 	void RequestFinishAndExitToMainMenu();
 
 	virtual void HandleMatchHasStarted() override;
@@ -47,4 +70,16 @@ protected:
 	bool bEnableGameFeedback;
 
 	FShooterOnlineGameMatches GameMatches;
+
+	/** persistent per team leaderboards, kept sorted as scores change */
+	TArray<TeamLeaderboard> TeamLeaderboards;
+
+	/** see GetLeaderboardVersion */
+	uint32 LeaderboardVersion;
+
+	/** insert player into its team's leaderboard */
+	void AddToLeaderboard(AShooterPlayerState* PlayerState);
+
+	/** remove player from whichever leaderboard holds it, returns false if none did */
+	bool RemoveFromLeaderboard(const AShooterPlayerState* PlayerState);
 };
@@ -21,6 +21,9 @@ class AShooterPlayerState : public APlayerState
 	 */
 	virtual void ClientInitialize(class AController* InController) override;
 
+	/** update leaderboard position on clients */
+	virtual void OnRep_Score() override;
+
 	virtual void RegisterPlayerWithSession(bool bWasFromInvite) override;
 	virtual void UnregisterPlayerWithSession() override;
 
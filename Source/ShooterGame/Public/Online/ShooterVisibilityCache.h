@@ -0,0 +1,80 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterVisibilityCache.generated.h"
+
+class AShooterCharacter;
+
+/**
+ * [server] Caches line of sight between connection viewers and characters, used to pause replication of hidden characters.
+ *
+ * Queries never trace. Pairs are refreshed round-robin in Tick, issuing at most p.NetPauseRelevancyTraceBudget traces per frame,
+ * and results are reused until they are older than p.NetPauseRelevancyRefreshInterval.
+ */
+UCLASS()
+class UShooterVisibilityCache : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+
+	/** returns the subsystem for the world of the given object, if any */
+	static UShooterVisibilityCache* Get(const UObject* WorldContextObject);
+
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	/** TickableObject Functions */
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+	/**
+	 * Returns the cached visibility of the target for the viewer. Unknown pairs are registered for refresh and
+	 * reported visible, so replication is never paused on missing data.
+	 */
+	bool IsVisible(APlayerController* Viewer, AShooterCharacter* Target);
+
+private:
+
+	typedef TPair<TObjectKey<APlayerController>, TObjectKey<AShooterCharacter>> FVisibilityKey;
+
+	/** cached result for one (viewer, target) pair */
+	struct FVisibilityEntry
+	{
+		/** map key, kept so the entry can be removed after either side is destroyed */
+		FVisibilityKey Key;
+
+		TWeakObjectPtr<APlayerController> Viewer;
+		TWeakObjectPtr<AShooterCharacter> Target;
+
+		/** time of the last trace refresh, negative until first traced */
+		float LastRefreshTime;
+
+		/** time the pair was last queried, unqueried pairs are evicted */
+		float LastQueryTime;
+
+		bool bVisible;
+	};
+
+	/** trace target check points against the viewer's view point, returns number of traces issued */
+	int32 RefreshEntry(FVisibilityEntry& Entry, float TimeSeconds);
+
+	/** swap-remove entry and fix up the index of the moved one */
+	void RemoveEntryAt(int32 Index);
+
+	/** dense entry storage, walked round-robin */
+	TArray<FVisibilityEntry> Entries;
+
+	/** pair to index in Entries */
+	TMap<FVisibilityKey, int32> EntryIndices;
+
+	/** entry the next refresh pass starts at */
+	int32 RefreshCursor;
+};
@@ -16,10 +16,16 @@ class AShooterPickup : public AActor
 	/** check if pawn can use this pickup */
 	virtual bool CanBePickedUp(class AShooterCharacter* TestPawn) const;
 
+	/** weapon class this pickup is meant for, groups it in the game mode's pickup registry */
+	virtual UClass* GetPickupWeaponType() const;
+
 protected:
 	/** initial setup */
 	virtual void BeginPlay() override;
 
+	/** remove from pickup registry */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
 	/** FX component */
 	UPROPERTY(VisibleDefaultsOnly, Category=Effects)
@@ -0,0 +1,83 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+class AShooterCharacter;
+class AShooterPickup;
+
+/**
+ * [server] Level pickups grouped by native pickup class and weapon type, with a 2D grid of the active ones per group.
+ *
+ * Pickups register themselves and keep their active state in sync from OnPickedUp / OnRespawned, so queries only
+ * ever visit available pickups and never need to cast.
+ */
+class FShooterPickupRegistry
+{
+public:
+
+	FShooterPickupRegistry();
+
+	/** add pickup, its group is resolved once here */
+	void RegisterPickup(AShooterPickup* Pickup, bool bIsActive);
+
+	/** remove pickup from its group */
+	void UnregisterPickup(AShooterPickup* Pickup);
+
+	/** move pickup in or out of its group's grid */
+	void SetPickupActive(AShooterPickup* Pickup, bool bIsActive);
+
+	/**
+	 * Find the closest active pickup of the given type that the pawn can use.
+	 *
+	 * @param PickupClass	Native pickup class to look for, e.g. AShooterPickup_Ammo or AShooterPickup_Health.
+	 * @param WeaponType	Only pickups for this weapon class or its children, null for any.
+	 * @param Origin		Query location.
+	 * @param ForPawn		Pawn that must be able to pick it up, null to skip the check.
+	 * @param OutDistSq		Squared distance to the returned pickup.
+	 */
+	AShooterPickup* FindNearestAvailable(UClass* PickupClass, UClass* WeaponType, const FVector& Origin, AShooterCharacter* ForPawn, float* OutDistSq = nullptr) const;
+
+	/** number of registered pickups */
+	int32 Num() const { return Pickups.Num(); }
+
+private:
+
+	/** pickups sharing native class and weapon type */
+	struct FPickupGroup
+	{
+		UClass* PickupClass;
+		UClass* WeaponType;
+
+		/** active pickups per occupied cell */
+		TMap<FIntPoint, TArray<AShooterPickup*, TInlineAllocator<4>>> ActiveCells;
+
+		/** bounds of cells that ever held a pickup, limits ring expansion */
+		FIntPoint MinCell;
+		FIntPoint MaxCell;
+
+		int32 NumActive;
+	};
+
+	/** cell containing the location */
+	FIntPoint GetCell(const FVector& Location) const;
+
+	/** closest active pickup of the group the pawn can use, searching no further than MaxDistSq */
+	AShooterPickup* FindNearestInGroup(const FPickupGroup& Group, const FVector& Origin, AShooterCharacter* ForPawn, float MaxDistSq, float& OutDistSq) const;
+
+	/** groups, few of them per level */
+	TArray<FPickupGroup> Groups;
+
+	/** where a registered pickup lives */
+	struct FPickupSlot
+	{
+		int32 GroupIndex;
+		FIntPoint Cell;
+		bool bActive;
+	};
+
+	/** registered pickups */
+	TMap<AShooterPickup*, FPickupSlot> Pickups;
+
+	/** pickups are static, so the cell size is fixed for the registry's lifetime */
+	float CellSize;
+};
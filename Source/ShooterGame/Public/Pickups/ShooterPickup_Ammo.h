@@ -19,6 +19,9 @@ class AShooterPickup_Ammo : public AShooterPickup
 
 	bool IsForWeapon(UClass* WeaponClass);
 
+	/** weapon class this pickup gives ammo for */
+	virtual UClass* GetPickupWeaponType() const override;
+
 protected:
 
 	/** how much ammo does it give? */
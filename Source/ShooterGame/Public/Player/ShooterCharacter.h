@@ -31,9 +31,18 @@ class AShooterCharacter : public ACharacter
 	/** [server] perform PlayerState related setup */
 	virtual void PossessedBy(class AController* C) override;
 
+	/** [server] controller went away */
+	virtual void UnPossessed() override;
+
+	/** [client] controller changed */
+	virtual void OnRep_Controller() override;
+
 	/** [client] perform PlayerState related setup */
 	virtual void OnRep_PlayerState() override;
 
+	/** [client] pawns first received while waiting in the respawn pool start hidden */
+	virtual void PostNetInit() override;
+
 	/** [server] called to determine if we should pause replication this actor to a specific player */
 	virtual bool IsReplicationPausedForConnection(const FNetViewer& ConnectionOwnerNetViewer) override;
 
@@ -284,6 +293,18 @@ class AShooterCharacter : public ACharacter
 
 	/** Update the team color of all player meshes. */
 	void UpdateTeamColorsAllMIDs();
+
+	/** set by UShooterSignificanceManager, culled characters skip cosmetic work */
+	void SetSignificance(EShooterSignificance::Type NewSignificance);
+
+	/** current significance bucket */
+	EShooterSignificance::Type GetSignificance() const { return Significance; }
+
+	/** number of points checked for pausing replication, the corners of the capsule bounds */
+	static const int32 NumPauseReplicationCheckPoints = 8;
+
+	/** Get points to check for pausing replication for a connection, rebuilt only after the capsule moved */
+	TArrayView<const FVector> GetPauseReplicationCheckPoints();
 private:
 
 	/** pawn mesh: 1st person view */
@@ -333,6 +354,12 @@ protected:
 	/** from gamepad running is toggled */
 	uint8 bWantsToRunToggled : 1;
 
+	/** team colors changed while culled, applied when significant again */
+	uint8 bTeamColorsDirty : 1;
+
+	/** significance bucket, see UShooterSignificanceManager */
+	EShooterSignificance::Type Significance;
+
 	/** current firing state */
 	uint8 bWantsToFire : 1;
 
@@ -392,6 +419,9 @@ protected:
 	/** handles sounds for running */
 	void UpdateRunSounds();
 
+	/** tell USoundNodeLocalPlayer whether this pawn is locally controlled, called when the controller changes */
+	void UpdateLocallyControlledSound();
+
 	/** handle mesh visibility and updates */
 	void UpdatePawnMeshes();
 
@@ -406,6 +436,18 @@ private:
 	/** Whether or not the character is moving (based on movement input). */
 	bool IsMoving();
 
+	/** Builds points to check for pausing replication for a connection */
+	void BuildPauseReplicationCheckPoints();
+
+	/** invalidates cached replication check points */
+	void OnCapsuleTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	/** cached points to check for pausing replication */
+	FVector PauseReplicationCheckPoints[NumPauseReplicationCheckPoints];
+
+	/** whether PauseReplicationCheckPoints match the current capsule transform */
+	bool bPauseReplicationCheckPointsValid;
+
 	//////////////////////////////////////////////////////////////////////////
 	// Damage & death
 
@@ -446,7 +488,34 @@ public:
 
 	/** Called on the actor right before replication occurs */
 	virtual void PreReplication(IRepChangedPropertyTracker & ChangedPropertyTracker) override;
+
+	/** [server] owned by the respawn pool, see UShooterRespawnPool::AddPawn */
+	void SetPooled();
+
+	/** [server] reused from the respawn pool for a new life */
+	void OnAcquiredFromPool();
+
+	/** hide and disable a dead pooled pawn until it's reused */
+	void OnReleasedToPool();
 protected:
+	/** owned by the respawn pool: dies into a corpse proxy and waits to be reused instead of tearing off */
+	UPROPERTY(Transient, Replicated)
+	uint8 bPooled : 1;
+
+	/** bumped every time the pawn is reused from the respawn pool */
+	UPROPERTY(Transient, ReplicatedUsing = OnRep_PoolGeneration)
+	uint8 PoolGeneration;
+
+	/** [client] pawn was respawned from the pool */
+	UFUNCTION()
+	void OnRep_PoolGeneration();
+
+	/** undo the death: visibility, collision, movement and input state back to a fresh spawn */
+	void ResetForReuse();
+
+	/** play respawn effects */
+	void PlayRespawnEffects();
+
 	/** notification when killed, for both the server and client. */
 	virtual void OnDeath(float KillingDamage, struct FDamageEvent const& DamageEvent, class APawn* InstigatingPawn, class AActor* DamageCauser);
 
@@ -473,12 +542,15 @@ protected:
 	UFUNCTION()
 	void OnRep_CurrentWeapon(class AShooterWeapon* LastWeapon);
 
-	/** [server] spawns default inventory */
+	/** [server] spawns default inventory, or refills the weapons a pooled pawn kept */
 	void SpawnDefaultInventory();
 
 	/** [server] remove all weapons from inventory and destroy them */
 	void DestroyInventory();
 
+	/** [server] unequip the current weapon, pooled pawns keep their inventory for the next life */
+	void HolsterInventory();
+
 	/** equip weapon */
 	UFUNCTION(reliable, server, WithValidation)
 	void ServerEquipWeapon(class AShooterWeapon* NewWeapon);
@@ -491,9 +563,6 @@ protected:
 	UFUNCTION(reliable, server, WithValidation)
 	void ServerSetRunning(bool bNewRunning, bool bToggle);
 
-	/** Builds list of points to check for pausing replication for a connection*/
-	void BuildPauseReplicationCheckPoints(TArray<FVector>& RelevancyCheckPoints);
-
 protected:
 	/** Returns Mesh1P subobject **/
 	FORCEINLINE USkeletalMeshComponent* GetMesh1P() const { return Mesh1P; }
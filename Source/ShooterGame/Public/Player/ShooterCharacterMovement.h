@@ -25,6 +25,14 @@ enum ECustomMovementMode
 	CMOVE_REWIND = 2
 };
 
+/** Packed state recorded once per movement tick, replayed in reverse by PhysRewind */
+struct FShooterRewindSample
+{
+	FVector Location;
+	FVector Velocity;
+	FRotator Rotation;
+};
+
 UCLASS()
 class UShooterCharacterMovement : public UCharacterMovementComponent
 {
@@ -65,10 +73,12 @@ class UShooterCharacterMovement : public UCharacterMovementComponent
 	float fRemainingDuration;
 	float fRemainingResetDuration;
 
-	TArray<FVector> aActorLocation;
-	TArray<FVector> aActorVelocity;
+	// Fixed capacity ring buffer, allocated once in InitializeComponent and never resized
+	TArray<FShooterRewindSample> aRewindHistory;
 
-	TArray<FRotator> aActorRotation;
+	// Index of the oldest sample and number of valid samples in aRewindHistory
+	int32 iRewindHistoryHead = 0;
+	int32 iRewindHistoryCount = 0;
 
 	//------------------------------------------------------
     //                  PROPERTIES
@@ -98,6 +108,10 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Custom|Rewind")
 		float RewindTickValue = .01f;
 
+	// Upper bound on recorded samples, regardless of RewindDuration / RewindTickValue
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Custom|Rewind")
+		int32 MaxRewindHistorySamples = 2048;
+
 	//------------------------------------------------------
     //                  OVERRIDES
     //------------------------------------------------------
@@ -106,6 +120,8 @@ private:
 
 	virtual float GetMaxSpeed() const override;
 
+	virtual void InitializeComponent() override;
+	virtual void UninitializeComponent() override;
  	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
  	virtual void PhysCustom(float deltaTime, int32 Iterations) override;
 	virtual void OnMovementUpdated(float DeltaSeconds, const FVector & OldLocation, const FVector & OldVelocity) override;
@@ -118,22 +134,8 @@ private:
 private:
 	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
 
-public:
-
-	// Remote Procedure Calls (RPCs)
-	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable)
-		void ServerSetJetpackingRPC(bool wantsToJetpack);
-	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable)
-		void ServerSetTeleportingRPC(bool wantsToTeleport);
-	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable)
-		void ServerSetRewindingRPC(bool wantsToRewind);
-
-	UFUNCTION(Client, Reliable, BlueprintCallable)
-		void ClientSetJetpackingRPC(bool wantsToJetpack);
-	UFUNCTION(Client, Reliable, BlueprintCallable)
-		void ClientSetTeleportingRPC(bool wantsToTeleport);
-	UFUNCTION(Client, Reliable, BlueprintCallable)
-		void ClientSetRewindingRPC(bool wantsToRewind);
+	// Wants-flags travel to the server in the saved move's FLAG_Custom bits instead of dedicated RPCs
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
 
 	//------------------------------------------------------
     //				GENERAL FUNCTIONS
@@ -144,6 +146,11 @@ private:
 	bool VerifyCustomMovementMode(uint8 currentMode) const;
 	void ToggleGravityScale(bool gravityActive);
 
+public:
+
+	// Back to the state of a fresh spawn for a pawn reused from the respawn pool, the rewind buffer stays allocated
+	void ResetForReuse();
+
 	//------------------------------------------------------
     //				JETPACK FUNCTIONS
     //------------------------------------------------------
@@ -194,6 +201,14 @@ private:
 
 	void PhysRewind(float deltaTime, int32 Iterations);
 
+	// Sizes the rewind ring buffer from RewindDuration and RewindTickValue
+	void AllocateRewindHistory();
+	void ReleaseRewindHistory();
+
+	// O(1) ring operations, pushing onto a full buffer overwrites the oldest sample
+	void PushRewindSample(const FShooterRewindSample& Sample);
+	bool PopRewindSample(FShooterRewindSample& OutSample);
+
 protected:
 
 	void execSetRewinding(bool wantsToRewind);
@@ -206,6 +221,9 @@ public:
 		void SetRewinding(bool wantsToRewind);
 	UFUNCTION(BlueprintCallable)
 		bool IsRewinding();
+
+	// Bytes currently held by this character's rewind history
+	SIZE_T GetRewindHistoryAllocatedSize() const;
 };
 
 //-----------------------------------------------------------------------------------
@@ -223,8 +241,17 @@ public:
     //                  VARIABLES
     //------------------------------------------------------
 
+	// Custom movement wants-flags, packed into FLAG_Custom bits
+	enum CustomCompressedFlags
+	{
+		FLAG_WantsToJetpack		= FLAG_Custom_0,
+		FLAG_WantsToTeleport	= FLAG_Custom_1,
+		FLAG_WantsToRewind		= FLAG_Custom_2,
+	};
+
 	// Jetpack Focus
 	bool savedWantsToJetpack : 1;
+	// Full precision so replay matches the original move, only quantized when deciding whether moves combine
 	float savedRemainingFuel;
 
 	// Teleport Focus
@@ -232,6 +259,7 @@ public:
 	
 	// Rewind Focus
 	bool savedWantsToRewind : 1;
+	// Kept and combined the same way as fuel
 	float savedRemainingDuration;
 
 	//------------------------------------------------------
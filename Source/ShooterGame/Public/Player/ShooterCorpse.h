@@ -0,0 +1,44 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "ShooterTypes.h"
+#include "ShooterCorpse.generated.h"
+
+class AShooterCharacter;
+
+//
+// Ragdoll left behind by a pooled pawn - NOT replicated to clients
+// Owned and recycled by UShooterRespawnPool, the pawn itself goes back to the pool right away
+//
+UCLASS(NotBlueprintable)
+class AShooterCorpse : public AActor
+{
+	GENERATED_UCLASS_BODY()
+
+	/** copy mesh, materials, pose and velocity of the pawn and start the ragdoll */
+	void InitFromPawn(AShooterCharacter* Pawn, float LifeSpan);
+
+	/** hide and stop simulating, waiting to be reused */
+	void Deactivate();
+
+	/** is the corpse visible in the world? */
+	bool IsActive() const;
+
+protected:
+	/** corpses are deactivated instead of destroyed, see UShooterRespawnPool::SpawnCorpse */
+	virtual void LifeSpanExpired() override;
+
+private:
+	/** ragdoll mesh */
+	UPROPERTY(VisibleDefaultsOnly, Category=Mesh)
+	USkeletalMeshComponent* Mesh;
+
+	/** material instances copied from the pawn, reused while the pawn materials match */
+	UPROPERTY(Transient)
+	TArray<UMaterialInstanceDynamic*> MeshMIDs;
+
+public:
+	/** Returns Mesh subobject **/
+	FORCEINLINE USkeletalMeshComponent* GetMesh() const { return Mesh; }
+};
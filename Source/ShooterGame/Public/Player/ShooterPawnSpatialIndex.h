@@ -0,0 +1,110 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterPawnSpatialIndex.generated.h"
+
+class AShooterCharacter;
+
+/** single pawn returned from a spatial query */
+struct FShooterPawnQueryResult
+{
+	AShooterCharacter* Pawn;
+
+	/** squared distance from the query origin */
+	float DistSq;
+};
+
+/** query results, sorted by distance when requested */
+typedef TArray<FShooterPawnQueryResult, TInlineAllocator<32>> FShooterPawnQueryResults;
+
+/**
+ * [server] Uniform 2D grid of live AShooterCharacter positions, rebuilt once per frame.
+ *
+ * Replaces world-wide actor iteration for proximity queries (closest enemy, radius queries). Positions are
+ * snapshotted when the grid is rebuilt, so queries during a frame see where pawns were at the end of the previous one.
+ */
+UCLASS()
+class UShooterPawnSpatialIndex : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+
+	/** returns the subsystem for the world of the given object, if any */
+	static UShooterPawnSpatialIndex* Get(const UObject* WorldContextObject);
+
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	/** TickableObject Functions */
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+	/** [server] add pawn to the index, picked up on the next rebuild */
+	void RegisterPawn(AShooterCharacter* Pawn);
+
+	/** [server] remove pawn from the index immediately */
+	void UnregisterPawn(AShooterCharacter* Pawn);
+
+	/**
+	 * Find up to MaxResults closest live enemies of the querier, sorted by distance.
+	 *
+	 * @param Querier		Controller enemies are tested against, see AShooterCharacter::IsEnemyFor.
+	 * @param Origin		Query location.
+	 * @param MaxRadius		Max distance to search, 0 for unlimited.
+	 * @param MaxResults	Max number of enemies returned, 0 for all.
+	 * @param OutResults	Enemies, closest first.
+	 */
+	void FindNearestEnemies(AController* Querier, const FVector& Origin, float MaxRadius, int32 MaxResults, FShooterPawnQueryResults& OutResults) const;
+
+	/** Find all live pawns within radius of the origin. */
+	void FindPawnsInRadius(const FVector& Origin, float Radius, FShooterPawnQueryResults& OutResults, bool bSortByDistance = false) const;
+
+	/** Get squared distance from origin to the closest live enemy of the querier, MAX_FLT if there is none. */
+	float GetNearestEnemyDistSq(AController* Querier, const FVector& Origin) const;
+
+private:
+
+	/** per pawn snapshot taken when the grid is rebuilt */
+	struct FPawnEntry
+	{
+		AShooterCharacter* Pawn;
+		FVector Location;
+	};
+
+	/** rebuild cells from current pawn positions */
+	void Rebuild();
+
+	/** cell containing the location */
+	FIntPoint GetCell(const FVector& Location) const;
+
+	/**
+	 * Visit cells in square rings around the origin, closest first. Visitor returns false to stop;
+	 * ShouldVisitRing is given the min squared distance of a ring and returns false to stop.
+	 */
+	template<typename VisitorType, typename RingFilterType>
+	void VisitRings(const FVector& Origin, int32 MaxRing, RingFilterType&& ShouldVisitRing, VisitorType&& Visitor) const;
+
+	/** registered pawns */
+	TArray<TWeakObjectPtr<AShooterCharacter>> RegisteredPawns;
+
+	/** live pawns at the last rebuild, grouped by cell */
+	TArray<FPawnEntry> Entries;
+
+	/** range of Entries per occupied cell */
+	TMap<FIntPoint, TPair<int32, int32>> CellRanges;
+
+	/** bounds of occupied cells, limits ring expansion */
+	FIntPoint MinCell;
+	FIntPoint MaxCell;
+
+	/** cell size used for the last rebuild */
+	float CellSize;
+};
@@ -0,0 +1,89 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterRespawnPool.generated.h"
+
+class AShooterCharacter;
+class AShooterCorpse;
+
+/** free pawns of one class, wrapped so the free list map can be a UPROPERTY */
+USTRUCT()
+struct FShooterFreePawns
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	TArray<AShooterCharacter*> Pawns;
+};
+
+/**
+ * Recycles dead pawns and their inventory instead of spawning a new character and new weapons on every respawn.
+ *
+ * [server] Dead pawns skip TearOff and are hidden, stripped of collision and movement and put to sleep with net dormancy,
+ * keeping their weapons, material instances and actor channels. The next respawn of the same pawn class resets one.
+ *
+ * [client] The ragdoll is a separate, non replicated AShooterCorpse copied from the pawn as it dies, so the pawn can be
+ * reused while the body is still around. Corpses are recycled as well, the oldest one is taken over once the cap is hit.
+ */
+UCLASS()
+class UShooterRespawnPool : public UWorldSubsystem
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+
+	/** returns the subsystem for the world of the given object, if any */
+	static UShooterRespawnPool* Get(const UObject* WorldContextObject);
+
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	/**
+	 * [server] Reset a free pawn of the class for a respawn, if there is one.
+	 *
+	 * @param PawnClass		Class the game mode wants to spawn.
+	 * @param SpawnTM		Transform of the chosen player start.
+	 * @returns the pawn, or null if a new one has to be spawned
+	 */
+	AShooterCharacter* AcquirePawn(UClass* PawnClass, const FTransform& SpawnTM);
+
+	/** [server] a new pawn was spawned, it will be recycled when it dies */
+	void AddPawn(AShooterCharacter* Pawn);
+
+	/** [server] put a dead pawn back, it's left to expire when the pool for its class is full */
+	void ReleasePawn(AShooterCharacter* Pawn);
+
+	/** [server] pawn owned by the pool is going away */
+	void NotifyPawnDestroyed(AShooterCharacter* Pawn);
+
+	/** [client] leave a ragdoll copy of the dying pawn */
+	void SpawnCorpse(AShooterCharacter* Pawn);
+
+	/** log hit rate and size */
+	void LogStats() const;
+
+private:
+
+	/** free pawns per class */
+	UPROPERTY()
+	TMap<UClass*, FShooterFreePawns> FreePawns;
+
+	/** every pawn owned by the pool, alive or free */
+	UPROPERTY()
+	TSet<AShooterCharacter*> PooledPawns;
+
+	/** corpses, oldest first */
+	UPROPERTY()
+	TArray<AShooterCorpse*> Corpses;
+
+	/** respawns, and how many of them were served from the free lists */
+	int32 NumAcquired;
+	int32 NumReused;
+
+	/** most pawns the pool owned at once */
+	int32 PeakSize;
+};
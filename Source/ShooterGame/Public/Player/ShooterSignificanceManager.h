@@ -0,0 +1,123 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "ShooterTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterSignificanceManager.generated.h"
+
+class AShooterCharacter;
+
+/**
+ * Sorts characters into significance buckets a few times per second and throttles their work per bucket.
+ *
+ * Client policy: buckets come from the distance to the closest local view and whether the mesh was recently rendered.
+ * Throttled characters tick less often, and simulated proxies also get slower movement and mesh ticks and montage
+ * only animation when culled. Culled characters skip cosmetic work like looping audio and team color updates.
+ *
+ * Server policy (dedicated servers): buckets come from the distance to the closest player view, only the actor tick of
+ * bots is throttled and movement and meshes always run at full rate for hit validation.
+ *
+ * Locally controlled and viewed characters and, on servers, player controlled ones always stay Full.
+ */
+UCLASS()
+class UShooterSignificanceManager : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+
+	/** which tick a measured cost belongs to */
+	enum class ETickType : uint8
+	{
+		Actor,
+		Movement,
+	};
+
+	/** returns the subsystem for the world of the given object, if any */
+	static UShooterSignificanceManager* Get(const UObject* WorldContextObject);
+
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	/** TickableObject Functions */
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+	/** start managing the character, it stays Full until the next update */
+	void RegisterPawn(AShooterCharacter* Pawn);
+
+	/** stop managing the character and restore full rate ticking */
+	void UnregisterPawn(AShooterCharacter* Pawn);
+
+	/** add a measured tick, used to estimate the time saved by throttling */
+	void RecordTickCost(ETickType TickType, uint32 Cycles);
+
+	/** log bucket counts and the estimated time saved */
+	void LogStats() const;
+
+private:
+
+	/** bucket for the character from the current views */
+	EShooterSignificance::Type EvaluateSignificance(const AShooterCharacter* Pawn, bool bServerPolicy) const;
+
+	/** set tick intervals and cosmetic state for the bucket */
+	void ApplySignificance(AShooterCharacter* Pawn, EShooterSignificance::Type Significance, bool bServerPolicy) const;
+
+	/** tick intervals of the bucket, 0 for every frame */
+	float GetActorTickInterval(EShooterSignificance::Type Significance) const;
+	float GetComponentTickInterval(EShooterSignificance::Type Significance) const;
+
+	/** estimate of the tick time saved this frame, in ms */
+	float EstimateTimeSaved(float DeltaTime) const;
+
+	struct FManagedPawn
+	{
+		TWeakObjectPtr<AShooterCharacter> Pawn;
+		EShooterSignificance::Type Significance;
+	};
+
+	TArray<FManagedPawn> ManagedPawns;
+
+	/** view locations gathered for the current update */
+	TArray<FVector, TInlineAllocator<4>> ViewLocations;
+
+	/** time until buckets are next updated */
+	float UpdateCountdown;
+
+	/** running average cost of one tick, in cycles */
+	float AverageTickCycles[2];
+
+	/** characters per bucket at the last update */
+	int32 NumPerBucket[EShooterSignificance::MAX];
+};
+
+/** measures the scope and adds it to the significance manager's average tick cost */
+struct FShooterSignificanceTickScope
+{
+	FShooterSignificanceTickScope(const UObject* WorldContextObject, UShooterSignificanceManager::ETickType InTickType)
+		: Manager(UShooterSignificanceManager::Get(WorldContextObject))
+		, TickType(InTickType)
+		, StartCycles(FPlatformTime::Cycles())
+	{
+	}
+
+	~FShooterSignificanceTickScope()
+	{
+		if (Manager)
+		{
+			Manager->RecordTickCost(TickType, FPlatformTime::Cycles() - StartCycles);
+		}
+	}
+
+private:
+
+	UShooterSignificanceManager* Manager;
+	UShooterSignificanceManager::ETickType TickType;
+	uint32 StartCycles;
+};
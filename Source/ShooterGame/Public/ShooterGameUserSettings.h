@@ -114,6 +114,26 @@ class UShooterGameUserSettings : public UGameUserSettings
 		bIsForceSystemResolution = InbIsForceSystemResolution;
 	}
 
+	int32 GetMaxDecals() const
+	{
+		return MaxDecals;
+	}
+
+	void SetMaxDecals(int32 InMaxDecals)
+	{
+		MaxDecals = InMaxDecals;
+	}
+
+	float GetDecalCullDistance() const
+	{
+		return DecalCullDistance;
+	}
+
+	void SetDecalCullDistance(float InDecalCullDistance)
+	{
+		DecalCullDistance = InDecalCullDistance;
+	}
+
 	// interface UGameUserSettings
 	virtual void SetToDefaults() override;
 
@@ -161,4 +181,12 @@ private:
 	/** Enable if UShooterGameUserSettings is not the authority on resolution */
 	UPROPERTY(config)
 	bool bIsForceSystemResolution;
+
+	/** Impact and explosion decals shown at once, the oldest are recycled past this. Halved on low graphics quality. */
+	UPROPERTY(config)
+	int32 MaxDecals;
+
+	/** Decals further than this from the camera are not spawned, 0 for no limit */
+	UPROPERTY(config)
+	float DecalCullDistance;
 };
@@ -69,6 +69,19 @@ namespace EShooterDialogType
 	};
 }
 
+/** how much work a character gets, see UShooterSignificanceManager */
+namespace EShooterSignificance
+{
+	enum Type
+	{
+		Full,
+		Reduced,
+		Low,
+		Culled,
+		MAX
+	};
+}
+
 #define SHOOTER_SURFACE_Default		SurfaceType_Default
 #define SHOOTER_SURFACE_Concrete	SurfaceType1
 #define SHOOTER_SURFACE_Dirt		SurfaceType2
@@ -22,13 +22,12 @@ class USoundNodeLocalPlayer : public USoundNode
 #endif
 	// End USoundNode interface.
 
-	static TMap<uint32, bool>& GetLocallyControlledActorCache()
-	{
-		check(IsInAudioThread());
-		return LocallyControlledActorCache;
-	}
+	/** [game thread] record whether the actor with the unique ID is locally controlled, call when it changes */
+	static void SetLocallyControlled(uint32 UniqueID, bool bLocallyControlled);
 
-private:
+	/** [game thread] forget the actor, call before its unique ID can be reused */
+	static void RemoveLocallyControlled(uint32 UniqueID);
 
-	static TMap<uint32, bool> LocallyControlledActorCache;
+	/** [any thread] true if the actor was last recorded as locally controlled */
+	static bool IsLocallyControlled(uint32 UniqueID);
 };
@@ -0,0 +1,88 @@
+// Copyright Epic Games, Inc.All Rights Reserved.
+#pragma once
+
+#include "Tests/ShooterTestControllerBase.h"
+#include "ShooterTestControllerRepGraphBenchmark.generated.h"
+
+class UShooterReplicationGraph;
+class AShooterProjectile;
+
+/**
+ * Headless replication graph benchmark, run on a dedicated server:
+ *   ShooterServer <Map> -gauntlet=ShooterTestControllerRepGraphBenchmark -RepGraphBench.Connections=100 -RepGraphBench.Pawns=200
+ *
+ * Synthetic projectiles are of -RepGraphBench.ProjectileClass= (a class path), or of whatever the players' projectile weapons fire.
+ *
+ * Adds simulated client connections (which absorb all traffic) and synthetic moving pawns, projectiles and pickups, lets the
+ * server replicate to them and writes per frame replication time, per node gather time, actors gathered per connection and
+ * bytes sent per connection to Saved/Profiling/RepGraphBenchmark.csv (or -RepGraphBench.Csv=).
+ */
+UCLASS()
+class UShooterTestControllerRepGraphBenchmark : public UShooterTestControllerBase
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnInit() override;
+	virtual void OnPostMapChange(UWorld* World) override;
+
+protected:
+	virtual void OnTick(float TimeDelta) override;
+
+	/** Add the connections and actors, once the server is up */
+	bool SetupBenchmark();
+
+	/** Move the synthetic actors and replace the projectiles that exploded */
+	void UpdateSyntheticActors(float TimeDelta);
+
+	/** Record one CSV row */
+	void SampleFrame();
+
+	/** Write the CSV and end the test */
+	void FinishBenchmark();
+
+	UShooterReplicationGraph* GetReplicationGraph() const;
+
+	// Settings
+	int32 NumConnections;
+	int32 NumPawns;
+	int32 NumProjectiles;
+	int32 NumPickups;
+	int32 WarmupFrames;
+	int32 SampleFrames;
+	FString CsvFilename;
+	FString ProjectileClassName;
+
+	uint8 bIsSetup : 1;
+	int32 FrameCount;
+
+	/** Synthetic pawns and where they circle around */
+	UPROPERTY()
+	TArray<AActor*> Pawns;
+	TArray<FVector> PawnOrigins;
+
+	UPROPERTY()
+	TArray<TWeakObjectPtr<AActor>> Projectiles;
+
+	/** Projectile weapon of one of the players, synthetic projectiles are fired from its config through the projectile pool */
+	UPROPERTY()
+	AActor* ProjectileWeapon;
+
+	/** Concrete projectile class to fire, AShooterProjectile itself is abstract */
+	UPROPERTY()
+	TSubclassOf<AShooterProjectile> ProjectileClass;
+
+	UPROPERTY()
+	TArray<AActor*> Pickups;
+
+	/** Locations synthetic actors are spawned around */
+	TArray<FVector> SpawnLocations;
+
+	/** Sum of OutTotalBytes over all connections at the last sample */
+	int64 LastTotalBytes;
+
+	/** Node columns, fixed by the first sample */
+	TArray<FName> NodeColumns;
+
+	TArray<FString> CsvLines;
+};
@@ -0,0 +1,157 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterLagCompensation.generated.h"
+
+/** single client hit to check against the rewound bounds of its target */
+struct FShooterLagCompensationQuery
+{
+	/** actor the client claims to have hit */
+	const AActor* Target;
+
+	/** claimed world space impact location */
+	FVector ImpactLocation;
+
+	/** estimated server time the shot was fired at */
+	float FireTime;
+
+	/** tolerance added to the rewound bounds extent */
+	float Leeway;
+
+	FShooterLagCompensationQuery()
+		: Target(nullptr)
+		, ImpactLocation(ForceInitToZero)
+		, FireTime(0.0f)
+		, Leeway(0.0f)
+	{
+	}
+};
+
+enum class EShooterLagCompensationResult : uint8
+{
+	Confirmed,
+	Rejected,
+	/** target isn't tracked or the history doesn't reach back to FireTime, caller should fall back to its own checks */
+	NoHistory,
+};
+
+/**
+ * [server] Keeps a bounded history of pawn bounds keyed by server time, so client side hits can be
+ * validated against where the target was when the shot was fired instead of where it is now.
+ *
+ * History is a fixed ring of frames stored as structure of arrays: one timestamp per frame and
+ * a center/extent pair per (frame, slot). Every registered pawn owns a slot for its whole life.
+ */
+UCLASS()
+class UShooterLagCompensation : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+
+	/** returns the subsystem for the world of the given object, if any */
+	static UShooterLagCompensation* Get(const UObject* WorldContextObject);
+
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	/** TickableObject Functions */
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+	/** [server] start recording bounds of the pawn */
+	void RegisterPawn(APawn* Pawn);
+
+	/** [server] stop recording bounds of the pawn, its slot is recycled */
+	void UnregisterPawn(APawn* Pawn);
+
+	/** estimated server time at which a shot from the given controller was fired, based on its ping */
+	float GetEstimatedFireTime(const AController* Shooter) const;
+
+	/** validate single hit */
+	EShooterLagCompensationResult ValidateHit(const FShooterLagCompensationQuery& Query) const;
+
+	/** validate all hits in one pass, frame lookups are shared between consecutive queries with the same fire time */
+	void ValidateHits(TArrayView<const FShooterLagCompensationQuery> Queries, TArray<EShooterLagCompensationResult>& OutResults) const;
+
+	/** get bounds of the target interpolated at the given server time */
+	bool GetRewoundBounds(const AActor* Target, float Time, FBox& OutBounds) const;
+
+	/** current bounds of the pawn as recorded in the history */
+	static FBox GetTrackedBounds(const APawn* Pawn);
+
+	/** longest a hit can be rewound, see ShooterGame.LagCompensation.MaxRewindTime */
+	static float GetMaxRewindTime();
+
+private:
+
+	/** ring indices of the frames around a given time and the blend between them */
+	struct FFrameLookup
+	{
+		int32 OlderFrame;
+		int32 NewerFrame;
+		float Alpha;
+
+		/** time of the older frame, slots registered after it have no valid data */
+		float OlderTimestamp;
+	};
+
+	/** size history buffers from the cvars */
+	void AllocateHistory();
+
+	/** free history buffers */
+	void ReleaseHistory();
+
+	/** append bounds of all registered pawns as a new frame */
+	void RecordFrame(float TimeSeconds);
+
+	/** find frames around the given time, fails if the history doesn't cover it */
+	bool FindFrames(float Time, FFrameLookup& OutLookup) const;
+
+	/** get interpolated bounds of the slot */
+	bool GetSlotBounds(int32 Slot, const FFrameLookup& Lookup, FBox& OutBounds) const;
+
+	/** test the query against already looked up frames */
+	EShooterLagCompensationResult ValidateHitWithFrames(const FShooterLagCompensationQuery& Query, const FFrameLookup& Lookup) const;
+
+	/** number of frames in the ring */
+	int32 MaxFrames;
+
+	/** number of pawn slots per frame */
+	int32 MaxSlots;
+
+	/** ring write position, index of the next frame to record */
+	int32 FrameHead;
+
+	/** number of valid frames in the ring */
+	int32 FrameCount;
+
+	/** server time of each frame */
+	TArray<float> FrameTimestamps;
+
+	/** bounds center per (frame, slot), indexed Frame * MaxSlots + Slot */
+	TArray<FVector> BoundsCenters;
+
+	/** bounds extent per (frame, slot), indexed Frame * MaxSlots + Slot */
+	TArray<FVector> BoundsExtents;
+
+	/** pawn owning each slot, null when free */
+	TArray<TWeakObjectPtr<APawn>> SlotPawns;
+
+	/** server time each slot was taken, older frames hold data of a previous owner */
+	TArray<float> SlotRegisterTimes;
+
+	/** free slots, reused in LIFO order */
+	TArray<int32> FreeSlots;
+
+	/** slot lookup for validation */
+	TMap<const AActor*, int32> SlotByActor;
+};
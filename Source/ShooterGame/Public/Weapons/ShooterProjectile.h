@@ -25,6 +25,18 @@ class AShooterProjectile : public AActor
 	UFUNCTION()
 	void OnImpact(const FHitResult& HitResult);
 
+	/** cleanup, tells the pool when a pooled projectile is destroyed */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** [server] owned by UShooterProjectilePool: returned to it instead of being destroyed */
+	void SetPooled() { bPooled = true; }
+
+	/** [server] fire again after coming out of the pool, owner and transform are already set */
+	void OnAcquiredFromPool(FVector& ShootDirection);
+
+	/** [server] spent, hide and go dormant until reused */
+	void OnReleasedToPool();
+
 private:
 	/** movement component */
 	UPROPERTY(VisibleDefaultsOnly, Category=Projectile)
@@ -48,14 +60,34 @@ protected:
 	/** projectile data */
 	struct FProjectileWeaponData WeaponConfig;
 
+	/** bumped every time the projectile is reused from the pool */
+	UPROPERTY(Transient, ReplicatedUsing=OnRep_PoolGeneration)
+	uint8 PoolGeneration;
+
 	/** did it explode? */
 	UPROPERTY(Transient, ReplicatedUsing=OnRep_Exploded)
 	bool bExploded;
 
+	/** [server] owned by the projectile pool */
+	bool bPooled;
+
 	/** [client] explosion happened */
 	UFUNCTION()
 	void OnRep_Exploded();
 
+	/** [client] projectile was fired again */
+	UFUNCTION()
+	void OnRep_PoolGeneration();
+
+	/** instigator, weapon config and life span from the weapon that fired it */
+	void InitFromOwner();
+
+	/** undo the explosion: movement, collision and effects back on */
+	void ResetForReuse();
+
+	/** [server] pooled projectiles go back to the pool instead of being destroyed */
+	virtual void LifeSpanExpired() override;
+
 	/** trigger explosion */
 	void Explode(const FHitResult& Impact);
 
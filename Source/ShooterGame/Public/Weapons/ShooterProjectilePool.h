@@ -0,0 +1,76 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterProjectilePool.generated.h"
+
+class AShooterProjectile;
+
+/** free projectiles of one class, wrapped so the free list map can be a UPROPERTY */
+USTRUCT()
+struct FShooterFreeProjectiles
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	TArray<AShooterProjectile*> Projectiles;
+};
+
+/**
+ * [server] Recycles projectiles instead of spawning and destroying one per shot.
+ *
+ * Spent projectiles are hidden, stripped of collision and movement and put to sleep with net dormancy, so clients keep their
+ * copy and the actor channel is reopened on the same actor when the projectile is fired again.
+ */
+UCLASS()
+class UShooterProjectilePool : public UWorldSubsystem
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+
+	/** returns the subsystem for the world of the given object, if any */
+	static UShooterProjectilePool* Get(const UObject* WorldContextObject);
+
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	/**
+	 * Fire a projectile, reusing a free one of the class when there is one.
+	 *
+	 * @param ProjectileClass	Class to fire.
+	 * @param SpawnTM			Initial transform.
+	 * @param Weapon			Weapon firing it, becomes the owner and provides the projectile config.
+	 * @param ShootDir			Initial direction.
+	 */
+	AShooterProjectile* AcquireProjectile(TSubclassOf<AShooterProjectile> ProjectileClass, const FTransform& SpawnTM, AActor* Weapon, FVector ShootDir);
+
+	/** put a spent projectile back, destroys it when the pool for its class is full */
+	void ReleaseProjectile(AShooterProjectile* Projectile);
+
+	/** projectile owned by the pool is going away */
+	void NotifyProjectileDestroyed(AShooterProjectile* Projectile);
+
+	/** log hit rate and size */
+	void LogStats() const;
+
+private:
+
+	/** free projectiles per class */
+	UPROPERTY()
+	TMap<UClass*, FShooterFreeProjectiles> FreeProjectiles;
+
+	/** every projectile owned by the pool, in flight or free */
+	UPROPERTY()
+	TSet<AShooterProjectile*> PooledProjectiles;
+
+	/** requests, and how many of them were served from the free lists */
+	int32 NumAcquired;
+	int32 NumReused;
+
+	/** most projectiles the pool owned at once */
+	int32 PeakSize;
+};
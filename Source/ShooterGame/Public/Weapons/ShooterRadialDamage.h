@@ -0,0 +1,109 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterRadialDamage.generated.h"
+
+/**
+ * [server] Applies radial damage of every explosion in a frame in one pass, replacing UGameplayStatics::ApplyRadialDamage.
+ *
+ * Pawns in range come from UShooterPawnSpatialIndex instead of a world overlap. Candidates outside the radius are dropped
+ * by one falloff loop over all of them, and the occlusion traces of the survivors go out as one batch of async traces.
+ * Damage is applied on the next tick, once the traces are back. Victims get the same FRadialDamageEvent as before, so
+ * falloff and AShooterGameMode::ModifyDamage are applied by TakeDamage as they were.
+ */
+UCLASS()
+class UShooterRadialDamage : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+
+	/** returns the subsystem for the world of the given object, if any */
+	static UShooterRadialDamage* Get(const UObject* WorldContextObject);
+
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	/** TickableObject Functions */
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+	/**
+	 * Queue radial damage with linear falloff, applied at the end of the frame with every other explosion.
+	 *
+	 * @param BaseDamage		Damage at the origin.
+	 * @param Origin			Explosion location.
+	 * @param Radius			No damage past this distance.
+	 * @param DamageTypeClass	Damage type of the event.
+	 * @param DamageCauser		Actor that exploded, ignored by occlusion traces.
+	 * @param InstigatedBy		Controller credited with the damage.
+	 */
+	void ApplyRadialDamage(float BaseDamage, const FVector& Origin, float Radius, TSubclassOf<UDamageType> DamageTypeClass, AActor* DamageCauser, AController* InstigatedBy);
+
+	/** gather the candidates of all queued explosions and start their occlusion traces, damage follows on the next tick */
+	void Flush();
+
+private:
+
+	struct FPendingExplosion
+	{
+		float BaseDamage;
+		FVector Origin;
+		float Radius;
+		TSubclassOf<UDamageType> DamageTypeClass;
+		TWeakObjectPtr<AActor> DamageCauser;
+		TWeakObjectPtr<AController> InstigatedBy;
+
+		/** range of candidates */
+		int32 FirstCandidate;
+		int32 NumCandidates;
+	};
+
+	/** component that may be damaged by an explosion, weak as it waits a frame for its trace */
+	struct FCandidate
+	{
+		TWeakObjectPtr<AActor> Actor;
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+	};
+
+	/** add pawns and other damageable components in range of the explosion */
+	void GatherCandidates(FPendingExplosion& Explosion);
+
+	void AddCandidate(AActor* Actor, UPrimitiveComponent* Component);
+
+	/** async trace completion, Datum.UserData is the candidate index */
+	void OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	/** record the occlusion trace result of a candidate */
+	void SetTraceResult(int32 CandidateIndex, const FHitResult* Hit);
+
+	/** damage the visible candidates of the traced explosions */
+	void ApplyTracedDamage();
+
+	TArray<FPendingExplosion> PendingExplosions;
+
+	/** explosions whose occlusion traces are in flight */
+	TArray<FPendingExplosion> TracedExplosions;
+
+	/** bound once, reused for all traces */
+	FTraceDelegate TraceDelegate;
+
+	/** candidates of all pending explosions, with their bounds split by axis for the falloff loop */
+	TArray<FCandidate> Candidates;
+	TArray<float> CandidateX;
+	TArray<float> CandidateY;
+	TArray<float> CandidateZ;
+	TArray<float> CandidateRadius;
+	TArray<float> CandidateScale;
+
+	/** visible hit per candidate, only valid where CandidateScale > 0 and the trace came back */
+	TArray<FHitResult> CandidateHits;
+	TArray<bool> CandidateTraced;
+};
@@ -141,6 +141,9 @@ class AShooterWeapon : public AActor
 	/** [server] weapon was removed from pawn's inventory */
 	virtual void OnLeaveInventory();
 
+	/** [server] owner pawn was reused from the respawn pool, restore the ammo of a freshly spawned weapon */
+	virtual void ResetForReuse();
+
 	/** check if it's currently equipped */
 	bool IsEquipped() const;
 
@@ -432,14 +435,45 @@ protected:
 	/** Handle for efficient management of HandleFiring timer */
 	FTimerHandle TimerHandle_HandleFiring;
 
+	/** [local] shots fired since fire was pressed, reported to the server */
+	int32 ClientShotsFired;
+
+	/** [local] time fire was pressed */
+	float ClientFireStartTime;
+
+	/** [local] last time the shot count was sent during sustained fire */
+	float LastFireSyncTime;
+
+	/** [server] client time fire was pressed, from ServerStartFire */
+	float ServerFireStartClientTime;
+
+	/** [server] time ServerStartFire arrived */
+	float ServerFireStartTime;
+
+	/** [server] shots simulated since fire was pressed */
+	int32 ServerShotsFired;
+
+	/** [server] shots the client confirmed with a sync during this burst, never refunded */
+	int32 ServerConfirmedShots;
+
+	/** [server] time the current burst's first shot is due */
+	float ServerBurstStartTime;
+
+	/** [server] shots simulated in the current burst */
+	int32 ServerBurstShots;
+
 	//////////////////////////////////////////////////////////////////////////
 	// Input - server side
 
 	UFUNCTION(reliable, server, WithValidation)
-	void ServerStartFire();
+	void ServerStartFire(float ClientTime);
 
 	UFUNCTION(reliable, server, WithValidation)
-	void ServerStopFire();
+	void ServerStopFire(float ClientTime, int32 ShotsFired);
+
+	/** [server] shot count of the client during sustained fire */
+	UFUNCTION(unreliable, server, WithValidation)
+	void ServerSyncFire(float ClientTime, int32 ShotsFired);
 
 	UFUNCTION(reliable, server, WithValidation)
 	void ServerStartReload();
@@ -473,9 +507,20 @@ protected:
 	/** [local] weapon specific fire implementation */
 	virtual void FireWeapon() PURE_VIRTUAL(AShooterWeapon::FireWeapon,);
 
-	/** [server] fire & update ammo */
-	UFUNCTION(reliable, server, WithValidation)
-	void ServerHandleFiring();
+	/** [server] true if shots are simulated by the server fire clock instead of HandleFiring */
+	bool UsesServerFireClock() const;
+
+	/** [server] fire every shot due since the burst started, then wait for the next one */
+	void HandleServerFireClock();
+
+	/** [server] fire & update ammo for one shot of a remote client, returns false if the burst can't continue */
+	bool FireServerShot();
+
+	/** [server] match the simulated shots to the client's count, refunding ammo for unconfirmed extra shots once fire stopped */
+	void ReconcileServerShots(float ClientTime, int32 ClientShots, bool bFireStopped);
+
+	/** [server] give back ammo used by shots the client never fired */
+	void RefundAmmo(int32 Amount);
 
 	/** [local + server] handle weapon refire, compensating for slack time if the timer can't sample fast enough */
 	void HandleReFiring();
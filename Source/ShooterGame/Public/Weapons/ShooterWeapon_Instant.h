@@ -6,6 +6,7 @@
 #include "ShooterWeapon_Instant.generated.h"
 
 class AShooterImpactEffect;
+enum class EShooterLagCompensationResult : uint8;
 
 USTRUCT()
 struct FInstantHitInfo
@@ -29,6 +30,94 @@ struct FInstantHitInfo
 	}
 };
 
+/** compact client side hit, sent in batches through AShooterWeapon_Instant::ServerNotifyHit */
+USTRUCT()
+struct FShooterHitReport
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** actor that was hit, null for world geometry */
+	UPROPERTY()
+	TWeakObjectPtr<AActor> Target;
+
+	/** world space impact point, checked against the rewound bounds of the target */
+	UPROPERTY()
+	FVector ImpactPoint;
+
+	UPROPERTY()
+	FVector ImpactNormal;
+
+	/** bone index in the mesh of the character that was hit plus one, 0 for none */
+	UPROPERTY()
+	uint16 HitZone;
+
+	UPROPERTY()
+	int32 RandomSeed;
+
+	/** reticle spread in tenths of a degree */
+	UPROPERTY()
+	uint8 ReticleSpread;
+
+	/** time from the shot until the report was sent, in 4 ms steps. Claimed by the client, capped by the server, see GetMaxHitReportAge. */
+	UPROPERTY()
+	uint8 Age;
+
+	/** a target was sent, false for world geometry. Set with a null Target if it didn't resolve on the receiving end. */
+	UPROPERTY()
+	bool bHasTarget;
+
+	FShooterHitReport()
+		: ImpactPoint(0)
+		, ImpactNormal(0)
+		, HitZone(0)
+		, RandomSeed(0)
+		, ReticleSpread(0)
+		, Age(0)
+		, bHasTarget(false)
+	{
+	}
+
+	float GetReticleSpread() const
+	{
+		return ReticleSpread * 0.1f;
+	}
+
+	float GetAgeSeconds() const
+	{
+		return Age * 0.004f;
+	}
+
+	/** target GUID, packed impact point and normal, hit zone and seed */
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FShooterHitReport> : public TStructOpsTypeTraitsBase2<FShooterHitReport>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+/** hit reports sent together, acknowledged by sequence */
+USTRUCT()
+struct FShooterHitReportBatch
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	uint16 Sequence;
+
+	UPROPERTY()
+	TArray<FShooterHitReport> Reports;
+
+	FShooterHitReportBatch()
+		: Sequence(0)
+	{
+	}
+};
+
 USTRUCT()
 struct FInstantWeaponData
 {
@@ -70,6 +159,10 @@ struct FInstantWeaponData
 	UPROPERTY(EditDefaultsOnly, Category=HitVerification)
 	float AllowedViewDotHitDir;
 
+	/** hit verification: distance added to the target's rewound bounds when lag compensation is available */
+	UPROPERTY(EditDefaultsOnly, Category=HitVerification)
+	float LagCompensationLeeway;
+
 	/** defaults */
 	FInstantWeaponData()
 	{
@@ -82,6 +175,7 @@ struct FInstantWeaponData
 		DamageType = UDamageType::StaticClass();
 		ClientSideHitLeeway = 200.0f;
 		AllowedViewDotHitDir = 0.8f;
+		LagCompensationLeeway = 25.0f;
 	}
 };
 
@@ -117,6 +211,14 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category=Effects)
 	FName TrailTargetParam;
 
+	/** tracer drawn by UShooterTracerManager instead of spawning TrailFX per shot, 100 uu long along X. Weapons without one keep spawning TrailFX. */
+	UPROPERTY(EditDefaultsOnly, Category=Effects)
+	UStaticMesh* TracerMesh;
+
+	/** material override for the tracer mesh */
+	UPROPERTY(EditDefaultsOnly, Category=Effects)
+	UMaterialInterface* TracerMaterial;
+
 	/** instant hit notify for replication */
 	UPROPERTY(Transient, ReplicatedUsing=OnRep_HitNotify)
 	FInstantHitInfo HitNotify;
@@ -124,23 +226,80 @@ protected:
 	/** current spread from continuous firing */
 	float CurrentFiringSpread;
 
+	/** [client] hit reports sent but not acknowledged yet, resent until they are or they get too old */
+	struct FPendingHitBatch
+	{
+		FShooterHitReportBatch Batch;
+
+		/** when each report's shot was fired */
+		TArray<float> ShotTimes;
+
+		float LastSendTime;
+	};
+
+	/** [client] hits waiting for the next batch, and when they were fired */
+	TArray<FShooterHitReport> QueuedHitReports;
+	TArray<float> QueuedHitTimes;
+
+	/** [client] unacknowledged batches, oldest first */
+	TArray<FPendingHitBatch> PendingHitBatches;
+
+	/** [client] sequence of the next batch */
+	uint16 NextHitReportSequence;
+
+	/** [client] flushes and resends hit reports while any are pending */
+	FTimerHandle TimerHandle_FlushHitReports;
+
+	/** [server] newest batch received, with a bit for each of the 32 sequences before it */
+	uint16 LastReceivedHitSequence;
+	uint32 ReceivedHitSequenceMask;
+	bool bReceivedHitReports;
+
+	/** [server] when the last new batch arrived */
+	float LastHitBatchReceiveTime;
+
 	//////////////////////////////////////////////////////////////////////////
 	// Weapon usage
 
-	/** server notified of hit from client to verify */
-	UFUNCTION(reliable, server, WithValidation)
-	void ServerNotifyHit(const FHitResult& Impact, FVector_NetQuantizeNormal ShootDir, int32 RandomSeed, float ReticleSpread);
+	/** server notified of hits from client to verify */
+	UFUNCTION(unreliable, server, WithValidation)
+	void ServerNotifyHit(const FShooterHitReportBatch& Batch);
+
+	/** client notified that the server got a batch of hits */
+	UFUNCTION(unreliable, client)
+	void ClientAckHitReports(uint16 Sequence);
 
 	/** server notified of miss to show trail FX */
 	UFUNCTION(unreliable, server, WithValidation)
 	void ServerNotifyMiss(FVector_NetQuantizeNormal ShootDir, int32 RandomSeed, float ReticleSpread);
 
+	/** [client] add a hit to the next batch for the server */
+	void QueueHitReport(const FHitResult& Impact, int32 RandomSeed, float ReticleSpread);
+
+	/** [client] send queued hits and resend unacknowledged batches */
+	void FlushHitReports();
+
+	/** [server] rebuild the hit from a report */
+	FHitResult DecodeHitReport(const FShooterHitReport& Report) const;
+
+	/** [server] record the batch sequence, returns false if it was already received */
+	bool MarkHitReportsReceived(uint16 Sequence);
+
+	/** [server] oldest age a report in a batch arriving now can legitimately claim, from the arrival of the previous batch */
+	float GetMaxHitReportAge() const;
+
+	/** [server] check a decoded client hit, LagCompensationResult is the result for its target at the time of the shot */
+	void ValidateClientHit(const FHitResult& Impact, int32 RandomSeed, float ReticleSpread, EShooterLagCompensationResult LagCompensationResult);
+
 	/** process the instant hit and notify the server if necessary */
 	void ProcessInstantHit(const FHitResult& Impact, const FVector& Origin, const FVector& ShootDir, int32 RandomSeed, float ReticleSpread);
 
 	/** continue processing the instant hit, as if it has been confirmed by the server */
 	void ProcessInstantHit_Confirmed(const FHitResult& Impact, const FVector& Origin, const FVector& ShootDir, int32 RandomSeed, float ReticleSpread);
 
+	/** [server] check client hit against the target's current bounds, used when no lag compensation history is available */
+	bool IsWithinClientSideHitLeeway(const FHitResult& Impact) const;
+
 	/** check if weapon should deal damage to actor */
 	bool ShouldDealDamage(AActor* TestActor) const;
 